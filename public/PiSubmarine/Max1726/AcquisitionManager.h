@@ -0,0 +1,320 @@
+#pragma once
+
+#include "PiSubmarine/Max1726/Max1726.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+namespace PiSubmarine::Max1726
+{
+	template<typename Clock = std::chrono::steady_clock>
+	struct BusStats
+	{
+		uint64_t Cycles = 0;
+		uint64_t Transactions = 0;
+		uint64_t Failures = 0;
+		uint64_t MuxSwitches = 0;
+
+		/// <summary>
+		/// Time spent waiting for transactions of this bus to complete.
+		/// </summary>
+		typename Clock::duration BusyTime{};
+
+		/// <summary>
+		/// Time since the first cycle started.
+		/// </summary>
+		typename Clock::duration Elapsed{};
+
+		double GetUtilisation() const
+		{
+			return Elapsed.count() > 0 ? static_cast<double>(BusyTime.count()) / static_cast<double>(Elapsed.count()) : 0.0;
+		}
+	};
+
+	/// <summary>
+	/// Owns gauges spread across several I2C buses and acquires their telemetry with one worker per bus, so buses run in parallel.
+	/// Gauges behind a mux are visited in serpentine channel order: the last channel of one cycle is the first of the next, saving a switch per cycle.
+	/// Gauges on a bus share its driver and mux, so every other request to a gauge goes through Access, which takes the bus between worker reads.
+	/// </summary>
+	/// <typeparam name="StatsPolicy">Passed on to every Device, see Device</typeparam>
+	/// <typeparam name="RSense">Sense resistor in uOhm, shared by every gauge the manager owns</typeparam>
+	template<PiSubmarine::Api::Internal::I2C::DriverConcept I2CDriver, typename Clock = std::chrono::steady_clock, typename StatsPolicy = NoRegisterStats, int64_t RSense = DefaultRSenseMicroOhms>
+	class AcquisitionManager
+	{
+	public:
+		using DeviceType = Device<I2CDriver, Clock, StatsPolicy, RSense>;
+
+		/// <summary>
+		/// Selects mux channel on a bus. Returns false on failure.
+		/// </summary>
+		using MuxSelectFunc = std::function<bool(uint8_t channel)>;
+
+		constexpr static uint8_t NoMux = 0xFF;
+
+		~AcquisitionManager()
+		{
+			Stop();
+		}
+
+		/// <summary>
+		/// Adds a bus. Rejected while workers are running.
+		/// </summary>
+		/// <returns>Bus index, or nothing if workers are running.</returns>
+		std::optional<size_t> AddBus(I2CDriver& driver, MuxSelectFunc muxSelect = {})
+		{
+			if (IsRunning())
+			{
+				return std::nullopt;
+			}
+
+			m_Buses.push_back(std::make_unique<Bus>(driver, std::move(muxSelect)));
+			return m_Buses.size() - 1;
+		}
+
+		/// <summary>
+		/// Adds gauge on the given bus. Rejected while workers are running.
+		/// Every gauge answers at the same address, so a bus takes either one gauge without a mux or gauges on distinct mux channels.
+		/// </summary>
+		/// <param name="bus">Bus index returned by AddBus</param>
+		/// <param name="muxChannel">Mux channel the gauge sits behind, or NoMux</param>
+		/// <returns>Gauge index, or nothing if workers are running, the bus does not exist or another gauge on it would answer at the same time.</returns>
+		std::optional<size_t> AddGauge(size_t bus, uint8_t muxChannel = NoMux)
+		{
+			if (IsRunning() || bus >= m_Buses.size())
+			{
+				return std::nullopt;
+			}
+
+			Bus& target = *m_Buses[bus];
+			for (size_t other : target.Gauges)
+			{
+				uint8_t otherChannel = m_Gauges[other].MuxChannel;
+				if (otherChannel == muxChannel || otherChannel == NoMux || muxChannel == NoMux)
+				{
+					return std::nullopt;
+				}
+			}
+
+			m_Gauges.push_back(Gauge{ std::make_unique<DeviceType>(target.Driver), bus, muxChannel });
+			size_t gauge = m_Gauges.size() - 1;
+
+			target.Gauges.push_back(gauge);
+			std::stable_sort(target.Gauges.begin(), target.Gauges.end(), [this](size_t a, size_t b) {
+				return m_Gauges[a].MuxChannel < m_Gauges[b].MuxChannel;
+				});
+			return gauge;
+		}
+
+		/// <summary>
+		/// Returns gauge for state that does not touch the bus, such as GetTelemetry. Requests go through Access.
+		/// </summary>
+		const DeviceType& GetDevice(size_t gauge) const
+		{
+			return *m_Gauges[gauge].Device;
+		}
+
+		/// <summary>
+		/// Runs func(DeviceType&) with the gauge's bus to itself and its mux channel selected, e.g. for init, checkpoints or alert setup.
+		/// Safe to call while workers are running; it waits for the read in progress on that bus. Requests made by func must be complete when it returns,
+		/// so use the blocking calls (InitBlocking, ReadAndWait, Awaiter::Wait). Must not be called from func or from the driver's completion thread.
+		/// </summary>
+		/// <returns>False if the mux channel could not be selected, otherwise the result of func.</returns>
+		template<typename Func>
+		bool Access(size_t gauge, Func&& func)
+		{
+			Gauge& target = m_Gauges[gauge];
+			Bus& bus = *m_Buses[target.Bus];
+			std::lock_guard lock(bus.Mutex);
+			if (!SelectChannel(bus, target))
+			{
+				return false;
+			}
+			return func(*target.Device);
+		}
+
+		size_t GetBusCount() const
+		{
+			return m_Buses.size();
+		}
+
+		size_t GetGaugeCount() const
+		{
+			return m_Gauges.size();
+		}
+
+		BusStats<Clock> GetBusStats(size_t bus) const
+		{
+			const Bus& source = *m_Buses[bus];
+			BusStats<Clock> stats;
+			stats.Cycles = source.Cycles;
+			stats.Transactions = source.Transactions;
+			stats.Failures = source.Failures;
+			stats.MuxSwitches = source.MuxSwitches;
+			stats.BusyTime = typename Clock::duration(source.BusyTicks.load());
+			stats.Elapsed = typename Clock::duration(source.ElapsedTicks.load());
+			return stats;
+		}
+
+		/// <summary>
+		/// Reads telemetry of every gauge on the bus once. Blocks until done. Used by the bus worker, or directly when no workers are started.
+		/// The bus is taken per gauge, so Access calls are served between gauges.
+		/// </summary>
+		/// <returns>True if every transaction succeeded.</returns>
+		bool RunCycle(size_t bus)
+		{
+			Bus& target = *m_Buses[bus];
+			auto start = Clock::now();
+			if (target.Cycles == 0)
+			{
+				target.FirstCycleTime = start;
+			}
+
+			bool ok = true;
+			size_t count = target.Gauges.size();
+			for (size_t i = 0; i < count; i++)
+			{
+				size_t gauge = target.Gauges[target.IsAscending ? i : count - 1 - i];
+				ok = Acquire(target, m_Gauges[gauge]) && ok;
+			}
+
+			target.IsAscending = !target.IsAscending;
+			target.Cycles++;
+			target.ElapsedTicks = (Clock::now() - target.FirstCycleTime).count();
+			return ok;
+		}
+
+		bool IsRunning() const
+		{
+			return m_IsRunning;
+		}
+
+		/// <summary>
+		/// Starts one worker thread per bus, each running RunCycle every period. Buses and gauges cannot be added until Stop.
+		/// </summary>
+		void Start(typename Clock::duration period)
+		{
+			Stop();
+			m_IsRunning = true;
+			for (size_t i = 0; i < m_Buses.size(); i++)
+			{
+				m_Buses[i]->Worker = std::jthread([this, i, period](std::stop_token st) {
+					auto next = Clock::now();
+					while (!st.stop_requested())
+					{
+						RunCycle(i);
+						next += period;
+						auto now = Clock::now();
+						if (next > now)
+						{
+							std::this_thread::sleep_for(next - now);
+						}
+						else
+						{
+							next = now;
+						}
+					}
+					});
+			}
+		}
+
+		void Stop()
+		{
+			for (auto& bus : m_Buses)
+			{
+				if (bus->Worker.joinable())
+				{
+					bus->Worker.request_stop();
+					bus->Worker.join();
+				}
+			}
+			m_IsRunning = false;
+		}
+
+	private:
+		struct Bus
+		{
+			Bus(I2CDriver& driver, MuxSelectFunc muxSelect) : Driver(driver), MuxSelect(std::move(muxSelect))
+			{
+
+			}
+
+			I2CDriver& Driver;
+			MuxSelectFunc MuxSelect;
+
+			/// <summary>
+			/// Held for every exchange with a gauge, from mux selection to the end of its requests.
+			/// </summary>
+			std::mutex Mutex;
+			std::vector<size_t> Gauges;
+			uint8_t CurrentChannel = NoMux;
+			bool IsAscending = true;
+			typename Clock::time_point FirstCycleTime{};
+			std::atomic<uint64_t> Cycles = 0;
+			std::atomic<uint64_t> Transactions = 0;
+			std::atomic<uint64_t> Failures = 0;
+			std::atomic<uint64_t> MuxSwitches = 0;
+			std::atomic<typename Clock::rep> BusyTicks = 0;
+			std::atomic<typename Clock::rep> ElapsedTicks = 0;
+			std::jthread Worker;
+		};
+
+		struct Gauge
+		{
+			std::unique_ptr<DeviceType> Device;
+			size_t Bus;
+			uint8_t MuxChannel;
+		};
+
+		std::vector<std::unique_ptr<Bus>> m_Buses;
+		std::vector<Gauge> m_Gauges;
+		std::atomic<bool> m_IsRunning = false;
+
+		/// <summary>
+		/// Switches the mux to the gauge's channel unless it is already selected. Must be called with the bus mutex held.
+		/// </summary>
+		bool SelectChannel(Bus& bus, const Gauge& gauge)
+		{
+			if (gauge.MuxChannel == NoMux || gauge.MuxChannel == bus.CurrentChannel)
+			{
+				return true;
+			}
+
+			if (!bus.MuxSelect || !bus.MuxSelect(gauge.MuxChannel))
+			{
+				bus.CurrentChannel = NoMux;
+				bus.Failures++;
+				return false;
+			}
+			bus.CurrentChannel = gauge.MuxChannel;
+			bus.MuxSwitches++;
+			return true;
+		}
+
+		bool Acquire(Bus& bus, Gauge& gauge)
+		{
+			std::lock_guard lock(bus.Mutex);
+			if (!SelectChannel(bus, gauge))
+			{
+				return false;
+			}
+
+			auto start = Clock::now();
+			bool ok = gauge.Device->ReadTelemetryAsync().Wait();
+			bus.BusyTicks += (Clock::now() - start).count();
+			bus.Transactions++;
+			if (!ok)
+			{
+				bus.Failures++;
+			}
+			return ok;
+		}
+	};
+}
@@ -0,0 +1,293 @@
+#pragma once
+
+#include "PiSubmarine/Max1726/Max1726.h"
+#include "PiSubmarine/Max1726/PendingRequest.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+namespace PiSubmarine::Max1726
+{
+	enum class AlertState : uint8_t
+	{
+		Idle,
+		Armed,
+		Busy,
+		Failed
+	};
+
+	/// <summary>
+	/// Interrupt-driven acquisition. Keeps ALRT thresholds armed in a window around the last value, so the host can sleep until the pin fires.
+	/// On NotifyAlert() only Status is read; the measurement registers are read only for the flags that fired, then their window is moved around the new value
+	/// (hysteresis) and the flags are cleared. Driven by Step() like InitAsync; never blocks. Only its own requests can fail it.
+	/// </summary>
+	template<typename DeviceType>
+	class AlertMonitor
+	{
+	public:
+		/// <summary>
+		/// Called from Step() with the alert flags that fired. Device shadow registers hold the values that caused them.
+		/// </summary>
+		using AlertHandler = std::function<void(Status flags)>;
+
+		constexpr static Status VoltageFlags = RegUtils::operator|(Status::MinimumVoltageAlert, Status::MaximumVoltageAlert);
+		constexpr static Status TemperatureFlags = RegUtils::operator|(Status::MinimumTemperatureAlert, Status::MaximumTemperatureAlert);
+		constexpr static Status SocFlags = RegUtils::operator|(Status::MinimumStateOfCharge, Status::MaximumStateOfChargeAlert);
+		constexpr static Status CurrentFlags = RegUtils::operator|(Status::MinimumCurrentAlert, Status::MaximumCurrentAlert);
+
+		AlertMonitor(DeviceType& device) : m_Device(device)
+		{
+
+		}
+
+		void EnableVoltageAlert(MicroVolts hysteresis)
+		{
+			m_VoltageHysteresis = hysteresis;
+			m_Enabled = RegUtils::operator|(m_Enabled, VoltageFlags);
+		}
+
+		void EnableTemperatureAlert(MilliCelsius hysteresis)
+		{
+			m_TemperatureHysteresis = hysteresis;
+			m_Enabled = RegUtils::operator|(m_Enabled, TemperatureFlags);
+		}
+
+		void EnableSocAlert(uint8_t hysteresisPercent)
+		{
+			m_SocHysteresis = hysteresisPercent;
+			m_Enabled = RegUtils::operator|(m_Enabled, SocFlags);
+		}
+
+		void EnableCurrentAlert(typename DeviceType::MicroAmperesType hysteresis)
+		{
+			m_CurrentHysteresis = hysteresis;
+			m_Enabled = RegUtils::operator|(m_Enabled, CurrentFlags);
+		}
+
+		/// <summary>
+		/// Additionally raises an alert on every integer percent change of RepSOC.
+		/// </summary>
+		void EnableSocChangeAlert()
+		{
+			m_IsSocChangeEnabled = true;
+			m_Enabled = RegUtils::operator|(m_Enabled, Status::StateOfChargeChanged);
+		}
+
+		void SetAlertHandler(AlertHandler handler)
+		{
+			m_Handler = std::move(handler);
+		}
+
+		/// <summary>
+		/// Reads Config, arms every enabled threshold around the present value and enables the ALRT output. Step() until Armed.
+		/// </summary>
+		void Begin()
+		{
+			m_IsArming = true;
+			m_Phase = Phase::ReadConfig;
+			m_Request.Discard();
+			m_IsAlertPending = false;
+			m_State = AlertState::Busy;
+		}
+
+		/// <summary>
+		/// Signals that ALRT was asserted. Safe to call from a GPIO interrupt thread.
+		/// </summary>
+		void NotifyAlert()
+		{
+			m_IsAlertPending = true;
+		}
+
+		AlertState GetState() const
+		{
+			return m_State;
+		}
+
+		uint64_t GetAlertCount() const
+		{
+			return m_AlertCount;
+		}
+
+		/// <summary>
+		/// Advances the state machine. Never blocks.
+		/// </summary>
+		AlertState Step()
+		{
+			if (m_State == AlertState::Armed && m_IsAlertPending.exchange(false))
+			{
+				m_Phase = Phase::ReadStatus;
+				m_State = AlertState::Busy;
+			}
+
+			if (m_State != AlertState::Busy)
+			{
+				return m_State;
+			}
+
+			switch (m_Request.Poll())
+			{
+			case RequestResult::Pending:
+				return m_State;
+			case RequestResult::Failed:
+				m_State = AlertState::Failed;
+				return m_State;
+			default:
+				break;
+			}
+
+			switch (m_Phase)
+			{
+			case Phase::ReadConfig:
+				Read(RegOffset::Config, Phase::ReadConfig2);
+				break;
+			case Phase::ReadConfig2:
+				Read(RegOffset::Config2, Phase::ReadStatus);
+				break;
+			case Phase::ReadStatus:
+				Read(RegOffset::Status, Phase::ReadValues);
+				break;
+			case Phase::ReadValues:
+				m_Fired = m_IsArming ? m_Enabled : RegUtils::operator&(m_Device.GetStatus(), m_Enabled);
+				if (!m_IsArming && m_Fired == Status{})
+				{
+					m_State = AlertState::Armed;
+					break;
+				}
+				ReadValues();
+				break;
+			case Phase::Rearm:
+				Rearm();
+				break;
+			case Phase::Done:
+				if (!m_IsArming && m_Handler)
+				{
+					m_Handler(m_Fired);
+				}
+				if (!m_IsArming)
+				{
+					m_AlertCount++;
+				}
+				m_IsArming = false;
+				m_State = AlertState::Armed;
+				break;
+			}
+
+			return m_State;
+		}
+
+	private:
+		enum class Phase : uint8_t
+		{
+			ReadConfig,
+			ReadConfig2,
+			ReadStatus,
+			ReadValues,
+			Rearm,
+			Done
+		};
+
+		DeviceType& m_Device;
+		AlertHandler m_Handler;
+		AlertState m_State = AlertState::Idle;
+		Phase m_Phase = Phase::ReadConfig;
+		PendingRequest<DeviceType> m_Request;
+		bool m_IsArming = false;
+		std::atomic<bool> m_IsAlertPending = false;
+		Status m_Enabled{};
+		Status m_Fired{};
+		bool m_IsSocChangeEnabled = false;
+		MicroVolts m_VoltageHysteresis;
+		MilliCelsius m_TemperatureHysteresis;
+		uint8_t m_SocHysteresis = 0;
+		typename DeviceType::MicroAmperesType m_CurrentHysteresis;
+		uint64_t m_AlertCount = 0;
+
+		void Read(RegOffset reg, Phase next)
+		{
+			m_Request.Track(m_Device.Read(reg, m_Request.GetCompletion()), m_Phase, next);
+		}
+
+		bool HasFired(Status flags) const
+		{
+			return RegUtils::HasAnyFlag(m_Fired, flags);
+		}
+
+		/// <summary>
+		/// Reads the smallest burst covering the measurement registers of the fired flags.
+		/// </summary>
+		void ReadValues()
+		{
+			uint8_t first = UINT8_MAX;
+			uint8_t last = 0;
+			auto include = [&](Status flags, RegOffset reg) {
+				if (HasFired(flags))
+				{
+					first = std::min(first, RegUtils::ToInt(reg));
+					last = std::max(last, RegUtils::ToInt(reg));
+				}
+				};
+			include(RegUtils::operator|(SocFlags, Status::StateOfChargeChanged), RegOffset::RepSOC);
+			include(TemperatureFlags, RegOffset::Temp);
+			include(VoltageFlags, RegOffset::VCell);
+			include(CurrentFlags, RegOffset::Current);
+
+			if (first > last)
+			{
+				m_Phase = Phase::Rearm;
+				return;
+			}
+			m_Request.Track(m_Device.Read(static_cast<RegOffset>(first), static_cast<RegOffset>(last), m_Request.GetCompletion()), m_Phase, Phase::Rearm);
+		}
+
+		void Rearm()
+		{
+			if (m_IsArming)
+			{
+				m_Device.DisableAlertThresholds();
+				m_Device.SetAlertEnabled(true);
+				m_Device.SetSocChangeAlertEnabled(m_IsSocChangeEnabled);
+			}
+
+			if (HasFired(VoltageFlags))
+			{
+				uint64_t value = m_Device.GetVCell().GetMicroVolts();
+				uint64_t hysteresis = m_VoltageHysteresis.GetMicroVolts();
+				m_Device.SetVoltageAlertThresholds(MicroVolts(value > hysteresis ? value - hysteresis : 0), MicroVolts(value + hysteresis));
+			}
+
+			if (HasFired(TemperatureFlags))
+			{
+				int64_t value = m_Device.GetTemperature().GetMilliCelsius();
+				int64_t hysteresis = m_TemperatureHysteresis.GetMilliCelsius();
+				m_Device.SetTemperatureAlertThresholds(MilliCelsius(value - hysteresis), MilliCelsius(value + hysteresis));
+			}
+
+			if (HasFired(SocFlags))
+			{
+				int value = m_Device.GetRemainingSoc() / 256;
+				m_Device.SetSocAlertThresholds(static_cast<uint8_t>(std::max(value - m_SocHysteresis, 0)), static_cast<uint8_t>(std::min(value + m_SocHysteresis, 255)));
+			}
+
+			if (HasFired(CurrentFlags))
+			{
+				int64_t value = m_Device.GetCurrent().GetMicroAmperes();
+				int64_t hysteresis = m_CurrentHysteresis.GetMicroAmperes();
+				m_Device.SetCurrentAlertThresholds(typename DeviceType::MicroAmperesType(value - hysteresis), typename DeviceType::MicroAmperesType(value + hysteresis));
+			}
+
+			Status status = m_Device.GetStatus();
+			if (RegUtils::HasAnyFlag(status, m_Fired))
+			{
+				m_Device.SetStatus(RegUtils::operator&(status, RegUtils::operator~(m_Fired)));
+			}
+
+			if (!m_Device.HasDirtyRegisters())
+			{
+				m_Phase = Phase::Done;
+				return;
+			}
+			m_Request.Track(m_Device.WriteDirty(m_Request.GetCompletion()), m_Phase, Phase::Done);
+		}
+	};
+}
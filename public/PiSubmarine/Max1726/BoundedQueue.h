@@ -0,0 +1,123 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace PiSubmarine::Max1726
+{
+	/// <summary>
+	/// Bounded lock-free queue (Vyukov). Safe for any number of producers and consumers, never allocates.
+	/// </summary>
+	/// <typeparam name="T">Element type</typeparam>
+	/// <typeparam name="Capacity">Maximum number of elements, power of two</typeparam>
+	template<typename T, size_t Capacity>
+		requires (Capacity >= 2 && (Capacity & (Capacity - 1)) == 0)
+	class BoundedQueue
+	{
+	public:
+		BoundedQueue()
+		{
+			for (size_t i = 0; i < Capacity; i++)
+			{
+				m_Cells[i].Sequence.store(i, std::memory_order_relaxed);
+			}
+		}
+
+		BoundedQueue(const BoundedQueue&) = delete;
+		BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+		/// <summary>
+		/// Appends element.
+		/// </summary>
+		/// <returns>False if queue is full.</returns>
+		bool TryPush(const T& value)
+		{
+			size_t pos = m_EnqueuePos.load(std::memory_order_relaxed);
+			while (true)
+			{
+				Cell& cell = m_Cells[pos & Mask];
+				size_t sequence = cell.Sequence.load(std::memory_order_acquire);
+				intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+				if (diff == 0)
+				{
+					if (m_EnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					{
+						cell.Data = value;
+						cell.Sequence.store(pos + 1, std::memory_order_release);
+						return true;
+					}
+				}
+				else if (diff < 0)
+				{
+					return false;
+				}
+				else
+				{
+					pos = m_EnqueuePos.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+		/// <summary>
+		/// Removes the oldest element.
+		/// </summary>
+		/// <returns>False if queue is empty.</returns>
+		bool TryPop(T& value)
+		{
+			size_t pos = m_DequeuePos.load(std::memory_order_relaxed);
+			while (true)
+			{
+				Cell& cell = m_Cells[pos & Mask];
+				size_t sequence = cell.Sequence.load(std::memory_order_acquire);
+				intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+				if (diff == 0)
+				{
+					if (m_DequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					{
+						value = cell.Data;
+						cell.Sequence.store(pos + Capacity, std::memory_order_release);
+						return true;
+					}
+				}
+				else if (diff < 0)
+				{
+					return false;
+				}
+				else
+				{
+					pos = m_DequeuePos.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+		/// <summary>
+		/// Returns number of elements. Approximate while other threads push or pop.
+		/// </summary>
+		size_t GetSize() const
+		{
+			size_t enqueuePos = m_EnqueuePos.load(std::memory_order_relaxed);
+			size_t dequeuePos = m_DequeuePos.load(std::memory_order_relaxed);
+			return enqueuePos >= dequeuePos ? enqueuePos - dequeuePos : 0;
+		}
+
+		constexpr static size_t GetCapacity()
+		{
+			return Capacity;
+		}
+
+	private:
+		constexpr static size_t Mask = Capacity - 1;
+
+		struct Cell
+		{
+			std::atomic<size_t> Sequence;
+			T Data{};
+		};
+
+		std::array<Cell, Capacity> m_Cells;
+		alignas(64) std::atomic<size_t> m_EnqueuePos = 0;
+		alignas(64) std::atomic<size_t> m_DequeuePos = 0;
+	};
+}
@@ -0,0 +1,191 @@
+#pragma once
+
+#include "PiSubmarine/Max1726/MicroAmpereHours.h"
+#include "PiSubmarine/Max1726/RegisterMap.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace PiSubmarine::Max1726
+{
+	/// <summary>
+	/// Learned registers a checkpoint stores, in serialization order.
+	/// </summary>
+	constexpr static std::array CheckpointRegisters{
+		RegOffset::RComp0,
+		RegOffset::TempCo,
+		RegOffset::FullCapRep,
+		RegOffset::FullCapNom,
+		RegOffset::Cycles,
+		RegOffset::QRTable00,
+		RegOffset::QRTable10,
+		RegOffset::QRTable20,
+		RegOffset::QRTable30,
+		RegOffset::dQAcc,
+		RegOffset::dPAcc
+	};
+
+	/// <summary>
+	/// Cell characterization learned by the gauge over its lifetime. Lost on power-on reset unless restored.
+	/// Capacities are kept as raw register words so a checkpoint restores exactly what was captured.
+	/// </summary>
+	/// <typeparam name="RSense">Sense resistor in uOhm the capacities are scaled for</typeparam>
+	template<int64_t RSense = DefaultRSenseMicroOhms>
+	struct BasicLearnedParameters
+	{
+		constexpr static size_t QRTableCount = 4;
+
+		uint16_t Rcomp0 = 0;
+		uint16_t TempCo = 0;
+		uint16_t FullCapRep = 0;
+		uint16_t FullCapNom = 0;
+		uint16_t Cycles = 0;
+		std::array<uint16_t, QRTableCount> QRTable{};
+		uint16_t DQAcc = 0;
+		uint16_t DPAcc = 0;
+
+		constexpr BasicMicroAmpereHours<RSense> GetEstimatedFullCapacity() const
+		{
+			return BasicMicroAmpereHours<RSense>::FromRaw(FullCapRep);
+		}
+
+		constexpr void SetEstimatedFullCapacity(BasicMicroAmpereHours<RSense> value)
+		{
+			FullCapRep = value.ToRaw();
+		}
+
+		constexpr BasicMicroAmpereHours<RSense> GetNominalFullCapacity() const
+		{
+			return BasicMicroAmpereHours<RSense>::FromRaw(FullCapNom);
+		}
+
+		constexpr void SetNominalFullCapacity(BasicMicroAmpereHours<RSense> value)
+		{
+			FullCapNom = value.ToRaw();
+		}
+
+		/// <summary>
+		/// Returns raw word of a learned register. reg must be one of CheckpointRegisters.
+		/// </summary>
+		constexpr uint16_t GetRegister(RegOffset reg) const
+		{
+			return Field(*this, reg);
+		}
+
+		/// <summary>
+		/// Sets raw word of a learned register. reg must be one of CheckpointRegisters.
+		/// </summary>
+		constexpr void SetRegister(RegOffset reg, uint16_t value)
+		{
+			Field(*this, reg) = value;
+		}
+
+	private:
+		template<typename Self>
+		static constexpr auto& Field(Self& self, RegOffset reg)
+		{
+			switch (reg)
+			{
+			case RegOffset::RComp0:
+				return self.Rcomp0;
+			case RegOffset::TempCo:
+				return self.TempCo;
+			case RegOffset::FullCapRep:
+				return self.FullCapRep;
+			case RegOffset::FullCapNom:
+				return self.FullCapNom;
+			case RegOffset::Cycles:
+				return self.Cycles;
+			case RegOffset::QRTable00:
+				return self.QRTable[0];
+			case RegOffset::QRTable10:
+				return self.QRTable[1];
+			case RegOffset::QRTable20:
+				return self.QRTable[2];
+			case RegOffset::QRTable30:
+				return self.QRTable[3];
+			case RegOffset::dQAcc:
+				return self.DQAcc;
+			default:
+				return self.DPAcc;
+			}
+		}
+	};
+
+	using LearnedParameters = BasicLearnedParameters<>;
+
+	/// <summary>
+	/// Checkpoint layout: magic (2), version (1), register count (1), registers (2 each, little-endian), CRC-16/CCITT of all preceding bytes (2).
+	/// </summary>
+	constexpr static std::array<uint8_t, 2> CheckpointMagic{ 'L', 'P' };
+	constexpr static uint8_t CheckpointVersion = 1;
+	constexpr static size_t CheckpointRegisterCount = CheckpointRegisters.size();
+	constexpr static size_t CheckpointSize = 4 + CheckpointRegisterCount * 2 + 2;
+
+	constexpr uint16_t CheckpointCrc(std::span<const uint8_t> data)
+	{
+		uint16_t crc = 0xFFFF;
+		for (uint8_t byte : data)
+		{
+			crc ^= static_cast<uint16_t>(byte << 8);
+			for (int i = 0; i < 8; i++)
+			{
+				crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+			}
+		}
+		return crc;
+	}
+
+	/// <summary>
+	/// Serializes learned parameters into a checkpoint suitable for non-volatile storage.
+	/// </summary>
+	template<int64_t RSense>
+	void SerializeCheckpoint(const BasicLearnedParameters<RSense>& params, std::span<uint8_t, CheckpointSize> data)
+	{
+		data[0] = CheckpointMagic[0];
+		data[1] = CheckpointMagic[1];
+		data[2] = CheckpointVersion;
+		data[3] = static_cast<uint8_t>(CheckpointRegisterCount);
+		for (size_t i = 0; i < CheckpointRegisterCount; i++)
+		{
+			uint16_t value = params.GetRegister(CheckpointRegisters[i]);
+			data[4 + i * 2] = static_cast<uint8_t>(value & 0xFF);
+			data[4 + i * 2 + 1] = static_cast<uint8_t>(value >> 8);
+		}
+
+		uint16_t crc = CheckpointCrc(data.first(CheckpointSize - 2));
+		data[CheckpointSize - 2] = static_cast<uint8_t>(crc & 0xFF);
+		data[CheckpointSize - 1] = static_cast<uint8_t>(crc >> 8);
+	}
+
+	/// <summary>
+	/// Parses checkpoint created by SerializeCheckpoint.
+	/// </summary>
+	/// <returns>False if data is truncated, corrupted or of unknown version. Parameters are left untouched in that case.</returns>
+	template<int64_t RSense>
+	bool DeserializeCheckpoint(std::span<const uint8_t> data, BasicLearnedParameters<RSense>& params)
+	{
+		if (data.size() < CheckpointSize)
+		{
+			return false;
+		}
+
+		if (data[0] != CheckpointMagic[0] || data[1] != CheckpointMagic[1] || data[2] != CheckpointVersion || data[3] != CheckpointRegisterCount)
+		{
+			return false;
+		}
+
+		uint16_t crc = static_cast<uint16_t>(data[CheckpointSize - 2] | (data[CheckpointSize - 1] << 8));
+		if (crc != CheckpointCrc(data.first(CheckpointSize - 2)))
+		{
+			return false;
+		}
+
+		for (size_t i = 0; i < CheckpointRegisterCount; i++)
+		{
+			params.SetRegister(CheckpointRegisters[i], static_cast<uint16_t>(data[4 + i * 2] | (data[4 + i * 2 + 1] << 8)));
+		}
+		return true;
+	}
+}
@@ -0,0 +1,363 @@
+#pragma once
+
+#include "PiSubmarine/Max1726/Max1726.h"
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+
+namespace PiSubmarine::Max1726
+{
+	/// <summary>
+	/// Charge and energy moved over an interval. Consumed is discharge, recovered is charge; both are magnitudes.
+	/// </summary>
+	template<int64_t RSense = DefaultRSenseMicroOhms>
+	struct EnergyUsage
+	{
+		BasicMicroAmpereHours<RSense> ConsumedCharge{};
+		BasicMicroAmpereHours<RSense> RecoveredCharge{};
+		uint64_t ConsumedMicroWattHours = 0;
+		uint64_t RecoveredMicroWattHours = 0;
+		std::chrono::microseconds Duration{};
+
+		/// <summary>
+		/// Net energy rate over Duration. Negative while discharging.
+		/// </summary>
+		BasicMicroWatts<RSense> AveragePower{};
+	};
+
+	/// <summary>
+	/// Host-side coulomb and energy counter fed with the TelemetrySnapshot of every acquisition cycle.
+	/// Integrates Current and VCell * Current with the trapezoid rule in integer uA*us and uW*us, so sums carry no rounding error.
+	/// Whole uAh and uWh are carried out of the sums as they accumulate, so they do not overflow even at full scale over months.
+	/// Intervals come from differences of absolute timestamps rather than per-sample durations, so rounding to microseconds never accumulates.
+	/// Attribution windows snapshot the session totals when opened; every Add() is O(1) regardless of how many are open.
+	/// </summary>
+	/// <typeparam name="WindowCount">Number of attribution windows, e.g. one per subsystem</typeparam>
+	template<typename Clock = std::chrono::steady_clock, int64_t RSense = DefaultRSenseMicroOhms, size_t WindowCount = 8>
+	class EnergyIntegrator
+	{
+	public:
+		using SnapshotType = TelemetrySnapshot<Clock, RSense>;
+		using UsageType = EnergyUsage<RSense>;
+
+		/// <summary>
+		/// Starts a new session, e.g. a dive. Totals and windows are cleared; the next snapshot becomes the baseline.
+		/// </summary>
+		void Reset()
+		{
+			m_Session = {};
+			m_Windows = {};
+			m_HasSample = false;
+			m_HasCoulombCounter = false;
+			m_CoulombCounterTotal = 0;
+		}
+
+		/// <summary>
+		/// Integrates the interval since the previous snapshot.
+		/// </summary>
+		/// <returns>False if the snapshot was already integrated or is older than the previous one.</returns>
+		bool Add(const SnapshotType& snapshot)
+		{
+			int64_t timestamp = std::chrono::duration_cast<std::chrono::microseconds>(snapshot.Timestamp.time_since_epoch()).count();
+			int64_t current = snapshot.Current.GetMicroAmperes();
+			int64_t power = DivideRounded(static_cast<int64_t>(snapshot.VCell.GetMicroVolts()) * current, 1000000);
+
+			if (!m_HasSample)
+			{
+				m_HasSample = true;
+				m_FirstRepCap = static_cast<int64_t>(snapshot.RemainingCapacity.GetMicroAmpereHours());
+			}
+			else
+			{
+				if ((snapshot.Sequence != 0 && snapshot.Sequence == m_LastSequence) || timestamp <= m_LastTimestamp)
+				{
+					return false;
+				}
+
+				int64_t duration = timestamp - m_LastTimestamp;
+				int64_t charge = (m_LastCurrent + current) * duration;
+				int64_t energy = (m_LastPower + power) * duration;
+				if (charge < 0)
+				{
+					m_Session.DischargedCharge.Add(-charge);
+				}
+				else
+				{
+					m_Session.RecoveredCharge.Add(charge);
+				}
+				if (energy < 0)
+				{
+					m_Session.DischargedEnergy.Add(-energy);
+				}
+				else
+				{
+					m_Session.RecoveredEnergy.Add(energy);
+				}
+				m_Session.Duration += duration;
+			}
+
+			m_LastSequence = snapshot.Sequence;
+			m_LastTimestamp = timestamp;
+			m_LastCurrent = current;
+			m_LastPower = power;
+			m_LastRepCap = static_cast<int64_t>(snapshot.RemainingCapacity.GetMicroAmpereHours());
+			return true;
+		}
+
+		/// <summary>
+		/// Feeds a QH reading for the cross-check. Consecutive readings must differ by less than half the register range.
+		/// </summary>
+		void AddCoulombCounter(uint16_t qh)
+		{
+			if (m_HasCoulombCounter)
+			{
+				m_CoulombCounterTotal += static_cast<int16_t>(static_cast<uint16_t>(qh - m_LastCoulombCounter));
+			}
+			m_HasCoulombCounter = true;
+			m_LastCoulombCounter = qh;
+		}
+
+		/// <summary>
+		/// Starts attributing usage to a window. Opening an open window does nothing.
+		/// </summary>
+		/// <returns>False if the window does not exist.</returns>
+		bool OpenWindow(size_t window)
+		{
+			if (window >= WindowCount)
+			{
+				return false;
+			}
+			if (!m_Windows[window].IsOpen)
+			{
+				m_Windows[window].IsOpen = true;
+				m_Windows[window].OpenedAt = m_Session;
+			}
+			return true;
+		}
+
+		/// <summary>
+		/// Stops attributing usage to a window. Usage so far is kept and continues when reopened.
+		/// </summary>
+		/// <returns>False if the window does not exist.</returns>
+		bool CloseWindow(size_t window)
+		{
+			if (window >= WindowCount)
+			{
+				return false;
+			}
+			if (m_Windows[window].IsOpen)
+			{
+				m_Windows[window].Total += m_Session - m_Windows[window].OpenedAt;
+				m_Windows[window].IsOpen = false;
+			}
+			return true;
+		}
+
+		bool IsWindowOpen(size_t window) const
+		{
+			return window < WindowCount && m_Windows[window].IsOpen;
+		}
+
+		/// <summary>
+		/// Usage attributed to a window, including the open part. Empty for windows that do not exist.
+		/// </summary>
+		UsageType GetWindowUsage(size_t window) const
+		{
+			if (window >= WindowCount)
+			{
+				return {};
+			}
+
+			Totals totals = m_Windows[window].Total;
+			if (m_Windows[window].IsOpen)
+			{
+				totals += m_Session - m_Windows[window].OpenedAt;
+			}
+			return ToUsage(totals);
+		}
+
+		/// <summary>
+		/// Usage since Reset().
+		/// </summary>
+		UsageType GetUsage() const
+		{
+			return ToUsage(m_Session);
+		}
+
+		/// <summary>
+		/// VCell * Current of the last snapshot.
+		/// </summary>
+		BasicMicroWatts<RSense> GetPower() const
+		{
+			return BasicMicroWatts<RSense>(m_LastPower);
+		}
+
+		/// <summary>
+		/// Net charge integrated since Reset() in uAh. Positive when charging.
+		/// </summary>
+		int64_t GetChargeChange() const
+		{
+			return (m_Session.RecoveredCharge - m_Session.DischargedCharge).Round();
+		}
+
+		/// <summary>
+		/// RepCap change since Reset() in uAh. Follows GetChargeChange() unless the gauge model corrected its estimate.
+		/// </summary>
+		int64_t GetRepCapChange() const
+		{
+			return m_HasSample ? m_LastRepCap - m_FirstRepCap : 0;
+		}
+
+		/// <summary>
+		/// QH change since Reset() in uAh. The gauge's own coulomb count; should track GetChargeChange() within sampling error.
+		/// </summary>
+		int64_t GetCoulombCounterChange() const
+		{
+			return DivideRounded(m_CoulombCounterTotal * static_cast<int64_t>(BasicMicroAmpereHours<RSense>::RawScaleNumerator), RSense);
+		}
+
+	private:
+		constexpr static int64_t MicrosecondsPerHour = 3600000000LL;
+
+		/// <summary>
+		/// Trapezoid sum of charge in 2 * uA*us or energy in 2 * uW*us, kept as whole uAh or uWh plus a remainder in [0, Unit).
+		/// </summary>
+		struct Accumulator
+		{
+			constexpr static int64_t Unit = 2 * MicrosecondsPerHour;
+
+			int64_t Whole = 0;
+			int64_t Remainder = 0;
+
+			void Add(int64_t value)
+			{
+				Remainder += value;
+				Normalize();
+			}
+
+			/// <summary>
+			/// Whole units, rounded half away from zero.
+			/// </summary>
+			int64_t Round() const
+			{
+				if (Whole < 0)
+				{
+					return -(-*this).Round();
+				}
+				return Whole + (Remainder >= Unit / 2 ? 1 : 0);
+			}
+
+			/// <summary>
+			/// Sum in 2 * uA*us or 2 * uW*us, for quotients that need not be exact.
+			/// </summary>
+			double ToDouble() const
+			{
+				return static_cast<double>(Whole) * static_cast<double>(Unit) + static_cast<double>(Remainder);
+			}
+
+			Accumulator operator-() const
+			{
+				Accumulator result{ -Whole, -Remainder };
+				result.Normalize();
+				return result;
+			}
+
+			Accumulator operator-(const Accumulator& other) const
+			{
+				Accumulator result{ Whole - other.Whole, Remainder - other.Remainder };
+				result.Normalize();
+				return result;
+			}
+
+			Accumulator& operator+=(const Accumulator& other)
+			{
+				Whole += other.Whole;
+				Remainder += other.Remainder;
+				Normalize();
+				return *this;
+			}
+
+			void Normalize()
+			{
+				Whole += Remainder / Unit;
+				Remainder %= Unit;
+				if (Remainder < 0)
+				{
+					Remainder += Unit;
+					Whole--;
+				}
+			}
+		};
+
+		/// <summary>
+		/// Trapezoid sums of charge and energy, duration in us.
+		/// </summary>
+		struct Totals
+		{
+			Accumulator DischargedCharge;
+			Accumulator RecoveredCharge;
+			Accumulator DischargedEnergy;
+			Accumulator RecoveredEnergy;
+			int64_t Duration = 0;
+
+			Totals operator-(const Totals& other) const
+			{
+				return Totals{ DischargedCharge - other.DischargedCharge, RecoveredCharge - other.RecoveredCharge,
+					DischargedEnergy - other.DischargedEnergy, RecoveredEnergy - other.RecoveredEnergy, Duration - other.Duration };
+			}
+
+			Totals& operator+=(const Totals& other)
+			{
+				DischargedCharge += other.DischargedCharge;
+				RecoveredCharge += other.RecoveredCharge;
+				DischargedEnergy += other.DischargedEnergy;
+				RecoveredEnergy += other.RecoveredEnergy;
+				Duration += other.Duration;
+				return *this;
+			}
+		};
+
+		struct Window
+		{
+			bool IsOpen = false;
+			Totals OpenedAt;
+			Totals Total;
+		};
+
+		Totals m_Session;
+		std::array<Window, WindowCount> m_Windows{};
+		bool m_HasSample = false;
+		uint64_t m_LastSequence = 0;
+		int64_t m_LastTimestamp = 0;
+		int64_t m_LastCurrent = 0;
+		int64_t m_LastPower = 0;
+		int64_t m_FirstRepCap = 0;
+		int64_t m_LastRepCap = 0;
+		bool m_HasCoulombCounter = false;
+		uint16_t m_LastCoulombCounter = 0;
+		int64_t m_CoulombCounterTotal = 0;
+
+		static constexpr int64_t DivideRounded(int64_t value, int64_t divisor)
+		{
+			return value >= 0 ? (value + divisor / 2) / divisor : -((-value + divisor / 2) / divisor);
+		}
+
+		static UsageType ToUsage(const Totals& totals)
+		{
+			UsageType usage;
+			usage.ConsumedCharge = BasicMicroAmpereHours<RSense>(static_cast<uint64_t>(totals.DischargedCharge.Round()));
+			usage.RecoveredCharge = BasicMicroAmpereHours<RSense>(static_cast<uint64_t>(totals.RecoveredCharge.Round()));
+			usage.ConsumedMicroWattHours = static_cast<uint64_t>(totals.DischargedEnergy.Round());
+			usage.RecoveredMicroWattHours = static_cast<uint64_t>(totals.RecoveredEnergy.Round());
+			usage.Duration = std::chrono::microseconds(totals.Duration);
+			if (totals.Duration > 0)
+			{
+				// Quotient only, so double precision is far below one uW
+				double energy = (totals.RecoveredEnergy - totals.DischargedEnergy).ToDouble();
+				usage.AveragePower = BasicMicroWatts<RSense>(static_cast<int64_t>(std::llround(energy / (2.0 * static_cast<double>(totals.Duration)))));
+			}
+			return usage;
+		}
+	};
+}
@@ -0,0 +1,241 @@
+#pragma once
+
+#include "PiSubmarine/Max1726/Max1726.h"
+#include "PiSubmarine/Max1726/PendingRequest.h"
+#include <chrono>
+#include <cstdint>
+
+namespace PiSubmarine::Max1726
+{
+	enum class InitState : uint8_t
+	{
+		Idle,
+		Running,
+		Done,
+		Failed
+	};
+
+	/// <summary>
+	/// Non-blocking counterpart of Device::InitBlocking, including the RSense check. Performs the same EZ config sequence as a resumable state machine:
+	/// every Step() either starts one transaction, evaluates a completed one or returns immediately while waiting.
+	/// Only the outcome of its own transactions counts; other users of the device do not affect it.
+	/// </summary>
+	template<typename DeviceType, typename Clock = std::chrono::steady_clock>
+	class InitAsync
+	{
+	public:
+		using TimePoint = typename Clock::time_point;
+
+		InitAsync(DeviceType& device) : m_Device(device)
+		{
+
+		}
+
+		/// <summary>
+		/// Starts initialization. Must be called on every power cycle, then Step() until Done or Failed.
+		/// </summary>
+		void Begin(typename DeviceType::MicroAmpereHoursType designCapacity, typename DeviceType::MicroAmperesType terminationCurrent, MicroVolts emptyVoltage, bool forceReset = false)
+		{
+			m_DesignCapacity = designCapacity;
+			m_TerminationCurrent = terminationCurrent;
+			m_EmptyVoltage = emptyVoltage;
+			m_Phase = forceReset ? Phase::Reset : Phase::ReadStatus;
+			m_ResumeTime = TimePoint{};
+			m_Request.Discard();
+			m_State = InitState::Running;
+		}
+
+		InitState GetState() const
+		{
+			return m_State;
+		}
+
+		/// <summary>
+		/// Advances the state machine. Never blocks.
+		/// </summary>
+		/// <param name="now">Current time</param>
+		/// <returns>State after the step.</returns>
+		InitState Step(TimePoint now)
+		{
+			if (m_State != InitState::Running)
+			{
+				return m_State;
+			}
+
+			switch (m_Request.Poll())
+			{
+			case RequestResult::Pending:
+				return m_State;
+			case RequestResult::Failed:
+				m_State = InitState::Failed;
+				return m_State;
+			default:
+				break;
+			}
+
+			if (now < m_ResumeTime)
+			{
+				return m_State;
+			}
+
+			switch (m_Phase)
+			{
+			case Phase::Reset:
+				m_Device.SetCommand(Command::Reset);
+				Write(RegOffset::Command, Phase::ResetDelay);
+				break;
+			case Phase::ResetDelay:
+				Delay(now, std::chrono::milliseconds(500), Phase::PorCommand);
+				break;
+			case Phase::PorCommand:
+				m_Device.SetRegisterValue(RegOffset::Config2, 0x01);
+				Write(RegOffset::Config2, Phase::PorCommandDelay);
+				break;
+			case Phase::PorCommandDelay:
+				Delay(now, std::chrono::milliseconds(500), Phase::ReadStatus);
+				break;
+			case Phase::ReadStatus:
+				Read(RegOffset::Status, Phase::CheckStatus);
+				break;
+			case Phase::CheckStatus:
+				m_Phase = RegUtils::HasAllFlags(m_Device.GetStatus(), Status::PowerOnReset) ? Phase::ReadFStat : Phase::ReadRSense;
+				break;
+			case Phase::ReadRSense:
+				Read(RegOffset::RSense, Phase::CheckRSense);
+				break;
+			case Phase::CheckRSense:
+				if (!m_Device.IsSenseResistorMatching())
+				{
+					m_State = InitState::Failed;
+					break;
+				}
+				m_Phase = Phase::ReadStatusForClear;
+				break;
+			case Phase::ReadFStat:
+				Read(RegOffset::FStat, Phase::CheckFStat);
+				break;
+			case Phase::CheckFStat:
+				if (RegUtils::HasAllFlags(m_Device.GetFStat(), FStat::DataNotReady))
+				{
+					Delay(now, std::chrono::milliseconds(10), Phase::ReadFStat);
+				}
+				else
+				{
+					m_Phase = Phase::ReadHibCfg;
+				}
+				break;
+			case Phase::ReadHibCfg:
+				Read(RegOffset::HibCfg, Phase::SoftWakeup);
+				break;
+			case Phase::SoftWakeup:
+				m_HibCfg = m_Device.GetRegisterValue(RegOffset::HibCfg);
+				m_Device.SetCommand(Command::SoftWakeup);
+				Write(RegOffset::Command, Phase::ClearHibCfg);
+				break;
+			case Phase::ClearHibCfg:
+				m_Device.SetRegisterValue(RegOffset::HibCfg, 0);
+				Write(RegOffset::HibCfg, Phase::ClearCommand);
+				break;
+			case Phase::ClearCommand:
+				m_Device.SetCommand(Command::Clear);
+				Write(RegOffset::Command, Phase::EzConfig);
+				break;
+			case Phase::EzConfig:
+				m_Device.SetSenseResistor();
+				m_Device.SetDesignCapacity(m_DesignCapacity);
+				m_Device.SetTerminationCurrent(m_TerminationCurrent);
+				m_Device.SetEmptyVoltage(m_EmptyVoltage);
+				m_Device.SetModelId(ModelId::Li);
+				m_Device.SetHighChargeVoltage(false);
+				m_Device.SetModelRefreshFlag(true);
+				m_Request.Track(m_Device.WriteDirty(m_Request.GetCompletion()), m_Phase, Phase::ReadModelCfg);
+				break;
+			case Phase::ReadModelCfg:
+				Read(RegOffset::ModelCfg, Phase::CheckModelCfg);
+				break;
+			case Phase::CheckModelCfg:
+				if (m_Device.IsModelRefreshFlagSet())
+				{
+					Delay(now, std::chrono::milliseconds(10), Phase::ReadModelCfg);
+				}
+				else
+				{
+					m_Phase = Phase::RestoreHibCfg;
+				}
+				break;
+			case Phase::RestoreHibCfg:
+				m_Device.SetRegisterValue(RegOffset::HibCfg, m_HibCfg);
+				Write(RegOffset::HibCfg, Phase::ReadStatusForClear);
+				break;
+			case Phase::ReadStatusForClear:
+				Read(RegOffset::Status, Phase::ClearPowerOnReset);
+				break;
+			case Phase::ClearPowerOnReset:
+			{
+				auto status = m_Device.GetStatus();
+				if (!RegUtils::HasAnyFlag(status, Status::PowerOnReset))
+				{
+					m_State = InitState::Done;
+					break;
+				}
+				m_Device.SetStatus(RegUtils::operator&(status, RegUtils::operator~(Status::PowerOnReset)));
+				Write(RegOffset::Status, Phase::ReadStatusForClear);
+				break;
+			}
+			}
+
+			return m_State;
+		}
+
+	private:
+		enum class Phase : uint8_t
+		{
+			Reset,
+			ResetDelay,
+			PorCommand,
+			PorCommandDelay,
+			ReadStatus,
+			CheckStatus,
+			ReadRSense,
+			CheckRSense,
+			ReadFStat,
+			CheckFStat,
+			ReadHibCfg,
+			SoftWakeup,
+			ClearHibCfg,
+			ClearCommand,
+			EzConfig,
+			ReadModelCfg,
+			CheckModelCfg,
+			RestoreHibCfg,
+			ReadStatusForClear,
+			ClearPowerOnReset
+		};
+
+		DeviceType& m_Device;
+		InitState m_State = InitState::Idle;
+		Phase m_Phase = Phase::ReadStatus;
+		TimePoint m_ResumeTime{};
+		PendingRequest<DeviceType> m_Request;
+		uint16_t m_HibCfg = 0;
+		typename DeviceType::MicroAmpereHoursType m_DesignCapacity;
+		typename DeviceType::MicroAmperesType m_TerminationCurrent;
+		MicroVolts m_EmptyVoltage;
+
+		void Read(RegOffset reg, Phase next)
+		{
+			m_Request.Track(m_Device.Read(reg, m_Request.GetCompletion()), m_Phase, next);
+		}
+
+		void Write(RegOffset reg, Phase next)
+		{
+			m_Request.Track(m_Device.Write(reg, m_Request.GetCompletion()), m_Phase, next);
+		}
+
+		void Delay(TimePoint now, std::chrono::milliseconds delay, Phase next)
+		{
+			m_ResumeTime = now + delay;
+			m_Phase = next;
+		}
+	};
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace PiSubmarine::Max1726
+{
+	/// <summary>
+	/// Fixed-size file mapped read-write into memory. Stores to the mapping reach the file without system calls; Sync() forces them to disk.
+	/// </summary>
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		~MappedFile()
+		{
+			Close();
+		}
+
+		/// <summary>
+		/// Opens or creates the file, resizes it to size bytes and maps it. Existing content within size is preserved.
+		/// </summary>
+		/// <returns>False if the file could not be created, resized or mapped.</returns>
+		bool Open(const char* path, size_t size)
+		{
+			Close();
+			if (size == 0)
+			{
+				return false;
+			}
+
+#ifdef _WIN32
+			m_File = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (m_File == INVALID_HANDLE_VALUE)
+			{
+				return false;
+			}
+
+			uint64_t size64 = size;
+			m_Mapping = CreateFileMappingA(m_File, nullptr, PAGE_READWRITE, static_cast<DWORD>(size64 >> 32), static_cast<DWORD>(size64 & 0xFFFFFFFF), nullptr);
+			if (m_Mapping == nullptr)
+			{
+				Close();
+				return false;
+			}
+
+			void* data = MapViewOfFile(m_Mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+			if (data == nullptr)
+			{
+				Close();
+				return false;
+			}
+#else
+			m_File = open(path, O_RDWR | O_CREAT, 0644);
+			if (m_File < 0)
+			{
+				return false;
+			}
+
+			struct stat info {};
+			if (fstat(m_File, &info) != 0 || (static_cast<size_t>(info.st_size) != size && ftruncate(m_File, static_cast<off_t>(size)) != 0))
+			{
+				Close();
+				return false;
+			}
+
+			void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_File, 0);
+			if (data == MAP_FAILED)
+			{
+				Close();
+				return false;
+			}
+#endif
+			m_Data = std::span<uint8_t>(static_cast<uint8_t*>(data), size);
+			return true;
+		}
+
+		void Close()
+		{
+#ifdef _WIN32
+			if (!m_Data.empty())
+			{
+				UnmapViewOfFile(m_Data.data());
+			}
+			if (m_Mapping != nullptr)
+			{
+				CloseHandle(m_Mapping);
+				m_Mapping = nullptr;
+			}
+			if (m_File != INVALID_HANDLE_VALUE)
+			{
+				CloseHandle(m_File);
+				m_File = INVALID_HANDLE_VALUE;
+			}
+#else
+			if (!m_Data.empty())
+			{
+				munmap(m_Data.data(), m_Data.size());
+			}
+			if (m_File >= 0)
+			{
+				close(m_File);
+				m_File = -1;
+			}
+#endif
+			m_Data = {};
+		}
+
+		bool IsOpen() const
+		{
+			return !m_Data.empty();
+		}
+
+		std::span<uint8_t> GetData() const
+		{
+			return m_Data;
+		}
+
+		/// <summary>
+		/// Writes modified pages to disk. Blocks; call it from a thread other than acquisition.
+		/// </summary>
+		bool Sync()
+		{
+			if (m_Data.empty())
+			{
+				return false;
+			}
+#ifdef _WIN32
+			return FlushViewOfFile(m_Data.data(), m_Data.size()) && FlushFileBuffers(m_File);
+#else
+			return msync(m_Data.data(), m_Data.size(), MS_SYNC) == 0;
+#endif
+		}
+
+	private:
+#ifdef _WIN32
+		HANDLE m_File = INVALID_HANDLE_VALUE;
+		HANDLE m_Mapping = nullptr;
+#else
+		int m_File = -1;
+#endif
+		std::span<uint8_t> m_Data;
+	};
+}
@@ -4,287 +4,1681 @@
 #include "PiSubmarine/Max1726/MicroAmpereHours.h"
 #include "PiSubmarine/Max1726/MicroAmperes.h"
 #include "PiSubmarine/Max1726/MicroVolts.h"
+#include "PiSubmarine/Max1726/MicroWatts.h"
 #include "PiSubmarine/Max1726/MilliCelcius.h"
+#include "PiSubmarine/Max1726/BoundedQueue.h"
+#include "PiSubmarine/Max1726/Checkpoint.h"
+#include "PiSubmarine/Max1726/RegisterFile.h"
+#include "PiSubmarine/Max1726/RegisterMap.h"
+#include "PiSubmarine/Max1726/RegisterStats.h"
+#include "PiSubmarine/Max1726/SeqLock.h"
 #include "PiSubmarine/Api/Internal/I2C/DriverConcept.h"
-#include <bitset>
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <chrono>
+#include <coroutine>
+#include <optional>
+#include <span>
+#include <utility>
 
 namespace PiSubmarine::Max1726
 {
 	using WaitFunc = std::function<void(std::chrono::milliseconds)>;
 
-	enum class RegOffset : uint8_t
+	/// <summary>
+	/// Runs task once after delay, from a timer or dispatcher thread rather than inline. Lets the device wait without blocking the thread that completed a transaction.
+	/// </summary>
+	using ScheduleFunc = std::function<void(std::chrono::microseconds delay, std::function<void()> task)>;
+
+	/// <summary>
+	/// Coherent set of telemetry values taken from a single burst read.
+	/// </summary>
+	template<typename Clock = std::chrono::steady_clock, int64_t RSense = DefaultRSenseMicroOhms>
+	struct TelemetrySnapshot
+	{
+		/// <summary>
+		/// Number of the acquisition cycle this sample came from. Zero if nothing was acquired yet.
+		/// </summary>
+		uint64_t Sequence = 0;
+		typename Clock::time_point Timestamp{};
+		Max1726::Status Status{};
+		BasicMicroAmpereHours<RSense> RemainingCapacity;
+		uint16_t RemainingSoc = 0;
+		MilliCelsius Temperature;
+		MicroVolts VCell;
+		BasicMicroAmperes<RSense> Current;
+		BasicMicroAmperes<RSense> AverageCurrent;
+		uint16_t TimeToEmpty = 0;
+	};
+
+	/// <summary>
+	/// Gauge prediction for a hypothetical constant load, taken from the At* registers. Rate is the input, the rest is filled in by Device::EvaluateAtRate.
+	/// </summary>
+	template<int64_t RSense = DefaultRSenseMicroOhms>
+	struct AtRatePrediction
+	{
+		/// <summary>
+		/// Candidate load. Negative for discharge, like Current.
+		/// </summary>
+		BasicMicroAmperes<RSense> Rate{};
+
+		/// <summary>
+		/// Capacity left in the cell that cannot be delivered at Rate before reaching VEmpty (AtQResidual).
+		/// </summary>
+		BasicMicroAmpereHours<RSense> ResidualCapacity{};
+
+		/// <summary>
+		/// Capacity deliverable at Rate (AtAvCap).
+		/// </summary>
+		BasicMicroAmpereHours<RSense> AvailableCapacity{};
+
+		/// <summary>
+		/// Deliverable state of charge at Rate in 1/256 % (AtAvSOC).
+		/// </summary>
+		uint16_t AvailableSoc = 0;
+
+		/// <summary>
+		/// Time to empty at Rate in 5.625 s steps (AtTTE). 0xFFFF when Rate is not a discharge.
+		/// </summary>
+		uint16_t TimeToEmpty = 0;
+
+		/// <summary>
+		/// Set once the prediction was read back. Stays false for candidates not reached because of a bus error.
+		/// </summary>
+		bool IsValid = false;
+	};
+
+	template<typename Clock = std::chrono::steady_clock>
+	struct QueueStats
+	{
+		size_t Depth = 0;
+		size_t MaxDepth = 0;
+
+		/// <summary>
+		/// Number of transactions taken from the queue.
+		/// </summary>
+		uint64_t Dispatched = 0;
+
+		/// <summary>
+		/// Number of requests refused because the queue was full.
+		/// </summary>
+		uint64_t Rejected = 0;
+		typename Clock::duration TotalWaitTime{};
+		typename Clock::duration MaxWaitTime{};
+
+		typename Clock::duration GetAverageWaitTime() const
+		{
+			return Dispatched > 0 ? TotalWaitTime / static_cast<typename Clock::rep>(Dispatched) : typename Clock::duration{};
+		}
+	};
+
+	/// <summary>
+	/// How a failed bus transaction is repeated. Each burst of a request is retried on its own, so a WriteDirty resumes from the run that failed.
+	/// </summary>
+	struct RetryPolicy
+	{
+		/// <summary>
+		/// Attempts per bus transaction, including the first one. 1 disables retries.
+		/// </summary>
+		uint8_t MaxAttempts = 1;
+
+		/// <summary>
+		/// Backoff before the first retry. Doubles with each further retry up to MaxBackoff.
+		/// Waited out through the device scheduler, so the thread that completed the failed transaction never sleeps. Retries need a scheduler, see Device::SetRetryPolicy.
+		/// </summary>
+		std::chrono::milliseconds InitialBackoff{ 1 };
+		std::chrono::milliseconds MaxBackoff{ 20 };
+
+		/// <summary>
+		/// Consecutive failed attempts after which the bus recovery hook runs, and again after as many more. 0 never runs it.
+		/// </summary>
+		uint8_t RecoveryThreshold = 0;
+	};
+
+	template<typename Clock = std::chrono::steady_clock>
+	struct RecoveryStats
 	{
-		Status = 0x00,
-		VAlrtTh = 0x01,
-		TAlrtTh = 0x02,
-		SAlrtTh = 0x03,
-		AtRate = 0x04,
-		RepCap = 0x05,
-		RepSOC = 0x06,
-		Age = 0x07,
-		Temp = 0x08,
-		VCell = 0x09,
-		Current = 0x0A,
-		AvgCurrent = 0x0B,
-		QResidual = 0x0C,
-		MixSOC = 0x0D,
-		AvSOC = 0x0E,
-		MixCap = 0x0F,
-		FullCapRep = 0x10,
-		TTE = 0x11,
-		QRTable00 = 0x12,
-		FullSocThr = 0x13,
-		RCell = 0x14,
-		AvgTA = 0x16,
-		Cycles = 0x17,
-		DesignCap = 0x18,
-		AvgVCell = 0x19,
-		MaxMinTemp = 0x1A,
-		MaxMinVolt = 0x1B,
-		MaxMinCurr = 0x1C,
-		Config = 0x1D,
-		IChgTerm = 0x1E,
-		TTF = 0x20,
-		DevName = 0x21,
-		QRTable10 = 0x22,
-		FullCapNom = 0x23,
-		AIN = 0x27,
-		LearnCfg = 0x28,
-		FilterCfg = 0x29,
-		RelaxCfg = 0x2A,
-		MiscCfg = 0x2B,
-		TGain = 0x2C,
-		TOff = 0x2D,
-		CGain = 0x2E,
-		COff = 0x2F,
-		QRTable20 = 0x32,
-		DieTemp = 0x34,
-		FullCap = 0x35,
-		RComp0 = 0x38,
-		TempCo = 0x39,
-		VEmpty = 0x3A,
-		FStat = 0x3D,
-		Timer = 0x3E,
-		ShdnTimer = 0x3F,
-		QRTable30 = 0x42,
-		RGain = 0x43,
-		dQAcc = 0x45,
-		dPAcc = 0x46,
-		ConvgCfg = 0x49,
-		VFRemCap = 0x4A,
-		QH = 0x4D,
-		Command = 0x60,
-		Status2 = 0xB0,
-		Power = 0xB1,
-		ID = 0xB2,
-		AvgPower = 0xB3,
-		IAlrtTh = 0xB4,
-		TTFCfg = 0xB5,
-		CVMixCap = 0xB6,
-		CVHalfTime = 0xB7,
-		CGTempCo = 0xB8,
-		Curve = 0xB9,
-		HibCfg = 0xBA,
-		Config2 = 0xBB,
-		VRipple = 0xBC,
-		RippleCfg = 0xBD,
-		TimerH = 0xBE,
-		RSense = 0xD0,
-		ScOcvLim = 0xD1,
-		VGain = 0xD2,
-		SOCHold = 0xD3,
-		MaxPeakPower = 0xD4,
-		SusPeakPower = 0xD5,
-		PackResistance = 0xD6,
-		SysResistance = 0xD7,
-		MinSysVoltage = 0xD8,
-		MPPCurrent = 0xD9,
-		SPPCurrent = 0xDA,
-		ModelCfg = 0xDB,
-		AtQResidual = 0xDC,
-		AtTTE = 0xDD,
-		AtAvSOC = 0xDE,
-		AtAvCap = 0xDF
+		/// <summary>
+		/// Number of bus transactions repeated after a failure.
+		/// </summary>
+		uint64_t Retries = 0;
+
+		/// <summary>
+		/// Number of requests that failed after using up all attempts.
+		/// </summary>
+		uint64_t Exhausted = 0;
+
+		/// <summary>
+		/// Number of times the bus recovery hook ran.
+		/// </summary>
+		uint64_t BusRecoveries = 0;
+
+		/// <summary>
+		/// Number of failure streaks ended by a successful transaction. Recovery time runs from the first failure of a streak to that success.
+		/// </summary>
+		uint64_t Recovered = 0;
+		typename Clock::duration TotalRecoveryTime{};
+		typename Clock::duration MaxRecoveryTime{};
+
+		typename Clock::duration GetAverageRecoveryTime() const
+		{
+			return Recovered > 0 ? TotalRecoveryTime / static_cast<typename Clock::rep>(Recovered) : typename Clock::duration{};
+		}
 	};
 
-	enum class Status : uint16_t
-	{
-		PowerOnReset = (1 << 1),
-		MinimumCurrentAlert = (1 << 2),
-		BatteryPresent = (1 << 3),
-		MaximumCurrentAlert = (1 << 6),
-		StateOfChargeChanged = (1 << 7),
-		MinimumVoltageAlert = (1 << 8),
-		MinimumTemperatureAlert = (1 << 9),
-		MinimumStateOfCharge = (1 << 10),
-		MaximumVoltageAlert = (1 << 12),
-		MaximumTemperatureAlert = (1 << 13),
-		MaximumStateOfChargeAlert = (1 << 14),
-		BatteryRemoved = (1 << 15)
-	};
+	/// <summary>
+	/// MAX1726 driver. Requests (Read, Write, WriteDirty, ...) and the statistics and telemetry getters are safe to call from any thread.
+	/// The shadow register file behind the register getters and setters is not synchronised: completion callbacks write it while requests are in flight.
+	/// Touch it from one thread only, and only while no request is in flight or after the request that read it has completed.
+	/// </summary>
+	/// <typeparam name="I2CDriver">Bus driver</typeparam>
+	/// <typeparam name="Clock">Time source for timestamps and statistics</typeparam>
+	/// <typeparam name="StatsPolicy">NoRegisterStats, or RegisterStats to count traffic per register</typeparam>
+	/// <typeparam name="RSense">Sense resistor in uOhm. Current and capacity conversions are folded for it at compile time</typeparam>
+	template<PiSubmarine::Api::Internal::I2C::DriverConcept I2CDriver, typename Clock = std::chrono::steady_clock, typename StatsPolicy = NoRegisterStats, int64_t RSense = DefaultRSenseMicroOhms>
+	class Device
+	{
+	private:
+		enum class TransactionKind : uint8_t
+		{
+			None,
+			Read,
+			Telemetry,
+			Write,
+			WriteDirty,
+			AtRate,
+
+			/// <summary>
+			/// WriteDirtyAndVerify. Writes dirty runs like WriteDirty, then continues as VerifyRead.
+			/// </summary>
+			WriteDirtyVerify,
+			VerifyRead
+		};
+
+	public:
+		/// <summary>
+		/// Completion state of a single request. Lives inside the Awaiter, or in a non-blocking state machine that passes it to Read, ReadTelemetry,
+		/// Write or WriteDirty and polls it, so other traffic on the device neither delays nor fails it. Must outlive the request and is reused once done.
+		/// </summary>
+		class Completion
+		{
+		public:
+			/// <summary>
+			/// Returns true once the request has finished. Safe to call from any thread.
+			/// </summary>
+			bool IsDone() const
+			{
+				return m_IsDone.load(std::memory_order_acquire);
+			}
+
+			/// <summary>
+			/// Returns true if the finished request succeeded. Only meaningful once IsDone() is true.
+			/// </summary>
+			bool IsOk() const
+			{
+				return m_IsOk;
+			}
+
+		private:
+			friend class Device;
+
+			std::coroutine_handle<> m_Handle{};
+			std::atomic<bool> m_IsDone = false;
+			bool m_IsOk = false;
+		};
+
+		using MicroAmperesType = BasicMicroAmperes<RSense>;
+		using MicroAmpereHoursType = BasicMicroAmpereHours<RSense>;
+		using MicroWattsType = BasicMicroWatts<RSense>;
+		using TelemetrySnapshotType = TelemetrySnapshot<Clock, RSense>;
+		using LearnedParametersType = BasicLearnedParameters<RSense>;
+		using SenseFieldsType = SenseFields<RSense>;
+		using AtRatePredictionType = AtRatePrediction<RSense>;
+
+		constexpr static uint8_t Address = 0x36;
+
+		/// <summary>
+		/// Content of the RSense register (10 uOhm per LSB) matching the compile-time sense resistor.
+		/// </summary>
+		constexpr static uint16_t RSenseRegisterValue = static_cast<uint16_t>(RSense / 10);
+		static_assert(RSense % 10 == 0 && RSense / 10 <= 0xFFFF, "RSense register cannot represent the sense resistor");
+
+		/// <summary>
+		/// Register range fetched by ReadTelemetry. Status through TTE, covering every TelemetrySnapshot field.
+		/// </summary>
+		constexpr static RegOffset TelemetryFirst = RegOffset::Status;
+		constexpr static RegOffset TelemetryLast = RegOffset::TTE;
+		static_assert(IsReadableRange(TelemetryFirst, TelemetryLast));
+
+		/// <summary>
+		/// Register range read back for every AtRate candidate.
+		/// </summary>
+		constexpr static RegOffset AtResultFirst = RegOffset::AtQResidual;
+		constexpr static RegOffset AtResultLast = RegOffset::AtAvCap;
+		static_assert(IsReadableRange(AtResultFirst, AtResultLast));
+
+		/// <summary>
+		/// Maximum number of requests waiting for the bus.
+		/// </summary>
+		constexpr static size_t QueueCapacity = 32;
+
+		/// <summary>
+		/// Number of times WriteDirtyAndVerify writes a register again after it read back wrong.
+		/// </summary>
+		constexpr static size_t MaxVerifyRewrites = 2;
+
+		Device(I2CDriver& driver) : m_Driver(driver)
+		{
+
+		}
+
+		/// <summary>
+		/// Returns true if there is a pending or queued read/write I2C transation.
+		/// </summary>
+		/// <returns>True if transaction not finished.</returns>
+		bool IsTransactionInProgress()
+		{
+			return m_PendingCount > 0;
+		}
+
+		/// <summary>
+		/// Returns true if any transaction failed since the device was last idle. Cleared to false when a request is queued on an idle device.
+		/// </summary>
+		/// <returns>True if has error.</returns>
+		bool HasError()
+		{
+			return m_HasError;
+		}
+
+		/// <summary>
+		/// Returns number of requests waiting for the bus, not counting the one in flight.
+		/// </summary>
+		size_t GetQueueDepth() const
+		{
+			return m_Queue.GetSize();
+		}
+
+		QueueStats<Clock> GetQueueStats() const
+		{
+			QueueStats<Clock> stats;
+			stats.Depth = m_Queue.GetSize();
+			stats.MaxDepth = m_MaxQueueDepth;
+			stats.Dispatched = m_DispatchedCount;
+			stats.Rejected = m_RejectedCount;
+			stats.TotalWaitTime = typename Clock::duration(m_TotalWaitTicks.load());
+			stats.MaxWaitTime = typename Clock::duration(m_MaxWaitTicks.load());
+			return stats;
+		}
+
+		/// <summary>
+		/// Sets how failed bus transactions are retried. Retries wait out their backoff through the scheduler, so set that first.
+		/// Must not be called while transactions are in flight.
+		/// </summary>
+		/// <returns>False if the policy retries but no scheduler is set. The policy in effect is kept then.</returns>
+		bool SetRetryPolicy(RetryPolicy policy)
+		{
+			if (policy.MaxAttempts > 1 && !m_Scheduler)
+			{
+				return false;
+			}
+			m_RetryPolicy = std::move(policy);
+			return true;
+		}
+
+		const RetryPolicy& GetRetryPolicy() const
+		{
+			return m_RetryPolicy;
+		}
+
+		/// <summary>
+		/// Sets the hook that gets a stuck bus going again, e.g. by clocking SCL until the gauge releases SDA.
+		/// Runs after RetryPolicy::RecoveryThreshold consecutive failures, before the next retry, on the thread that completed the failed transaction.
+		/// Must not be called while transactions are in flight.
+		/// </summary>
+		void SetBusRecovery(std::function<void()> recovery)
+		{
+			m_BusRecovery = std::move(recovery);
+		}
+
+		/// <summary>
+		/// Sets how the device waits without blocking, for retry backoff and the AtRate settle time. Removing it turns retries off.
+		/// Must not be called while transactions are in flight.
+		/// </summary>
+		void SetScheduler(ScheduleFunc scheduler)
+		{
+			m_Scheduler = std::move(scheduler);
+			if (!m_Scheduler)
+			{
+				m_RetryPolicy.MaxAttempts = 1;
+			}
+		}
+
+		/// <summary>
+		/// Sets the delay between writing an AtRate candidate and reading its results. Defaults to one active task period;
+		/// the gauge updates less often in hibernate. Must not be called while transactions are in flight.
+		/// </summary>
+		void SetAtRateSettleTime(std::chrono::microseconds settleTime)
+		{
+			m_AtRateSettleTime = settleTime;
+		}
+
+		std::chrono::microseconds GetAtRateSettleTime() const
+		{
+			return m_AtRateSettleTime;
+		}
+
+		RecoveryStats<Clock> GetRecoveryStats() const
+		{
+			RecoveryStats<Clock> stats;
+			stats.Retries = m_RetryCount;
+			stats.Exhausted = m_ExhaustedCount;
+			stats.BusRecoveries = m_BusRecoveryCount;
+			stats.Recovered = m_RecoveredCount;
+			stats.TotalRecoveryTime = typename Clock::duration(m_TotalRecoveryTicks.load());
+			stats.MaxRecoveryTime = typename Clock::duration(m_MaxRecoveryTicks.load());
+			return stats;
+		}
+
+		/// <summary>
+		/// Reads specific register. Safe to call from any thread; the request is queued if the bus is busy.
+		/// </summary>
+		/// <param name="reg">Register offset</param>
+		/// <returns>True if transaction was started or queued. False if the queue is full.</returns>
+		bool Read(RegOffset reg)
+		{
+			return Read(reg, reg);
+		}
+
+		/// <summary>
+		/// Reads a contiguous block of registers in a single auto-incrementing transaction.
+		/// </summary>
+		/// <param name="first">First register offset</param>
+		/// <param name="last">Last register offset, inclusive</param>
+		/// <returns>True if transaction was started or queued.</returns>
+		bool Read(RegOffset first, RegOffset last)
+		{
+			return SubmitRead(first, last, nullptr);
+		}
+
+		/// <summary>
+		/// Reads a block of registers and reports the outcome through completion only.
+		/// </summary>
+		/// <returns>True if transaction was started or queued.</returns>
+		bool Read(RegOffset first, RegOffset last, Completion& completion)
+		{
+			return SubmitRead(first, last, &completion);
+		}
+
+		bool Read(RegOffset reg, Completion& completion)
+		{
+			return SubmitRead(reg, reg, &completion);
+		}
+
+		/// <summary>
+		/// Reads a block of registers checked against RegisterTable at compile time.
+		/// </summary>
+		/// <returns>True if transaction was started or queued. False if the queue is full.</returns>
+		template<RegOffset First, RegOffset Last = First>
+		bool Read()
+		{
+			static_assert(IsReadableRange(First, Last), "Range is reversed or contains a write-only register");
+			return Read(First, Last);
+		}
+
+		/// <summary>
+		/// Reads telemetry registers in one burst and publishes a new TelemetrySnapshot once the transaction completes.
+		/// </summary>
+		/// <returns>True if transaction was started or queued.</returns>
+		bool ReadTelemetry()
+		{
+			size_t count = RegUtils::ToInt(TelemetryLast) - RegUtils::ToInt(TelemetryFirst) + 1;
+			return Submit(TransactionKind::Telemetry, RegUtils::ToInt(TelemetryFirst), count);
+		}
+
+		bool ReadTelemetry(Completion& completion)
+		{
+			size_t count = RegUtils::ToInt(TelemetryLast) - RegUtils::ToInt(TelemetryFirst) + 1;
+			return Submit(TransactionKind::Telemetry, RegUtils::ToInt(TelemetryFirst), count, &completion);
+		}
+
+		/// <summary>
+		/// Returns the last published telemetry snapshot. Lock-free and safe to call from any thread; does not touch the bus.
+		/// </summary>
+		TelemetrySnapshotType GetTelemetry() const
+		{
+			return m_Telemetry.Load();
+		}
+
+		bool ReadAndWait(RegOffset reg, WaitFunc waitFunc)
+		{
+			if (!Read(reg))
+			{
+				return false;
+			}
+
+			WaitForTransaction(waitFunc);
+			return !HasError();
+		}
+
+		bool ReadAndWait(RegOffset first, RegOffset last, WaitFunc waitFunc)
+		{
+			if (!Read(first, last))
+			{
+				return false;
+			}
+
+			WaitForTransaction(waitFunc);
+			return !HasError();
+		}
+
+		/// <summary>
+		/// Writes specific register. The shadow value is taken when the transaction leaves the queue.
+		/// </summary>
+		/// <param name="reg">Register offset</param>
+		/// <returns>True if transaction was started or queued. False if the queue is full.</returns>
+		bool Write(RegOffset reg)
+		{
+			return Submit(TransactionKind::Write, RegUtils::ToInt(reg), 1);
+		}
+
+		bool Write(RegOffset reg, Completion& completion)
+		{
+			return Submit(TransactionKind::Write, RegUtils::ToInt(reg), 1, &completion);
+		}
+
+		/// <summary>
+		/// Writes a block of registers in a single transaction. Range is checked against RegisterTable at compile time.
+		/// </summary>
+		/// <returns>True if transaction was started or queued. False if the queue is full.</returns>
+		template<RegOffset First, RegOffset Last = First>
+		bool Write()
+		{
+			static_assert(IsWritableRange(First, Last), "Range is reversed or contains a reserved or read-only register");
+			return Submit(TransactionKind::Write, RegUtils::ToInt(First), RegUtils::ToInt(Last) - RegUtils::ToInt(First) + 1);
+		}
+
+		bool WriteAndWait(RegOffset reg, WaitFunc waitFunc)
+		{
+			if (!Write(reg))
+			{
+				return false;
+			}
+
+			WaitForTransaction(waitFunc);
+			return !HasError();
+		}
+
+		/// <summary>
+		/// Writes all dirty registers. Adjacent dirty registers are grouped into runs and each run is sent as a single burst write.
+		/// A run stays dirty until it is written, so calling again after a failure resumes from the run that failed.
+		/// Dirty registers are looked up once the request owns the bus; with none it finishes without bus traffic.
+		/// </summary>
+		/// <returns>True if transaction was started or queued. False if the queue is full.</returns>
+		bool WriteDirty()
+		{
+			return Submit(TransactionKind::WriteDirty, 0, 0);
+		}
+
+		bool WriteDirty(Completion& completion)
+		{
+			return Submit(TransactionKind::WriteDirty, 0, 0, &completion);
+		}
+
+		/// <summary>
+		/// Writes all dirty registers like WriteDirty, then reads back the written ones and compares them under GetVerifyMask.
+		/// Registers that do not match are written and read back again, up to MaxVerifyRewrites times; matching ones are left alone.
+		/// Read-back is done in as few burst reads as possible. The request fails if a register still does not match, and it stays dirty.
+		/// </summary>
+		/// <returns>True if transaction was started or queued. False if the queue is full.</returns>
+		bool WriteDirtyAndVerify()
+		{
+			return Submit(TransactionKind::WriteDirtyVerify, 0, 0);
+		}
+
+		/// <summary>
+		/// Returns number of registers that read back wrong during the last WriteDirtyAndVerify call, over all rounds.
+		/// </summary>
+		size_t GetVerifyMismatchCount() const
+		{
+			return m_VerifyMismatchCount;
+		}
+
+		/// <summary>
+		/// Returns number of I2C transactions issued by the last WriteDirty call.
+		/// </summary>
+		/// <returns>Number of burst writes issued so far.</returns>
+		size_t GetWriteDirtyTransactionCount() const
+		{
+			return m_WriteDirtyTransactionCount;
+		}
+
+		bool HasDirtyRegisters()
+		{
+			return m_Registers.HasDirty();
+		}
+
+		/// <summary>
+		/// Evaluates what-if loads. For every entry AtRate is written with its Rate and AtQResidual to AtAvCap are burst-read back into it,
+		/// two bus transactions per candidate. The gauge recomputes the At* registers on its next task, so the read follows the write after
+		/// the AtRate settle time, waited out through the scheduler with the bus released for other requests.
+		/// The batch is a single request: other requests wait at most for one bus transaction of it, and the AtRate shadow register is left untouched.
+		/// Only one batch runs at a time. The table must stay alive until the transaction is finished.
+		/// </summary>
+		/// <param name="predictions">Rate of every entry is the input, the rest is filled in on completion</param>
+		/// <returns>True if transaction was started or queued. False if the table is empty, no scheduler is set, another batch is running or the queue is full.</returns>
+		bool EvaluateAtRate(std::span<AtRatePredictionType> predictions)
+		{
+			if (predictions.empty() || predictions.size() > UINT16_MAX || !m_Scheduler)
+			{
+				return false;
+			}
+
+			bool expected = false;
+			if (!m_IsAtRateRunning.compare_exchange_strong(expected, true))
+			{
+				return false;
+			}
+
+			for (auto& prediction : predictions)
+			{
+				prediction.IsValid = false;
+			}
+			if (!Submit(Transaction{ TransactionKind::AtRate, RegUtils::ToInt(RegOffset::AtRate), 1, {}, nullptr, predictions.data(), static_cast<uint16_t>(predictions.size()) }))
+			{
+				m_IsAtRateRunning = false;
+				return false;
+			}
+			return true;
+		}
+
+		/// <summary>
+		/// Evaluates what-if loads, filling predictions with one row per entry of rates.
+		/// </summary>
+		/// <returns>True if transaction was started or queued. False if the tables differ in size, are empty, or the queue is full.</returns>
+		bool EvaluateAtRate(std::span<const MicroAmperesType> rates, std::span<AtRatePredictionType> predictions)
+		{
+			if (rates.size() != predictions.size())
+			{
+				return false;
+			}
+
+			for (size_t i = 0; i < rates.size(); i++)
+			{
+				predictions[i].Rate = rates[i];
+			}
+			return EvaluateAtRate(predictions);
+		}
+
+		bool EvaluateAtRateAndWait(std::span<AtRatePredictionType> predictions, WaitFunc waitFunc)
+		{
+			if (!EvaluateAtRate(predictions))
+			{
+				return false;
+			}
+
+			WaitForTransaction(waitFunc);
+			return !HasError();
+		}
+
+		bool WaitForTransaction(WaitFunc waitFunc)
+		{
+			while (IsTransactionInProgress())
+			{
+				waitFunc(std::chrono::milliseconds(1));
+			}
+			return !HasError();
+		}
+
+		/// <summary>
+		/// Blocks until all pending and queued transactions are finished. Woken by the completion callback, no polling.
+		/// Must not be called from the driver's completion thread.
+		/// </summary>
+		/// <returns>True if no transaction failed.</returns>
+		bool WaitForTransaction()
+		{
+			size_t pending = m_PendingCount.load();
+			while (pending != 0)
+			{
+				m_PendingCount.wait(pending);
+				pending = m_PendingCount.load();
+			}
+			return !HasError();
+		}
+
+		/// <summary>
+		/// Single transaction that can be awaited by a coroutine or waited for by a blocking thread.
+		/// The request is queued when awaited or when Wait() is called, not on construction.
+		/// A coroutine is resumed on the driver's completion thread; it may queue further requests but must not block.
+		/// </summary>
+		class Awaiter
+		{
+		public:
+			Awaiter(const Awaiter&) = delete;
+			Awaiter& operator=(const Awaiter&) = delete;
+
+			bool await_ready() const noexcept
+			{
+				return false;
+			}
+
+			bool await_suspend(std::coroutine_handle<> handle)
+			{
+				m_Completion.m_Handle = handle;
+				if (!m_Device.Submit(m_Kind, m_Offset, m_Count, &m_Completion))
+				{
+					m_Completion.m_IsOk = false;
+					return false;
+				}
+				return true;
+			}
+
+			bool await_resume() const noexcept
+			{
+				return m_Completion.m_IsOk;
+			}
+
+			/// <summary>
+			/// Queues the request and blocks until its completion callback fires.
+			/// </summary>
+			/// <returns>True if transaction succeeded.</returns>
+			bool Wait()
+			{
+				if (!m_Device.Submit(m_Kind, m_Offset, m_Count, &m_Completion))
+				{
+					return false;
+				}
+
+				uint32_t epoch = m_Device.m_CompletionEpoch.load();
+				while (!m_Completion.IsDone())
+				{
+					m_Device.m_CompletionEpoch.wait(epoch);
+					epoch = m_Device.m_CompletionEpoch.load();
+				}
+				return m_Completion.m_IsOk;
+			}
+
+		private:
+			friend class Device;
+
+			Device& m_Device;
+			TransactionKind m_Kind;
+			uint8_t m_Offset;
+			size_t m_Count;
+			Completion m_Completion;
+
+			Awaiter(Device& device, TransactionKind kind, uint8_t offset, size_t count) : m_Device(device), m_Kind(kind), m_Offset(offset), m_Count(count)
+			{
+
+			}
+		};
+
+		/// <summary>
+		/// Returns awaitable read of a register range: co_await device.ReadAsync(RegOffset::VCell).
+		/// </summary>
+		Awaiter ReadAsync(RegOffset first, RegOffset last)
+		{
+			size_t count = RegUtils::ToInt(last) >= RegUtils::ToInt(first) ? RegUtils::ToInt(last) - RegUtils::ToInt(first) + 1 : 0;
+			return Awaiter(*this, TransactionKind::Read, RegUtils::ToInt(first), count);
+		}
+
+		Awaiter ReadAsync(RegOffset reg)
+		{
+			return ReadAsync(reg, reg);
+		}
+
+		Awaiter ReadTelemetryAsync()
+		{
+			size_t count = RegUtils::ToInt(TelemetryLast) - RegUtils::ToInt(TelemetryFirst) + 1;
+			return Awaiter(*this, TransactionKind::Telemetry, RegUtils::ToInt(TelemetryFirst), count);
+		}
+
+		Awaiter WriteAsync(RegOffset reg)
+		{
+			return Awaiter(*this, TransactionKind::Write, RegUtils::ToInt(reg), 1);
+		}
+
+		Awaiter WriteDirtyAsync()
+		{
+			return Awaiter(*this, TransactionKind::WriteDirty, 0, 0);
+		}
+
+		/// <summary>
+		/// Initializes MAX1726 in blocking mode. Must be called on every power cycle.
+		/// After power-on reset RSense is written with the rest of EZ config; otherwise it is read back and must match the RSense template parameter.
+		/// </summary>
+		/// <returns>True if initialization was successfull.</returns>
+		bool InitBlocking(WaitFunc waitFunc, MicroAmpereHoursType designCapacity, MicroAmperesType terminationCurrent, MicroVolts emptyVoltage, bool forceReset = false)
+		{
+			bool isPowerOnReset = false;
+			if (!BeginInitBlocking(waitFunc, forceReset, isPowerOnReset))
+			{
+				return false;
+			}
+
+			if (isPowerOnReset)
+			{
+				uint16_t hibCfg = 0;
+				if (!WakeUpBlocking(waitFunc, hibCfg))
+				{
+					return false;
+				}
+
+				// EZ Config
+				SetSenseResistor();
+				SetDesignCapacity(designCapacity);
+				SetTerminationCurrent(terminationCurrent);
+				SetEmptyVoltage(emptyVoltage);
+				SetModelId(ModelId::Li);
+				SetHighChargeVoltage(false);
+				SetModelRefreshFlag(true);
+
+				if (!WriteDirty())
+				{
+					return false;
+				}
+				if (!WaitForTransaction(waitFunc))
+				{
+					return false;
+				}
+
+				while (true)
+				{
+					if (!ReadAndWait(RegOffset::ModelCfg, waitFunc))
+					{
+						return false;
+					}
+
+					if (!IsModelRefreshFlagSet())
+					{
+						break;
+					}
+					waitFunc(std::chrono::milliseconds(10));
+				}
+				
+				SetRegisterValue(RegOffset::HibCfg, hibCfg);
+				if (!WriteAndWait(RegOffset::HibCfg, waitFunc))
+				{
+					return false;
+				}				
+			}
+			else if (!CheckSenseResistorBlocking(waitFunc))
+			{
+				return false;
+			}
+
+			return ClearPowerOnResetBlocking(waitFunc);
+		}
+
+		/// <summary>
+		/// Initializes MAX1726 in blocking mode from a checkpoint of learned parameters. Must be called on every power cycle instead of InitBlocking.
+		/// EZ config and learned registers are written in one WriteDirty sequence without model refresh, so there is no wait for the model to load.
+		/// If the gauge did not lose power, its own learned state is kept and nothing is restored, but RSense must match as in InitBlocking.
+		/// </summary>
+		/// <returns>True if initialization was successfull.</returns>
+		bool RestoreBlocking(WaitFunc waitFunc, const LearnedParametersType& params, MicroAmpereHoursType designCapacity, MicroAmperesType terminationCurrent, MicroVolts emptyVoltage, bool forceReset = false)
+		{
+			bool isPowerOnReset = false;
+			if (!BeginInitBlocking(waitFunc, forceReset, isPowerOnReset))
+			{
+				return false;
+			}
+
+			if (isPowerOnReset)
+			{
+				uint16_t hibCfg = 0;
+				if (!WakeUpBlocking(waitFunc, hibCfg))
+				{
+					return false;
+				}
+
+				SetSenseResistor();
+				SetDesignCapacity(designCapacity);
+				SetTerminationCurrent(terminationCurrent);
+				SetEmptyVoltage(emptyVoltage);
+				SetModelId(ModelId::Li);
+				SetHighChargeVoltage(false);
+				SetModelRefreshFlag(false);
+				SetLearnedParameters(params);
+				SetRegisterValue(RegOffset::HibCfg, hibCfg);
+
+				if (!WriteDirty())
+				{
+					return false;
+				}
+				if (!WaitForTransaction(waitFunc))
+				{
+					return false;
+				}
+			}
+			else if (!CheckSenseResistorBlocking(waitFunc))
+			{
+				return false;
+			}
+
+			return ClearPowerOnResetBlocking(waitFunc);
+		}
+
+		/// <summary>
+		/// Reads all learned parameter registers from the device.
+		/// </summary>
+		/// <returns>True if all reads succeeded.</returns>
+		bool ReadLearnedParametersAndWait(WaitFunc waitFunc)
+		{
+			return ReadAndWait(RegOffset::FullCapRep, RegOffset::QRTable00, waitFunc)
+				&& ReadAndWait(RegOffset::Cycles, waitFunc)
+				&& ReadAndWait(RegOffset::QRTable10, RegOffset::FullCapNom, waitFunc)
+				&& ReadAndWait(RegOffset::QRTable20, waitFunc)
+				&& ReadAndWait(RegOffset::RComp0, RegOffset::TempCo, waitFunc)
+				&& ReadAndWait(RegOffset::QRTable30, RegOffset::dPAcc, waitFunc);
+		}
+
+		/// <summary>
+		/// Returns learned parameters from shadow registers. Call ReadLearnedParametersAndWait first.
+		/// </summary>
+		LearnedParametersType GetLearnedParameters() const
+		{
+			LearnedParametersType params;
+			for (RegOffset reg : CheckpointRegisters)
+			{
+				params.SetRegister(reg, GetRegisterValue(reg));
+			}
+			return params;
+		}
+
+		/// <summary>
+		/// Sets learned parameters in shadow registers and marks them dirty.
+		/// </summary>
+		void SetLearnedParameters(const LearnedParametersType& params)
+		{
+			for (RegOffset reg : CheckpointRegisters)
+			{
+				SetRegisterValue(reg, params.GetRegister(reg));
+			}
+		}
+
+		/// <summary>
+		/// Returns per-register traffic statistics. Only available with an enabled StatsPolicy.
+		/// </summary>
+		const StatsPolicy& GetRegisterStats() const requires StatsPolicy::IsEnabled
+		{
+			return m_Stats;
+		}
+
+		/// <summary>
+		/// Returns shadow register file. Entries carry raw value, valid and dirty flags and last read time.
+		/// </summary>
+		const RegisterFile<Clock>& GetRegisters() const
+		{
+			return m_Registers;
+		}
+
+		bool IsRegisterValid(RegOffset reg) const
+		{
+			return m_Registers[RegUtils::ToInt(reg)].IsValid;
+		}
+
+		/// <summary>
+		/// Sets how long a value read from the device stays fresh, for every register of a volatility class. Static registers never go stale once read.
+		/// </summary>
+		void SetFreshnessTtl(Volatility volatility, typename Clock::duration ttl)
+		{
+			m_FreshnessTtl[RegUtils::ToInt(volatility)] = ttl;
+		}
+
+		typename Clock::duration GetFreshnessTtl(Volatility volatility) const
+		{
+			return m_FreshnessTtl[RegUtils::ToInt(volatility)];
+		}
+
+		/// <summary>
+		/// True if the shadow value can be used without reading the device: it was read within its TTL, it is static and was read once,
+		/// it holds a local change not yet written, or the register cannot be read at all.
+		/// </summary>
+		bool IsFresh(RegOffset reg) const
+		{
+			const auto& entry = m_Registers[RegUtils::ToInt(reg)];
+			if (entry.IsDirty || !ReadableTable[RegUtils::ToInt(reg)])
+			{
+				return true;
+			}
+			if (!entry.IsValid)
+			{
+				return false;
+			}
+
+			Volatility volatility = VolatilityTable[RegUtils::ToInt(reg)];
+			return volatility == Volatility::Static || Clock::now() - entry.LastReadTime < GetFreshnessTtl(volatility);
+		}
+
+		/// <summary>
+		/// Queues a read of the register if it is stale. A register already being refreshed is not queued again.
+		/// </summary>
+		/// <returns>True if the register is fresh or a read of it is pending. False if the queue is full.</returns>
+		bool Refresh(RegOffset reg)
+		{
+			if (IsFresh(reg))
+			{
+				return true;
+			}
+
+			auto& isPending = m_RefreshPending[RegUtils::ToInt(reg)];
+			if (isPending.exchange(true))
+			{
+				return true;
+			}
+			if (!Read(reg))
+			{
+				isPending = false;
+				return false;
+			}
+			return true;
+		}
+
+		/// <summary>
+		/// Reads the register if it is stale and waits for that read only. Other requests sharing the device neither hold it up nor fail it.
+		/// </summary>
+		/// <returns>True if the shadow value is fresh. False if the queue is full or the read failed.</returns>
+		bool RefreshAndWait(RegOffset reg, WaitFunc waitFunc)
+		{
+			if (IsFresh(reg))
+			{
+				return true;
+			}
+
+			Completion completion;
+			if (!Read(reg, completion))
+			{
+				return false;
+			}
+			while (!completion.IsDone())
+			{
+				waitFunc(std::chrono::milliseconds(1));
+			}
+			return completion.IsOk();
+		}
+
+		/// <summary>
+		/// Returns field value, reading the register first and waiting for it if the shadow copy is stale.
+		/// </summary>
+		/// <typeparam name="F">Field descriptor, see Fields</typeparam>
+		/// <returns>Field value, or std::nullopt if the register could not be refreshed.</returns>
+		template<typename F>
+		std::optional<typename F::ValueType> GetFresh(WaitFunc waitFunc)
+		{
+			if (!RefreshAndWait(F::Register, waitFunc))
+			{
+				return std::nullopt;
+			}
+			return Get<F>();
+		}
+
+		/// <summary>
+		/// Read-through access: returns the shadow value now and queues a read of the register if it is stale, see Refresh().
+		/// The refreshed value is there once the read completes. Use GetFresh() to wait for it.
+		/// Not for completion callbacks or code that must not touch the bus; use Get() there.
+		/// </summary>
+		/// <typeparam name="F">Field descriptor, see Fields</typeparam>
+		template<typename F>
+		typename F::ValueType GetOrRefresh()
+		{
+			Refresh(F::Register);
+			return Get<F>();
+		}
+
+		typename Clock::time_point GetRegisterReadTime(RegOffset reg) const
+		{
+			return m_Registers[RegUtils::ToInt(reg)].LastReadTime;
+		}
+
+		uint16_t GetRegisterValue(RegOffset reg) const
+		{
+			return m_Registers.GetValue(RegUtils::ToInt(reg));
+		}
+
+		/// <summary>
+		/// Sets raw register value and marks it dirty.
+		/// </summary>
+		void SetRegisterValue(RegOffset reg, uint16_t value)
+		{
+			m_Registers.SetValue(RegUtils::ToInt(reg), value);
+		}
+
+		/// <summary>
+		/// Returns field value from shadow registers. Never touches the bus, see GetOrRefresh() for read-through access.
+		/// </summary>
+		/// <typeparam name="F">Field descriptor, see Fields</typeparam>
+		template<typename F>
+		typename F::ValueType Get() const
+		{
+			return F::CodecType::Decode(ReadField<typename F::RawType>(F::Register, F::Offset, F::Length));
+		}
+
+		/// <summary>
+		/// Sets field value in shadow registers and marks the register dirty.
+		/// </summary>
+		/// <typeparam name="F">Field descriptor, see Fields</typeparam>
+		template<typename F>
+		void Set(typename F::ValueType value)
+		{
+			static_assert(F::IsWritable, "Field is in a read-only register");
+			WriteField<typename F::RawType>(F::Register, F::CodecType::Encode(value), F::Offset, F::Length);
+		}
+
+		Status GetStatus() const
+		{
+			return Get<Fields::Status>();
+		}
+
+		void SetStatus(Status value)
+		{
+			Set<Fields::Status>(value);
+		}
+
+		FStat GetFStat() const
+		{
+			return Get<Fields::FStat>();
+		}
+
+		uint8_t GetHibScalar() const
+		{
+			return Get<Fields::HibScalar>();
+		}
+
+		/// <summary>
+		/// Sets the task period while in hibernate mode based on the following equation: Task Period = 351ms * 2^HibScalar
+		/// </summary>
+		/// <param name="value"></param>
+		void SetHibScalar(uint8_t value)
+		{
+			Set<Fields::HibScalar>(value);
+		}
+
+		uint8_t GetHibExitTime() const
+		{
+			return Get<Fields::HibExitTime>();
+		}
+
+		// Sets the required time period of consecutive current readings above the HibThreshold value before the IC exits hibernate and returns to active mode of operation
+		
+		/// <summary>
+		/// Sets the required time period of consecutive current readings above the HibThreshold value before the IC exits hibernate and returns to active mode of operation:
+		/// Exit Time = (HibExitTime + 1) * 702ms * 2^HibScalar
+		/// </summary>
+		/// <param name="value"></param>
+		void SetHibExitTime(uint8_t value)
+		{
+			Set<Fields::HibExitTime>(value);
+		}
+
+		uint8_t GetHibThreshold() const
+		{
+			return Get<Fields::HibThreshold>();
+		}
+
+		void SetHibThreshold(uint8_t value)
+		{
+			Set<Fields::HibThreshold>(value);
+		}
+
+		uint8_t GetHibEnterTime() const
+		{
+			return Get<Fields::HibEnterTime>();
+		}
+
+		void SetHibEnterTime(uint8_t value)
+		{
+			Set<Fields::HibEnterTime>(value);
+		}
+
+		bool IsHibernationEnabled() const
+		{
+			return Get<Fields::HibernationEnabled>();
+		}
+
+		void SetHibernationEnabled(bool value)
+		{
+			Set<Fields::HibernationEnabled>(value);
+		}
+
+		void SetCommand(Command command)
+		{
+			Set<Fields::Command>(command);
+		}
+
+		Command GetCommand()
+		{
+			return Get<Fields::Command>();
+		}
+
+		/// <summary>
+		/// Sets the RSense register to the RSense template parameter.
+		/// </summary>
+		void SetSenseResistor()
+		{
+			Set<Fields::RSense>(RSenseRegisterValue);
+		}
+
+		/// <summary>
+		/// Compares the RSense register with the RSense template parameter. Read RSense first.
+		/// </summary>
+		/// <returns>False if the gauge was configured for a different sense resistor, so current and capacity would be scaled wrongly.</returns>
+		bool IsSenseResistorMatching() const
+		{
+			return Get<Fields::RSense>() == RSenseRegisterValue;
+		}
+
+		/// <summary>
+		/// Scaled for the RSense template parameter.
+		/// </summary>
+		/// <param name="valueMah">Battery capacity in mAh</param>
+		void SetDesignCapacity(MicroAmpereHoursType valueMah)
+		{
+			Set<typename SenseFieldsType::DesignCap>(valueMah);
+		}
+
+		/// <summary>
+		/// Scaled for the RSense template parameter.
+		/// </summary>
+		/// <returns>Battery capacity in mAh</returns>
+		MicroAmpereHoursType GetDesignCapacity() const
+		{
+			return Get<typename SenseFieldsType::DesignCap>();
+		}
+
+		/// <summary>
+		/// Scaled for the RSense template parameter.
+		/// </summary>
+		/// <param name="valueMah">Battery capacity in mAh</param>
+		void SetTerminationCurrent(MicroAmperesType valueMa)
+		{
+			Set<typename SenseFieldsType::IChgTerm>(valueMa);
+		}
+
+		/// <summary>
+		/// Scaled for the RSense template parameter.
+		/// </summary>
+		/// <returns>Battery capacity in mAh</returns>
+		MicroAmperesType GetTerminationCurrent() const
+		{
+			return Get<typename SenseFieldsType::IChgTerm>();
+		}
+
+		void SetEmptyVoltage(MicroVolts valueUv)
+		{
+			Set<Fields::VEmpty>(valueUv);
+		}
+
+		MicroVolts GetEmptyVoltage() const
+		{
+			return Get<Fields::VEmpty>();
+		}
+
+		void SetRecoveryVoltage(MicroVolts valueUv)
+		{
+			Set<Fields::VRecovery>(valueUv);
+		}
+
+		MicroVolts GetRecoveryVoltage() const
+		{
+			return Get<Fields::VRecovery>();
+		}
+
+		ModelId GetModelId() const
+		{
+			return Get<Fields::ModelId>();
+		}
+
+		void SetModelId(ModelId value)
+		{
+			Set<Fields::ModelId>(value);
+		}
+
+		bool IsHighChargeVoltage() const
+		{
+			return Get<Fields::HighChargeVoltage>();
+		}
+
+		void SetHighChargeVoltage(bool value)
+		{
+			Set<Fields::HighChargeVoltage>(value);
+		}
+
+		bool IsModelRefreshFlagSet() const
+		{
+			return Get<Fields::ModelRefresh>();
+		}
+
+		void SetModelRefreshFlag(bool value)
+		{
+			Set<Fields::ModelRefresh>(value);
+		}
+
+		MicroAmpereHoursType GetRemainingCapacity() const
+		{
+			return Get<typename SenseFieldsType::RepCap>();
+		}
+
+		MicroAmpereHoursType GetEstimatedFullCapacity() const
+		{
+			return Get<typename SenseFieldsType::FullCapRep>();
+		}
+
+		void SetEstimatedFullCapacity(MicroAmpereHoursType valueuAh)
+		{
+			Set<typename SenseFieldsType::FullCapRep>(valueuAh);
+		}
+
+		MicroAmpereHoursType GetNominalFullCapacity() const
+		{
+			return Get<typename SenseFieldsType::FullCapNom>();
+		}
+
+		void SetNominalFullCapacity(MicroAmpereHoursType cap)
+		{
+			Set<typename SenseFieldsType::FullCapNom>(cap);
+		}
+
+		uint16_t GetRemainingSoc() const
+		{
+			return Get<Fields::RepSOC>();
+		}
+
+		MicroAmperesType GetCurrent() const
+		{
+			return Get<typename SenseFieldsType::Current>();
+		}
+
+		MicroAmperesType GetAverageCurrent() const
+		{
+			return Get<typename SenseFieldsType::AvgCurrent>();
+		}
+
+		/// <summary>
+		/// Instant VCell * Current computed by the gauge.
+		/// </summary>
+		MicroWattsType GetPower() const
+		{
+			return Get<typename SenseFieldsType::Power>();
+		}
+
+		/// <summary>
+		/// Filtered power, same time constant as AvgCurrent.
+		/// </summary>
+		MicroWattsType GetAveragePower() const
+		{
+			return Get<typename SenseFieldsType::AvgPower>();
+		}
+
+		/// <summary>
+		/// Raw QH coulomb counter. Wraps; take differences between reads as int16_t.
+		/// </summary>
+		uint16_t GetCoulombCounter() const
+		{
+			return Get<Fields::QH>();
+		}
+
+		MilliCelsius GetTemperature() const
+		{
+			return Get<Fields::Temp>();
+		}
+
+		uint16_t GetTimeToEmpty() const
+		{
+			return Get<Fields::TTE>();
+		}
+
+		uint16_t GetTimeToFull() const
+		{
+			return Get<Fields::TTF>();
+		}
+
+		uint16_t GetCycles() const
+		{
+			return Get<Fields::Cycles>();
+		}
+
+		void SetCycles(uint16_t value)
+		{
+			Set<Fields::Cycles>(value);
+		}
+
+		uint16_t GetRcomp0() const
+		{
+			return Get<Fields::RComp0>();
+		}
+
+		void SetRcomp0(uint16_t value)
+		{
+			Set<Fields::RComp0>(value);
+		}
+
+		uint16_t GetTempCo() const
+		{
+			return Get<Fields::TempCo>();
+		}
+
+		void SetTempCo(uint16_t value)
+		{
+			Set<Fields::TempCo>(value);
+		}
+
+		/// <summary>
+		/// Returns QRTable register. Index 0 to 3 selects QRTable00, QRTable10, QRTable20 or QRTable30.
+		/// </summary>
+		uint16_t GetQRTable(size_t index) const
+		{
+			return ReadField<uint16_t>(GetQRTableOffset(index), 0, 16);
+		}
+
+		void SetQRTable(size_t index, uint16_t value)
+		{
+			WriteField<uint16_t>(GetQRTableOffset(index), value, 0, 16);
+		}
+
+		uint16_t GetDQAcc() const
+		{
+			return Get<Fields::dQAcc>();
+		}
+
+		void SetDQAcc(uint16_t value)
+		{
+			Set<Fields::dQAcc>(value);
+		}
+
+		uint16_t GetDPAcc() const
+		{
+			return Get<Fields::dPAcc>();
+		}
+
+		void SetDPAcc(uint16_t value)
+		{
+			Set<Fields::dPAcc>(value);
+		}
+
+		MicroVolts GetVCell() const
+		{
+			return Get<Fields::VCell>();
+		}
+
+		ConfigFlags GetConfig() const
+		{
+			return Get<Fields::Config>();
+		}
+
+		void SetConfig(ConfigFlags value)
+		{
+			Set<Fields::Config>(value);
+		}
+
+		/// <summary>
+		/// Sets VAlrtTh. Status.Vmn or Status.Vmx is raised when VCell leaves [min, max]. 20 mV resolution, 0 to 5.1 V.
+		/// </summary>
+		void SetVoltageAlertThresholds(MicroVolts min, MicroVolts max)
+		{
+			Set<Fields::VoltageAlertMin>(min);
+			Set<Fields::VoltageAlertMax>(max);
+		}
 
-	enum class FStat : uint16_t
-	{
-		DataNotReady = (1 << 0),
-		RelaxedCellDetectionLong = (1 << 6),
-		FullQualified = (1 << 7),
-		EmptyDetection = (1 << 8),
-		RelaxedCellDetectionShort = (1 << 9)
-	};
+		MicroVolts GetVoltageAlertMin() const
+		{
+			return Get<Fields::VoltageAlertMin>();
+		}
 
-	enum class Command : uint16_t
-	{
-		Clear = 0,
-		Reset = 0x0F,
-		SoftWakeup = 0x0090
-	};
+		MicroVolts GetVoltageAlertMax() const
+		{
+			return Get<Fields::VoltageAlertMax>();
+		}
 
-	enum class ModelId : uint8_t
-	{
-		Li = 0,
-		NcrOrNca = 2,
-		LiFePo = 6
-	};
+		/// <summary>
+		/// Sets TAlrtTh. Status.Tmn or Status.Tmx is raised when Temp leaves [min, max]. 1 degree resolution, -128 to 127 degrees.
+		/// </summary>
+		void SetTemperatureAlertThresholds(MilliCelsius min, MilliCelsius max)
+		{
+			Set<Fields::TemperatureAlertMin>(min);
+			Set<Fields::TemperatureAlertMax>(max);
+		}
 
-	enum class ConfigFlags : uint16_t
-	{
-		BatteryRemoved = (1 << 0),
-		BatteryInserted = (1 << 1),
-		AlertEnable = (1 << 2),
-		ForceThermistorBias = (1 << 3),
-		EnableThermistor = (1 << 4),
-		CommShutdown = (1 << 6),
-		Shutdown = (1 << 7),
-		TemperatureExternal = (1 << 8),
-		EnableTemperatureChannel = (1 << 9),
-		ThPinShutdown = (1 << 10),
-		CurrentAlertSticky = (1 << 11),
-		VoltageAlertSticky = (1 << 12),
-		TemperatureAlertSticky = (1 << 13),
-		SocAlertSticky = (1 << 14),
-		TSel = (1 << 15)
-	};
+		MilliCelsius GetTemperatureAlertMin() const
+		{
+			return Get<Fields::TemperatureAlertMin>();
+		}
 
-	constexpr static size_t MemorySize = 225;
+		MilliCelsius GetTemperatureAlertMax() const
+		{
+			return Get<Fields::TemperatureAlertMax>();
+		}
 
-	template<PiSubmarine::Api::Internal::I2C::DriverConcept I2CDriver>
-	class Device
-	{
-	public:
-		constexpr static uint8_t Address = 0x36;
+		/// <summary>
+		/// Sets SAlrtTh. Status.Smn or Status.Smx is raised when RepSOC leaves [min, max]. 1 % resolution.
+		/// </summary>
+		void SetSocAlertThresholds(uint8_t minPercent, uint8_t maxPercent)
+		{
+			Set<Fields::SocAlertMin>(minPercent);
+			Set<Fields::SocAlertMax>(maxPercent);
+		}
 
-		Device(I2CDriver& driver) : m_Driver(driver)
+		uint8_t GetSocAlertMin() const
 		{
+			return Get<Fields::SocAlertMin>();
+		}
 
+		uint8_t GetSocAlertMax() const
+		{
+			return Get<Fields::SocAlertMax>();
 		}
 
 		/// <summary>
-		/// Returns true if there is a pending read/write I2C transation.
+		/// Sets IAlrtTh. Status.Imn or Status.Imx is raised when Current leaves [min, max]. 400 uV / RSense resolution.
 		/// </summary>
-		/// <returns>True if transaction not finished.</returns>
-		bool IsTransactionInProgress()
+		void SetCurrentAlertThresholds(MicroAmperesType min, MicroAmperesType max)
+		{
+			Set<typename SenseFieldsType::CurrentAlertMin>(min);
+			Set<typename SenseFieldsType::CurrentAlertMax>(max);
+		}
+
+		MicroAmperesType GetCurrentAlertMin() const
+		{
+			return Get<typename SenseFieldsType::CurrentAlertMin>();
+		}
+
+		MicroAmperesType GetCurrentAlertMax() const
 		{
-			return m_IsTransactionInProgress;
+			return Get<typename SenseFieldsType::CurrentAlertMax>();
 		}
 
 		/// <summary>
-		/// Returns true if previous transaction failed. Cleared to false upon new Read or Write.
+		/// Restores all threshold registers to their disabled reset values.
 		/// </summary>
-		/// <returns>True if has error.</returns>
-		bool HasError()
+		void DisableAlertThresholds()
 		{
-			return m_HasError;
+			for (RegOffset reg : { RegOffset::VAlrtTh, RegOffset::TAlrtTh, RegOffset::SAlrtTh, RegOffset::IAlrtTh })
+			{
+				SetRegisterValue(reg, FindRegister(reg)->ResetValue);
+			}
 		}
 
 		/// <summary>
-		/// Reads specific register.
+		/// Enables ALRT pin output on threshold violations (Config.Aen).
 		/// </summary>
-		/// <param name="reg">Register offset</param>
-		/// <returns>True if transaction was successfully started.</returns>
-		bool Read(RegOffset reg)
+		void SetAlertEnabled(bool value)
 		{
-			std::bitset<MemorySize> regs;
-			regs.set(RegUtils::ToInt(reg));
-			constexpr size_t regSize = 2;
-			return Read(static_cast<uint8_t>(reg), m_MemoryBuffer.data() + static_cast<size_t>(reg), regSize, regs);
+			Set<Fields::AlertEnable>(value);
 		}
 
-		bool ReadAndWait(RegOffset reg, WaitFunc waitFunc)
+		bool IsAlertEnabled() const
 		{
-			if (!Read(reg))
-			{
-				return false;
-			}
-
-			WaitForTransaction(waitFunc);
-			return !HasError();
+			return Get<Fields::AlertEnable>();
 		}
 
 		/// <summary>
-		/// Writes specific register.
+		/// Makes alert Status flags sticky, so they stay set until the host clears them (Config.Is, Vs, Ts, Ss).
 		/// </summary>
-		/// <param name="reg">Register offset</param>
-		/// <returns>True if transaction was successfully started.</returns>
-		bool Write(RegOffset reg)
+		void SetAlertSticky(bool value)
 		{
-			constexpr size_t regSize = 2;
-			std::bitset<MemorySize> regs;
-			regs.set(RegUtils::ToInt(reg));
-			return Write(static_cast<uint8_t>(reg), m_MemoryBuffer.data() + static_cast<size_t>(reg), regSize, regs);
+			Set<Fields::AlertSticky>(value ? 0x0F : 0);
 		}
 
-		bool WriteAndWait(RegOffset reg, WaitFunc waitFunc)
+		bool IsAlertSticky() const
 		{
-			if (!Write(reg))
-			{
-				return false;
-			}
-
-			WaitForTransaction(waitFunc);
-			return !HasError();
+			return Get<Fields::AlertSticky>() == 0x0F;
 		}
 
 		/// <summary>
-		/// Writes all dirty registers in a sequence of transactions.
+		/// Raises ALRT and Status.dSOCi on every integer percent change of RepSOC (Config2.dSOCen).
 		/// </summary>
-		/// <returns>True if transaction was successfully started. False if there was an error or no register was dirty.</returns>
-		bool WriteDirty()
+		void SetSocChangeAlertEnabled(bool value)
+		{
+			Set<Fields::SocChangeAlertEnable>(value);
+		}
+
+		bool IsSocChangeAlertEnabled() const
 		{
-			if (m_IsTransactionInProgress)
+			return Get<Fields::SocChangeAlertEnable>();
+		}
+
+	private:
+		/// <summary>
+		/// Queued request and completion context of the transaction in flight. Kept inside Device so driver callbacks only capture 'this'.
+		/// </summary>
+		struct Transaction
+		{
+			TransactionKind Kind = TransactionKind::None;
+			uint8_t Offset = 0;
+			uint16_t Count = 0;
+			typename Clock::time_point EnqueueTime{};
+			Completion* Waiter = nullptr;
+
+			/// <summary>
+			/// AtRate candidates not evaluated yet, starting with the one in flight.
+			/// </summary>
+			AtRatePredictionType* Predictions = nullptr;
+			uint16_t PredictionCount = 0;
+
+			/// <summary>
+			/// Failed attempts of the bus transaction in flight.
+			/// </summary>
+			uint8_t Attempt = 0;
+
+			/// <summary>
+			/// Later step of a request already dispatched once, put back in the queue to let others through. Not counted again in QueueStats.
+			/// </summary>
+			bool IsContinuation = false;
+		};
+
+		constexpr static std::array<Volatility, RegisterCount> VolatilityTable = []() {
+			std::array<Volatility, RegisterCount> table{};
+			for (const auto& descriptor : RegisterTable)
 			{
-				return false;
+				table[RegUtils::ToInt(descriptor.Offset)] = GetVolatility(descriptor.Offset);
 			}
+			return table;
+			}();
+
+		constexpr static std::array<bool, RegisterCount> ReadableTable = []() {
+			std::array<bool, RegisterCount> table{};
+			for (size_t i = 0; i < RegisterCount; i++)
+			{
+				auto reg = static_cast<RegOffset>(i);
+				table[i] = !IsRegisterDefined(reg) || HasRegisterAccess(reg, RegisterAccess::Read);
+			}
+			return table;
+			}();
+
+		constexpr static std::array<uint16_t, RegisterCount> VerifyMaskTable = []() {
+			std::array<uint16_t, RegisterCount> table{};
+			for (const auto& descriptor : RegisterTable)
+			{
+				table[RegUtils::ToInt(descriptor.Offset)] = GetVerifyMask(descriptor.Offset);
+			}
+			return table;
+			}();
+
+		/// <summary>
+		/// Unwritten registers WriteDirtyAndVerify reads through rather than split a read-back. Each costs 2 bytes; a new burst costs the offset write and a repeated address.
+		/// </summary>
+		constexpr static size_t VerifyGapLimit = 2;
+
+		I2CDriver& m_Driver;
+		RegisterFile<Clock> m_Registers;
+		std::array<uint8_t, MemorySize> m_RxBuffer{ 0 };
+		std::array<uint8_t, MemorySize + 1> m_TxBuffer{ 0 };
+		Transaction m_Transaction;
+		BoundedQueue<Transaction, QueueCapacity> m_Queue;
+		std::atomic<bool> m_IsBusOwned = false;
+		std::atomic<size_t> m_PendingCount = 0;
+		std::atomic<bool> m_HasError = false;
+		size_t m_WriteDirtyTransactionCount = 0;
+		SeqLock<TelemetrySnapshotType> m_Telemetry;
+		uint64_t m_TelemetrySequence = 0;
+		std::atomic<size_t> m_MaxQueueDepth = 0;
+		std::atomic<uint64_t> m_DispatchedCount = 0;
+		std::atomic<uint64_t> m_RejectedCount = 0;
+		[[no_unique_address]] StatsPolicy m_Stats;
+		std::atomic<typename Clock::rep> m_TotalWaitTicks = 0;
+		std::atomic<typename Clock::rep> m_MaxWaitTicks = 0;
+		std::atomic<uint32_t> m_CompletionEpoch = 0;
+		std::array<typename Clock::duration, VolatilityCount> m_FreshnessTtl{
+			typename Clock::duration{},
+			std::chrono::duration_cast<typename Clock::duration>(ActiveTaskPeriod),
+			std::chrono::duration_cast<typename Clock::duration>(std::chrono::minutes(1)) };
+		std::array<std::atomic<bool>, RegisterCount> m_RefreshPending{};
+
+		/// <summary>
+		/// Registers written by WriteDirtyAndVerify and not read back yet. The written image is the shadow value, which the read-back does not overwrite.
+		/// </summary>
+		std::array<bool, RegisterCount> m_VerifyPending{};
+		size_t m_VerifyRewrites = 0;
+		size_t m_VerifyRoundMismatchCount = 0;
+		size_t m_VerifyMismatchCount = 0;
+		RetryPolicy m_RetryPolicy;
+		std::function<void()> m_BusRecovery;
+		ScheduleFunc m_Scheduler;
+		std::chrono::microseconds m_AtRateSettleTime = ActiveTaskPeriod;
+
+		/// <summary>
+		/// Set while an AtRate batch is queued or running, so batches cannot overwrite each other's AtRate value.
+		/// </summary>
+		std::atomic<bool> m_IsAtRateRunning = false;
 
-			m_HasError = false;
-			m_IsTransactionInProgress = true;
+		/// <summary>
+		/// Result read of the candidate whose settle time expired, waiting for the bus. Dispatched ahead of the queue.
+		/// </summary>
+		Transaction m_AtRateContinuation{};
+		std::atomic<bool> m_IsAtRateSettled = false;
+		size_t m_ConsecutiveFailures = 0;
+		typename Clock::time_point m_FailureStreakStart{};
+		std::atomic<uint64_t> m_RetryCount = 0;
+		std::atomic<uint64_t> m_ExhaustedCount = 0;
+		std::atomic<uint64_t> m_BusRecoveryCount = 0;
+		std::atomic<uint64_t> m_RecoveredCount = 0;
+		std::atomic<typename Clock::rep> m_TotalRecoveryTicks = 0;
+		std::atomic<typename Clock::rep> m_MaxRecoveryTicks = 0;
 
-			return WriteDirtyInternal(RegOffset{ 0 });
+		template<typename T>
+		T ReadField(RegOffset reg, size_t bitOffset, size_t bitLength) const
+		{
+			return m_Registers.template ReadField<T>(RegUtils::ToInt(reg), bitOffset, bitLength);
 		}
 
-		bool HasDirtyRegisters()
+		template<typename T>
+		void WriteField(RegOffset reg, T value, size_t bitOffset, size_t bitLength)
 		{
-			return m_DirtyRegs.any();
+			m_Registers.template WriteField<T>(RegUtils::ToInt(reg), value, bitOffset, bitLength);
 		}
 
-		bool WaitForTransaction(WaitFunc waitFunc)
+		static RegOffset GetQRTableOffset(size_t index)
 		{
-			while (IsTransactionInProgress())
-			{
-				waitFunc(std::chrono::milliseconds(1));
-			}
-			return !HasError();
+			return static_cast<RegOffset>(RegUtils::ToInt(RegOffset::QRTable00) + index * (RegUtils::ToInt(RegOffset::QRTable10) - RegUtils::ToInt(RegOffset::QRTable00)));
 		}
 
 		/// <summary>
-		/// Initializes MAX1726 in blocking mode. Must be called on every power cycle.
+		/// Optionally resets the gauge and reads Status.
 		/// </summary>
-		/// <returns>True if initialization was successfull.</returns>
-		bool InitBlocking(WaitFunc waitFunc, MicroAmpereHours designCapacity, MicroAmperes terminationCurrent, MicroVolts emptyVoltage, bool forceReset = false)
+		bool BeginInitBlocking(WaitFunc waitFunc, bool forceReset, bool& isPowerOnReset)
 		{
-
 			if (forceReset)
 			{
 				SetCommand(Command::Reset);
@@ -293,8 +1687,8 @@ namespace PiSubmarine::Max1726
 					return false;
 				}
 				waitFunc(std::chrono::milliseconds(500));
-				RegUtils::Write<uint16_t>(0x01, m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::Config2), 0, 16);
-				if (!WriteAndWait(RegOffset::Command, waitFunc))
+				SetRegisterValue(RegOffset::Config2, 0x01);
+				if (!WriteAndWait(RegOffset::Config2, waitFunc))
 				{
 					return false;
 				}
@@ -306,81 +1700,57 @@ namespace PiSubmarine::Max1726
 				return false;
 			}
 
-			auto status = GetStatus();
+			isPowerOnReset = RegUtils::HasAllFlags(GetStatus(), Status::PowerOnReset);
+			return true;
+		}
 
-			if (RegUtils::HasAllFlags(status, Status::PowerOnReset))
+		/// <summary>
+		/// Waits until data is ready, saves HibCfg and leaves hibernate so configuration can be written.
+		/// </summary>
+		bool WakeUpBlocking(WaitFunc waitFunc, uint16_t& hibCfg)
+		{
+			while (true)
 			{
-				while (true)
-				{
-					if (!ReadAndWait(RegOffset::FStat, waitFunc))
-					{
-						return false;
-					}
-
-					auto fstat = GetFStat();
-					bool dnr = RegUtils::HasAllFlags(fstat, FStat::DataNotReady);
-					if (!dnr)
-					{
-						break;
-					}
-					waitFunc(std::chrono::milliseconds(10));
-				}
-
-				uint16_t hibCfg = RegUtils::Read<uint16_t, std::endian::little>(m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::HibCfg), 0, 16);
-				SetCommand(Command::SoftWakeup);
-				if (!WriteAndWait(RegOffset::Command, waitFunc))
-				{
-					return false;
-				}
-				RegUtils::Write<uint16_t, std::endian::little>(0, m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::HibCfg), 0, 16);
-				if (!WriteAndWait(RegOffset::Command, waitFunc))
-				{
-					return false;
-				}
-				SetCommand(Command::Clear);
-				if (!WriteAndWait(RegOffset::Command, waitFunc))
+				if (!ReadAndWait(RegOffset::FStat, waitFunc))
 				{
 					return false;
 				}
 
-				// EZ Config
-				SetDesignCapacity(designCapacity);
-				SetTerminationCurrent(terminationCurrent);
-				SetEmptyVoltage(emptyVoltage);
-				SetModelId(ModelId::Li);
-				SetHighChargeVoltage(false);
-				SetModelRefreshFlag(true);
-
-				if (!WriteDirty())
-				{
-					return false;
-				}
-				if (!WaitForTransaction(waitFunc))
+				auto fstat = GetFStat();
+				bool dnr = RegUtils::HasAllFlags(fstat, FStat::DataNotReady);
+				if (!dnr)
 				{
-					return false;
+					break;
 				}
+				waitFunc(std::chrono::milliseconds(10));
+			}
 
-				while (true)
-				{
-					if (!ReadAndWait(RegOffset::ModelCfg, waitFunc))
-					{
-						return false;
-					}
-
-					if (!IsModelRefreshFlagSet())
-					{
-						break;
-					}
-					waitFunc(std::chrono::milliseconds(10));
-				}
-				
-				RegUtils::Write<uint16_t, std::endian::little>(hibCfg, m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::HibCfg), 0, 16);
-				if (!WriteAndWait(RegOffset::HibCfg, waitFunc))
-				{
-					return false;
-				}				
+			if (!ReadAndWait(RegOffset::HibCfg, waitFunc))
+			{
+				return false;
+			}
+			hibCfg = GetRegisterValue(RegOffset::HibCfg);
+			SetCommand(Command::SoftWakeup);
+			if (!WriteAndWait(RegOffset::Command, waitFunc))
+			{
+				return false;
+			}
+			SetRegisterValue(RegOffset::HibCfg, 0);
+			if (!WriteAndWait(RegOffset::HibCfg, waitFunc))
+			{
+				return false;
 			}
+			SetCommand(Command::Clear);
+			return WriteAndWait(RegOffset::Command, waitFunc);
+		}
+
+		bool CheckSenseResistorBlocking(WaitFunc waitFunc)
+		{
+			return ReadAndWait(RegOffset::RSense, waitFunc) && IsSenseResistorMatching();
+		}
 
+		bool ClearPowerOnResetBlocking(WaitFunc waitFunc)
+		{
 			while (true)
 			{
 				if (!Read(RegOffset::Status))
@@ -408,425 +1778,732 @@ namespace PiSubmarine::Max1726
 			return true;
 		}
 
-		Status GetStatus() const
-		{
-			return RegUtils::Read<Status, std::endian::little>(m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::Status), 0, 16);
-		}
-
-		void SetStatus(Status value)
-		{
-			RegUtils::Write<Status, std::endian::little>(value, m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::Status), 0, 16);
-			m_DirtyRegs[RegUtils::ToInt(RegOffset::Status)] = true;
-		}
-
-		FStat GetFStat() const
+		bool SubmitRead(RegOffset first, RegOffset last, Completion* waiter)
 		{
-			return RegUtils::Read<FStat, std::endian::little>(m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::FStat), 0, 16);
-		}
+			if (RegUtils::ToInt(first) > RegUtils::ToInt(last))
+			{
+				return false;
+			}
 
-		uint8_t GetHibScalar() const
-		{
-			return RegUtils::Read<uint8_t, std::endian::little>(m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::HibCfg), 0, 3);
+			size_t count = RegUtils::ToInt(last) - RegUtils::ToInt(first) + 1;
+			return Submit(TransactionKind::Read, RegUtils::ToInt(first), count, waiter);
 		}
 
 		/// <summary>
-		/// Sets the task period while in hibernate mode based on the following equation: Task Period = 351ms * 2^HibScalar
+		/// Queues request and starts it right away if the bus is free. Callable from any thread.
 		/// </summary>
-		/// <param name="value"></param>
-		void SetHibScalar(uint8_t value)
+		bool Submit(TransactionKind kind, uint8_t offset, size_t count, Completion* waiter = nullptr)
 		{
-			RegUtils::Write<uint8_t, std::endian::little>(value, m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::HibCfg), 0, 3);
-			m_DirtyRegs[RegUtils::ToInt(RegOffset::HibCfg)] = true;
-		}
+			if (count == 0 && kind != TransactionKind::WriteDirty && kind != TransactionKind::WriteDirtyVerify)
+			{
+				return false;
+			}
 
-		uint8_t GetHibExitTime() const
-		{
-			return RegUtils::Read<uint8_t, std::endian::little>(m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::HibCfg), 0, 3);
+			return Submit(Transaction{ kind, offset, static_cast<uint16_t>(count), {}, waiter });
 		}
 
-		// Sets the required time period of consecutive current readings above the HibThreshold value before the IC exits hibernate and returns to active mode of operation
-		
-		/// <summary>
-		/// Sets the required time period of consecutive current readings above the HibThreshold value before the IC exits hibernate and returns to active mode of operation:
-		/// Exit Time = (HibExitTime + 1) * 702ms * 2^HibScalar
-		/// </summary>
-		/// <param name="value"></param>
-		void SetHibExitTime(uint8_t value)
+		bool Submit(Transaction transaction)
 		{
-			RegUtils::Write<uint8_t, std::endian::little>(value, m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::HibCfg), 3, 2);
-			m_DirtyRegs[RegUtils::ToInt(RegOffset::HibCfg)] = true;
-		}
+			if (transaction.Waiter != nullptr)
+			{
+				transaction.Waiter->m_IsOk = false;
+				transaction.Waiter->m_IsDone.store(false, std::memory_order_relaxed);
+			}
 
-		uint8_t GetHibThreshold() const
-		{
-			return RegUtils::Read<uint8_t, std::endian::little>(m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::HibCfg), 8, 4);
-		}
+			if (m_PendingCount.fetch_add(1) == 0)
+			{
+				m_HasError = false;
+			}
 
-		void SetHibThreshold(uint8_t value)
-		{
-			RegUtils::Write<uint8_t, std::endian::little>(value, m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::HibCfg), 8, 4);
-			m_DirtyRegs[RegUtils::ToInt(RegOffset::HibCfg)] = true;
-		}
+			transaction.EnqueueTime = Clock::now();
+			if (!m_Queue.TryPush(transaction))
+			{
+				m_PendingCount--;
+				m_PendingCount.notify_all();
+				m_RejectedCount++;
+				return false;
+			}
 
-		uint8_t GetHibEnterTime() const
-		{
-			return RegUtils::Read<uint8_t, std::endian::little>(m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::HibCfg), 12, 3);
-		}
+			// Pairs with the fence in ReleaseBus: either this thread sees the bus released, or the releasing owner sees this request
+			std::atomic_thread_fence(std::memory_order_seq_cst);
 
-		void SetHibEnterTime(uint8_t value)
-		{
-			RegUtils::Write<uint8_t, std::endian::little>(value, m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::HibCfg), 12, 3);
-			m_DirtyRegs[RegUtils::ToInt(RegOffset::HibCfg)] = true;
-		}
+			size_t depth = m_Queue.GetSize();
+			size_t maxDepth = m_MaxQueueDepth;
+			while (depth > maxDepth && !m_MaxQueueDepth.compare_exchange_weak(maxDepth, depth))
+			{
+			}
 
-		bool IsHibernationEnabled() const
-		{
-			return RegUtils::Read<uint8_t, std::endian::little>(m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::HibCfg), 15, 1);
+			Dispatch();
+			return true;
 		}
 
-		void SetHibernationEnabled(bool value)
+		/// <summary>
+		/// Takes bus ownership if free and starts the next queued transaction.
+		/// </summary>
+		void Dispatch()
 		{
-			RegUtils::Write<uint8_t, std::endian::little>(value, m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::HibCfg), 15, 1);
-			m_DirtyRegs[RegUtils::ToInt(RegOffset::HibCfg)] = true;
-		}
+			while (true)
+			{
+				bool expected = false;
+				if (!m_IsBusOwned.compare_exchange_strong(expected, true))
+				{
+					return;
+				}
 
-		void SetCommand(Command command)
-		{
-			RegUtils::Write<Command, std::endian::little>(command, m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::Command), 0, 16);
-			m_DirtyRegs[RegUtils::ToInt(RegOffset::Command)] = true;
+				if (DispatchNext())
+				{
+					return;
+				}
+
+				if (!ReleaseBus())
+				{
+					return;
+				}
+			}
 		}
 
-		Command GetCommand()
+		/// <summary>
+		/// Gives up bus ownership after the queue was found drained.
+		/// </summary>
+		/// <returns>True if a request was queued or an AtRate read settled meanwhile while the bus still looked owned, so it must be dispatched by someone.</returns>
+		bool ReleaseBus()
 		{
-			return RegUtils::Read<Command, std::endian::little>(m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::Command), 0, 16);
+			m_IsBusOwned.store(false, std::memory_order_seq_cst);
+			// Keeps the queue check below from being ordered before the release, see Submit
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			return m_Queue.GetSize() != 0 || m_IsAtRateSettled.load(std::memory_order_relaxed);
 		}
 
 		/// <summary>
-		/// Assumes 0.010 Ohm sense resistor.
+		/// Starts queued transactions until one is in flight. Must only be called by the bus owner.
 		/// </summary>
-		/// <param name="valueMah">Battery capacity in mAh</param>
-		void SetDesignCapacity(MicroAmpereHours valueMah)
+		/// <returns>True if a transaction is in flight. False if the queue was drained.</returns>
+		bool DispatchNext()
 		{
-			uint16_t value = valueMah.ToRaw();
-			RegUtils::Write<uint16_t, std::endian::little>(value, m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::DesignCap), 0, 16);
-			m_DirtyRegs[RegUtils::ToInt(RegOffset::DesignCap)] = true;
+			if (m_IsAtRateSettled.exchange(false))
+			{
+				Transaction continuation = m_AtRateContinuation;
+				if (StartBus(continuation) || Retry(continuation))
+				{
+					return true;
+				}
+				Finish(continuation, false);
+			}
+
+			Transaction transaction;
+			while (m_Queue.TryPop(transaction))
+			{
+				if (!transaction.IsContinuation)
+				{
+					auto wait = (Clock::now() - transaction.EnqueueTime).count();
+					m_DispatchedCount++;
+					m_TotalWaitTicks += wait;
+					auto maxWait = m_MaxWaitTicks.load();
+					while (wait > maxWait && !m_MaxWaitTicks.compare_exchange_weak(maxWait, wait))
+					{
+					}
+				}
+
+				if ((transaction.Kind == TransactionKind::WriteDirty || transaction.Kind == TransactionKind::WriteDirtyVerify) && !m_Registers.HasDirty())
+				{
+					Finish(transaction, true);
+					continue;
+				}
+
+				if (Start(transaction) || Retry(transaction))
+				{
+					return true;
+				}
+
+				Finish(transaction, false);
+			}
+			return false;
 		}
 
 		/// <summary>
-		/// Assumes 0.010 Ohm sense resistor.
+		/// Accounts finished transaction and wakes whoever waits for it.
 		/// </summary>
-		/// <returns>Battery capacity in mAh</returns>
-		MicroAmpereHours GetDesignCapacity() const
+		void Finish(const Transaction& transaction, bool ok)
 		{
-			uint16_t value = RegUtils::Read<uint16_t, std::endian::little>(m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::DesignCap), 0, 16);
-			return MicroAmpereHours::FromRaw(value);
+			if (!ok)
+			{
+				m_HasError = true;
+			}
+
+			if (transaction.Kind == TransactionKind::AtRate)
+			{
+				m_IsAtRateRunning = false;
+			}
+
+			if (transaction.Kind == TransactionKind::Read || transaction.Kind == TransactionKind::Telemetry)
+			{
+				for (size_t i = 0; i < transaction.Count; i++)
+				{
+					m_RefreshPending[transaction.Offset + i].store(false, std::memory_order_relaxed);
+				}
+			}
+
+			m_PendingCount--;
+			m_PendingCount.notify_all();
+
+			Completion* waiter = transaction.Waiter;
+			if (waiter == nullptr)
+			{
+				return;
+			}
+
+			std::coroutine_handle<> handle = waiter->m_Handle;
+			waiter->m_IsOk = ok;
+			waiter->m_IsDone.store(true, std::memory_order_release);
+			m_CompletionEpoch++;
+			m_CompletionEpoch.notify_all();
+			if (handle)
+			{
+				handle.resume();
+			}
 		}
 
 		/// <summary>
-		/// Assumes 0.010 Ohm sense resistor.
+		/// Finishes transaction in flight and keeps the bus busy with the next queued one.
 		/// </summary>
-		/// <param name="valueMah">Battery capacity in mAh</param>
-		void SetTerminationCurrent(MicroAmperes valueMa)
+		void Complete(const Transaction& transaction, bool ok)
 		{
-			int16_t value = valueMa.ToRaw();
-			RegUtils::Write<int16_t, std::endian::little>(value, m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::IChgTerm), 0, 16);
-			m_DirtyRegs[RegUtils::ToInt(RegOffset::IChgTerm)] = true;
+			Finish(transaction, ok);
+			DispatchOrRelease();
 		}
 
 		/// <summary>
-		/// Assumes 0.010 Ohm sense resistor.
+		/// Keeps the bus busy with the next queued transaction, or gives up ownership when the queue is drained.
 		/// </summary>
-		/// <returns>Battery capacity in mAh</returns>
-		MicroAmperes GetTerminationCurrent() const
+		void DispatchOrRelease()
 		{
-			int16_t value = RegUtils::Read<int16_t, std::endian::little>(m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::DesignCap), 0, 16);
-			return MicroAmperes::FromRaw(value);
-		}
+			if (DispatchNext())
+			{
+				return;
+			}
 
-		void SetEmptyVoltage(MicroVolts valueUv)
-		{
-			uint16_t value = valueUv.GetMicroVolts() / 10000;
-			RegUtils::Write<uint16_t, std::endian::little>(value, m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::VEmpty), 7, 16);
-			m_DirtyRegs[RegUtils::ToInt(RegOffset::VEmpty)] = true;
+			if (ReleaseBus())
+			{
+				Dispatch();
+			}
 		}
 
-		MicroVolts GetEmptyVoltage() const
+		bool Start(const Transaction& transaction)
 		{
-			uint16_t value = RegUtils::Read<uint16_t, std::endian::little>(m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::VEmpty), 7, 16);
-			return MicroVolts(value * 10000);
+			if (transaction.Kind == TransactionKind::WriteDirty || transaction.Kind == TransactionKind::WriteDirtyVerify)
+			{
+				m_WriteDirtyTransactionCount = 0;
+			}
+			if (transaction.Kind == TransactionKind::WriteDirtyVerify)
+			{
+				m_VerifyPending = {};
+				m_VerifyRewrites = 0;
+				m_VerifyRoundMismatchCount = 0;
+				m_VerifyMismatchCount = 0;
+			}
+			return StartBus(transaction);
 		}
 
-		void SetRecoveryVoltage(MicroVolts valueUv)
+		/// <summary>
+		/// Starts the bus transaction for the current step of a request: the run of a WriteDirty, the write or read of an AtRate candidate.
+		/// </summary>
+		bool StartBus(const Transaction& transaction)
 		{
-			uint16_t value = valueUv.GetMicroVolts() / 40000;
-			RegUtils::Write<uint16_t, std::endian::little>(value, m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::VEmpty), 0, 7);
-			m_DirtyRegs[RegUtils::ToInt(RegOffset::VEmpty)] = true;
+			switch (transaction.Kind)
+			{
+			case TransactionKind::Read:
+			case TransactionKind::Telemetry:
+			case TransactionKind::VerifyRead:
+				return StartRead(transaction);
+			case TransactionKind::Write:
+				return StartWrite(transaction);
+			case TransactionKind::WriteDirty:
+			case TransactionKind::WriteDirtyVerify:
+				return WriteDirtyInternal(transaction.Kind, transaction.Offset, transaction.Waiter, transaction.Attempt);
+			case TransactionKind::AtRate:
+				return transaction.Offset == RegUtils::ToInt(RegOffset::AtRate) ? StartAtRateWrite(transaction) : StartRead(transaction);
+			default:
+				return false;
+			}
 		}
 
-		MicroVolts GetRecoveryVoltage() const
+		/// <summary>
+		/// Starts the bus transaction after delay through the scheduler. The bus stays owned meanwhile, so nothing else runs in between.
+		/// Starts it at once if there is no delay.
+		/// </summary>
+		/// <returns>True if the transaction is scheduled or in flight.</returns>
+		bool StartAfter(const Transaction& transaction, std::chrono::microseconds delay)
 		{
-			uint16_t value = RegUtils::Read<uint16_t, std::endian::little>(m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::VEmpty), 0, 7);
-			return MicroVolts(value * 40000);
-		}
+			if (!m_Scheduler || delay <= std::chrono::microseconds::zero())
+			{
+				return StartBus(transaction);
+			}
 
-		ModelId GetModelId() const
-		{
-			return RegUtils::Read<ModelId, std::endian::little>(m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::ModelCfg), 4, 4);
+			m_Transaction = transaction;
+			m_Scheduler(delay, [this]() { ResumeScheduled(); });
+			return true;
 		}
 
-		void SetModelId(ModelId value)
+		void ResumeScheduled()
 		{
-			RegUtils::Write<ModelId, std::endian::little>(value, m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::ModelCfg), 4, 4);
-			m_DirtyRegs[RegUtils::ToInt(RegOffset::ModelCfg)] = true;
+			Transaction transaction = m_Transaction;
+			m_Transaction = Transaction{};
+			if (!StartBus(transaction) && !Retry(transaction))
+			{
+				Continue(transaction, false);
+			}
 		}
 
-		bool IsHighChargeVoltage() const
+		/// <summary>
+		/// Hands the settled AtRate result read to whoever owns the bus, or takes the bus if it is free.
+		/// </summary>
+		void ResumeAtRate()
 		{
-			return RegUtils::Read<uint8_t, std::endian::little>(m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::ModelCfg), 10, 1);
+			m_IsAtRateSettled.store(true, std::memory_order_seq_cst);
+			// Pairs with the fence in ReleaseBus, like Submit
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			Dispatch();
 		}
 
-		void SetHighChargeVoltage(bool value)
+		/// <summary>
+		/// Handles a failed attempt: runs bus recovery when due, then starts the same bus transaction again after a backoff, until the policy runs out of attempts.
+		/// </summary>
+		/// <returns>True if a retry is scheduled or in flight. False if the request has failed.</returns>
+		bool Retry(Transaction transaction)
 		{
-			RegUtils::Write<uint8_t, std::endian::little>(value, m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::ModelCfg), 10, 1);
-			m_DirtyRegs[RegUtils::ToInt(RegOffset::ModelCfg)] = true;
-		}
+			while (true)
+			{
+				OnFailure();
+				if (transaction.Attempt + 1 >= m_RetryPolicy.MaxAttempts)
+				{
+					m_ExhaustedCount++;
+					return false;
+				}
 
-		bool IsModelRefreshFlagSet() const
-		{
-			return RegUtils::Read<uint8_t, std::endian::little>(m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::ModelCfg), 15, 1);
-		}
+				transaction.Attempt++;
+				m_RetryCount++;
+				if constexpr (StatsPolicy::IsEnabled)
+				{
+					m_Stats.OnRetry(transaction.Offset, transaction.Count);
+				}
 
-		void SetModelRefreshFlag(bool value)
-		{
-			RegUtils::Write<uint8_t, std::endian::little>(value, m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::ModelCfg), 10, 1);
-			m_DirtyRegs[RegUtils::ToInt(RegOffset::ModelCfg)] = true;
+				auto backoff = m_RetryPolicy.InitialBackoff * (1 << std::min(transaction.Attempt - 1, 15));
+				if (StartAfter(transaction, std::min(backoff, m_RetryPolicy.MaxBackoff)))
+				{
+					return true;
+				}
+			}
 		}
 
-		MicroAmpereHours GetRemainingCapacity() const
+		void OnFailure()
 		{
-			uint16_t value = RegUtils::Read<uint16_t, std::endian::little>(m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::RepCap), 0, 16);
-			return MicroAmpereHours::FromRaw(value);
-		}
+			if (m_ConsecutiveFailures++ == 0)
+			{
+				m_FailureStreakStart = Clock::now();
+			}
 
-		MicroAmpereHours GetEstimatedFullCapacity() const
-		{
-			uint16_t value = RegUtils::Read<uint16_t, std::endian::little>(m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::FullCapRep), 0, 16);
-			return MicroAmpereHours::FromRaw(value);
+			if (m_BusRecovery && m_RetryPolicy.RecoveryThreshold != 0 && m_ConsecutiveFailures % m_RetryPolicy.RecoveryThreshold == 0)
+			{
+				m_BusRecoveryCount++;
+				m_BusRecovery();
+			}
 		}
 
-		void SetEstimatedFullCapacity(MicroAmpereHours valueuAh)
+		void OnSuccess()
 		{
-			uint16_t value = valueuAh.ToRaw();
-			RegUtils::Write<uint16_t, std::endian::little>(value, m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::FullCapRep), 0, 16);
-			m_DirtyRegs[RegUtils::ToInt(RegOffset::FullCapRep)] = true;
-		}
+			if (m_ConsecutiveFailures == 0)
+			{
+				return;
+			}
 
-		MicroAmpereHours GetNominalFullCapacity() const
-		{
-			uint16_t value = RegUtils::Read<uint16_t, std::endian::little>(m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::FullCapNom), 0, 16);
-			return MicroAmpereHours::FromRaw(value);
+			m_ConsecutiveFailures = 0;
+			auto latency = (Clock::now() - m_FailureStreakStart).count();
+			m_RecoveredCount++;
+			m_TotalRecoveryTicks += latency;
+			auto maxLatency = m_MaxRecoveryTicks.load();
+			while (latency > maxLatency && !m_MaxRecoveryTicks.compare_exchange_weak(maxLatency, latency))
+			{
+			}
 		}
 
-		void SetNominalFullCapacity(MicroAmpereHours cap)
+		bool StartRead(const Transaction& transaction)
 		{
-			uint16_t value = cap.ToRaw();
-			RegUtils::Write<uint16_t, std::endian::little>(value, m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::FullCapNom), 0, 16);
-			m_DirtyRegs[RegUtils::ToInt(RegOffset::FullCapNom)] = true;
-		}
+			uint8_t offset = transaction.Offset;
+			RecordIssue();
+			if (!m_Driver.Write(Address, &offset, 1))
+			{
+				RecordComplete(transaction, false);
+				return false;
+			}
 
-		uint16_t GetRemainingSoc() const
-		{
-			return RegUtils::Read<uint16_t, std::endian::little>(m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::RepSOC), 0, 16);
+			m_Transaction = transaction;
+			if (!m_Driver.ReadAsync(Address, m_RxBuffer.data(), transaction.Count * RegisterSize, [this](uint8_t cbAddress, bool cbOk) {TransactionCallback(cbAddress, cbOk); }))
+			{
+				RecordComplete(transaction, false);
+				return false;
+			}
+			return true;
 		}
 
-		MicroAmperes GetCurrent() const
+		bool StartWrite(const Transaction& transaction)
 		{
-			int16_t value = RegUtils::Read<int16_t, std::endian::little>(m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::Current), 0, 16);
-			return MicroAmperes::FromRaw(value);
+			m_TxBuffer[0] = transaction.Offset;
+			m_Registers.Pack(transaction.Offset, m_TxBuffer.data() + 1, transaction.Count);
+			m_Transaction = transaction;
+			RecordIssue();
+			if (!m_Driver.WriteAsync(Address, m_TxBuffer.data(), transaction.Count * RegisterSize + 1, [this](uint8_t cbAddress, bool cbOk) {TransactionCallback(cbAddress, cbOk); }))
+			{
+				RecordComplete(transaction, false);
+				return false;
+			}
+			return true;
 		}
 
-		uint16_t GetTimeToEmpty() const
+		void RecordIssue()
 		{
-			return RegUtils::Read<uint16_t, std::endian::little>(m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::TTE), 0, 16);
+			if constexpr (StatsPolicy::IsEnabled)
+			{
+				m_Stats.OnIssue(Clock::now());
+			}
 		}
 
-		uint16_t GetTimeToFull() const
+		void RecordComplete(const Transaction& transaction, bool ok)
 		{
-			return RegUtils::Read<uint16_t, std::endian::little>(m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::TTF), 0, 16);
+			if constexpr (StatsPolicy::IsEnabled)
+			{
+				bool isWrite = transaction.Kind == TransactionKind::Write || transaction.Kind == TransactionKind::WriteDirty || transaction.Kind == TransactionKind::WriteDirtyVerify
+					|| (transaction.Kind == TransactionKind::AtRate && transaction.Offset == RegUtils::ToInt(RegOffset::AtRate));
+				m_Stats.OnComplete(transaction.Offset, transaction.Count, isWrite, ok, Clock::now());
+			}
 		}
 
-		uint16_t GetCycles() const
+		void TransactionCallback(uint8_t deviceAddress, bool ok)
 		{
-			return RegUtils::Read<uint16_t, std::endian::little>(m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::Cycles), 0, 16);
-		}
+			(void)deviceAddress;
+			Transaction transaction = m_Transaction;
+			m_Transaction = Transaction{};
+			RecordComplete(transaction, ok);
+			if (ok)
+			{
+				OnSuccess();
+			}
+			else if (Retry(transaction))
+			{
+				return;
+			}
 
-		void SetCycles(uint16_t value)
-		{
-			RegUtils::Write<uint16_t, std::endian::little>(value, m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::Cycles), 0, 16);
-			m_DirtyRegs[RegUtils::ToInt(RegOffset::Cycles)] = true;
+			Continue(transaction, ok);
 		}
 
-		uint16_t GetRcomp0() const
+		/// <summary>
+		/// Hands the outcome of a bus transaction to the handler of its request kind, after any retries.
+		/// </summary>
+		void Continue(const Transaction& transaction, bool ok)
 		{
-			return RegUtils::Read<uint16_t, std::endian::little>(m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::RComp0), 0, 16);
+			switch (transaction.Kind)
+			{
+			case TransactionKind::Read:
+			case TransactionKind::Telemetry:
+				ReadCallback(transaction, ok);
+				break;
+			case TransactionKind::Write:
+				WriteCallback(transaction, ok);
+				break;
+			case TransactionKind::WriteDirty:
+			case TransactionKind::WriteDirtyVerify:
+				WriteDirtyCallback(transaction, ok);
+				break;
+			case TransactionKind::VerifyRead:
+				VerifyCallback(transaction, ok);
+				break;
+			case TransactionKind::AtRate:
+				AtRateCallback(transaction, ok);
+				break;
+			default:
+				break;
+			}
 		}
 
-		void SetRcomp0(uint16_t value)
+		void ReadCallback(const Transaction& transaction, bool ok)
 		{
-			RegUtils::Write<uint16_t, std::endian::little>(value, m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::RComp0), 0, 16);
-			m_DirtyRegs[RegUtils::ToInt(RegOffset::RComp0)] = true;
-		}
+			if (ok)
+			{
+				m_Registers.Unpack(transaction.Offset, m_RxBuffer.data(), transaction.Count, Clock::now());
+				if (transaction.Kind == TransactionKind::Telemetry)
+				{
+					PublishTelemetry();
+				}
+			}
 
-		uint16_t GetTempCo() const
-		{
-			return RegUtils::Read<uint16_t, std::endian::little>(m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::TempCo), 0, 16);
+			Complete(transaction, ok);
 		}
 
-		void SetTempCo(uint16_t value)
+		void WriteCallback(const Transaction& transaction, bool ok)
 		{
-			RegUtils::Write<uint16_t, std::endian::little>(value, m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::TempCo), 0, 16);
-			m_DirtyRegs[RegUtils::ToInt(RegOffset::TempCo)] = true;
-		}
+			if (ok)
+			{
+				m_Registers.ClearDirty(transaction.Offset, transaction.Count);
+			}
 
-		MicroVolts GetVCell() const
-		{
-			uint16_t value = RegUtils::Read<uint16_t, std::endian::little>(m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::VCell), 0, 16);
-			return MicroVolts::FromRaw(value);
+			Complete(transaction, ok);
 		}
 
-		ConfigFlags GetConfig() const
+		void PublishTelemetry()
 		{
-			return RegUtils::Read<ConfigFlags, std::endian::little>(m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::Config), 0, 16);
+			TelemetrySnapshotType snapshot;
+			snapshot.Sequence = ++m_TelemetrySequence;
+			snapshot.Timestamp = GetRegisterReadTime(TelemetryFirst);
+			snapshot.Status = GetStatus();
+			snapshot.RemainingCapacity = GetRemainingCapacity();
+			snapshot.RemainingSoc = GetRemainingSoc();
+			snapshot.Temperature = GetTemperature();
+			snapshot.VCell = GetVCell();
+			snapshot.Current = GetCurrent();
+			snapshot.AverageCurrent = GetAverageCurrent();
+			snapshot.TimeToEmpty = GetTimeToEmpty();
+			m_Telemetry.Store(snapshot);
 		}
 
-		void SetConfig(ConfigFlags value)
+		/// <summary>
+		/// Starts burst write of the next dirty run at or after regNext.
+		/// </summary>
+		/// <returns>True if a write was started. False if nothing is left to write or the driver refused.</returns>
+		bool WriteDirtyInternal(TransactionKind kind, size_t regNext, Completion* waiter, uint8_t attempt = 0)
 		{
-			RegUtils::Write<ConfigFlags, std::endian::little>(value, m_MemoryBuffer.data() + RegUtils::ToInt(RegOffset::Config), 0, 16);
-			m_DirtyRegs[RegUtils::ToInt(RegOffset::Config)] = true;
-		}
+			size_t first = 0;
+			size_t count = 0;
+			if (!m_Registers.FindDirtyRun(regNext, first, count))
+			{
+				return false;
+			}
 
-	private:
-		I2CDriver& m_Driver;
-		std::array<uint8_t, MemorySize> m_MemoryBuffer{ 0 };
-		bool m_IsTransactionInProgress = false;
-		bool m_HasError = false;
-		std::bitset<MemorySize> m_DirtyRegs{ 0 };
+			m_WriteDirtyTransactionCount++;
+			return StartWrite(Transaction{ kind, static_cast<uint8_t>(first), static_cast<uint16_t>(count), {}, waiter, nullptr, 0, attempt });
+		}
 
-		bool Read(uint8_t offset, uint8_t* data, size_t size, const std::bitset<MemorySize>& regs)
+		void WriteDirtyCallback(const Transaction& transaction, bool ok)
 		{
-			if (m_IsTransactionInProgress)
+			if (!ok)
 			{
-				return false;
+				Complete(transaction, false);
+				return;
 			}
 
-			m_HasError = !m_Driver.Write(Address, &offset, 1);
-			if (m_HasError)
+			m_Registers.ClearDirty(transaction.Offset, transaction.Count);
+			if (transaction.Kind == TransactionKind::WriteDirtyVerify)
 			{
-				return false;
+				for (size_t i = transaction.Offset; i < transaction.Offset + transaction.Count; i++)
+				{
+					m_VerifyPending[i] = VerifyMaskTable[i] != 0;
+				}
 			}
 
-			m_IsTransactionInProgress = true;
-			bool transactionStarted = m_Driver.ReadAsync(Address, data, size, [this, regs](uint8_t cbAddress, bool cbOk) {ReadCallback(cbAddress, regs, cbOk); });
-			if (!transactionStarted)
+			size_t first = 0;
+			size_t count = 0;
+			if (!m_Registers.FindDirtyRun(transaction.Offset + transaction.Count, first, count))
 			{
-				m_IsTransactionInProgress = false;
+				if (transaction.Kind == TransactionKind::WriteDirtyVerify)
+				{
+					ContinueVerify(transaction.Waiter, 0);
+					return;
+				}
+				Complete(transaction, true);
+				return;
 			}
 
-			return transactionStarted;
+			Transaction next{ transaction.Kind, static_cast<uint8_t>(first), static_cast<uint16_t>(count), {}, transaction.Waiter };
+			if (!WriteDirtyInternal(transaction.Kind, first, transaction.Waiter) && !Retry(next))
+			{
+				Complete(transaction, false);
+			}
 		}
 
-		bool Write(uint8_t offset, uint8_t* data, size_t size, const std::bitset<MemorySize>& regs)
+		/// <summary>
+		/// Finds the next burst read for verification at or after regNext. Gaps of up to VerifyGapLimit readable registers
+		/// are read through, as that is cheaper than addressing the device again.
+		/// </summary>
+		/// <returns>False if nothing is left to verify.</returns>
+		bool FindVerifyRun(size_t regNext, size_t& first, size_t& count) const
 		{
-			if (m_IsTransactionInProgress)
+			size_t i = regNext;
+			while (i < RegisterCount && !m_VerifyPending[i])
+			{
+				i++;
+			}
+			if (i == RegisterCount)
 			{
 				return false;
 			}
 
-			m_HasError = false;
-
-			std::vector<uint8_t> buffer;
-			buffer.resize(size + 1);
-			buffer[0] = offset;
-			memcpy(buffer.data() + 1, data, size);
-
-			m_IsTransactionInProgress = true;
-			bool transactionStarted = m_Driver.WriteAsync(Address, buffer.data(), buffer.size(), [this, regs](uint8_t cbAddress, bool cbOk) {WriteCallback(cbAddress, regs, cbOk); });
-			if (!transactionStarted)
+			first = i;
+			size_t last = i;
+			size_t gap = 0;
+			for (i++; i < RegisterCount && ReadableTable[i]; i++)
 			{
-				m_IsTransactionInProgress = false;
+				if (m_VerifyPending[i])
+				{
+					last = i;
+					gap = 0;
+				}
+				else if (++gap > VerifyGapLimit)
+				{
+					break;
+				}
 			}
-
-			return transactionStarted;
+			count = last - first + 1;
+			return true;
 		}
 
-		void ReadCallback(uint8_t deviceAddress, std::bitset<MemorySize> regs, bool ok)
+		/// <summary>
+		/// Starts the next read-back of a WriteDirtyAndVerify round. When the round is done, writes the mismatched registers again or completes.
+		/// </summary>
+		void ContinueVerify(Completion* waiter, size_t regNext)
 		{
-			(void)deviceAddress;
-			m_HasError = !ok;
-			m_IsTransactionInProgress = false;
+			size_t first = 0;
+			size_t count = 0;
+			if (FindVerifyRun(regNext, first, count))
+			{
+				Transaction next{ TransactionKind::VerifyRead, static_cast<uint8_t>(first), static_cast<uint16_t>(count), {}, waiter };
+				if (!StartRead(next) && !Retry(next))
+				{
+					Complete(next, false);
+				}
+				return;
+			}
 
-			if (ok)
+			Transaction rewrite{ TransactionKind::WriteDirtyVerify, 0, 0, {}, waiter };
+			if (m_VerifyRoundMismatchCount == 0)
 			{
-				m_DirtyRegs &= ~regs;
+				Complete(rewrite, true);
+				return;
 			}
-		}
 
-		void WriteCallback(uint8_t deviceAddress, std::bitset<MemorySize> regs, bool ok)
-		{
-			(void)deviceAddress;
-			m_HasError = !ok;
-			m_IsTransactionInProgress = false;
+			m_VerifyRoundMismatchCount = 0;
+			if (m_VerifyRewrites++ == MaxVerifyRewrites)
+			{
+				Complete(rewrite, false);
+				return;
+			}
 
-			if (ok)
+			if (!StartBus(rewrite) && !Retry(rewrite))
 			{
-				m_DirtyRegs &= ~regs;
+				Complete(rewrite, false);
 			}
 		}
 
-		bool WriteDirtyInternal(RegOffset regNext)
+		/// <summary>
+		/// Compares read-back values with the shadow. Mismatches are marked dirty again so the next round rewrites them.
+		/// </summary>
+		void VerifyCallback(const Transaction& transaction, bool ok)
 		{
-			for (size_t i = RegUtils::ToInt(regNext); i < m_DirtyRegs.size(); i++)
+			if (!ok)
+			{
+				Complete(transaction, false);
+				return;
+			}
+
+			for (size_t i = 0; i < transaction.Count; i++)
 			{
-				if (!m_DirtyRegs[i])
+				size_t offset = transaction.Offset + i;
+				if (!m_VerifyPending[offset])
 				{
 					continue;
 				}
-				RegOffset reg = static_cast<RegOffset>(i);
 
-				constexpr uint8_t regSize = 2;
-				std::vector<uint8_t> buffer;
-				buffer.resize(regSize + 1);
-				buffer[0] = i;
-				memcpy(buffer.data() + 1, m_MemoryBuffer.data() + i, regSize);
-				return m_Driver.WriteAsync(Address, buffer.data(), buffer.size(), [this, reg](uint8_t cbAddress, bool cbOk) {WriteDirtyCallback(cbAddress, reg, cbOk); });
+				m_VerifyPending[offset] = false;
+				auto value = RegUtils::Read<uint16_t, std::endian::little>(m_RxBuffer.data() + i * RegisterSize, 0, 16);
+				if (((value ^ m_Registers.GetValue(offset)) & VerifyMaskTable[offset]) != 0)
+				{
+					m_Registers[offset].IsDirty = true;
+					m_VerifyRoundMismatchCount++;
+					m_VerifyMismatchCount++;
+				}
 			}
-			return false;
+
+			ContinueVerify(transaction.Waiter, transaction.Offset + transaction.Count);
+		}
+
+		/// <summary>
+		/// Writes AtRate for the first remaining candidate. The value goes straight to the transmit buffer, not through the shadow register.
+		/// </summary>
+		bool StartAtRateWrite(const Transaction& transaction)
+		{
+			auto raw = static_cast<uint16_t>(SenseFieldsType::AtRate::CodecType::Encode(transaction.Predictions->Rate));
+			m_TxBuffer[0] = transaction.Offset;
+			RegUtils::Write<uint16_t, std::endian::little>(raw, m_TxBuffer.data() + 1, 0, 16);
+			m_Transaction = transaction;
+			RecordIssue();
+			if (!m_Driver.WriteAsync(Address, m_TxBuffer.data(), RegisterSize + 1, [this](uint8_t cbAddress, bool cbOk) {TransactionCallback(cbAddress, cbOk); }))
+			{
+				RecordComplete(transaction, false);
+				return false;
+			}
+			return true;
 		}
 
-		void WriteDirtyCallback(uint8_t deviceAddress, RegOffset reg, bool ok)
+		/// <summary>
+		/// Follows an AtRate write with the burst read of its results once they settled, and a read with the next candidate.
+		/// The bus is released while the results settle. The next candidate goes to the back of the queue if anything else is waiting,
+		/// so a batch never holds the bus for longer than one transaction.
+		/// </summary>
+		void AtRateCallback(const Transaction& transaction, bool ok)
 		{
-			(void)deviceAddress;
 			if (!ok)
 			{
-				m_HasError = true;
-				m_IsTransactionInProgress = false;
+				Complete(transaction, false);
+				return;
+			}
+
+			Transaction next = transaction;
+			next.Attempt = 0;
+			if (transaction.Offset == RegUtils::ToInt(RegOffset::AtRate))
+			{
+				next.Offset = RegUtils::ToInt(AtResultFirst);
+				next.Count = RegUtils::ToInt(AtResultLast) - RegUtils::ToInt(AtResultFirst) + 1;
+				if (m_AtRateSettleTime > std::chrono::microseconds::zero())
+				{
+					m_AtRateContinuation = next;
+					m_Scheduler(m_AtRateSettleTime, [this]() { ResumeAtRate(); });
+					DispatchOrRelease();
+					return;
+				}
+
+				if (!StartRead(next) && !Retry(next))
+				{
+					Complete(transaction, false);
+				}
 				return;
 			}
 
-			m_HasError = false;
-			m_DirtyRegs[RegUtils::ToInt(reg)] = false;
-			if (m_DirtyRegs == 0)
+			m_Registers.Unpack(transaction.Offset, m_RxBuffer.data(), transaction.Count, Clock::now());
+			AtRatePredictionType& prediction = *transaction.Predictions;
+			prediction.ResidualCapacity = Get<typename SenseFieldsType::AtQResidual>();
+			prediction.AvailableCapacity = Get<typename SenseFieldsType::AtAvCap>();
+			prediction.AvailableSoc = Get<Fields::AtAvSOC>();
+			prediction.TimeToEmpty = Get<Fields::AtTTE>();
+			prediction.IsValid = true;
+
+			if (transaction.PredictionCount == 1)
 			{
-				m_IsTransactionInProgress = false;
+				Complete(transaction, true);
 				return;
 			}
 
-			if (!WriteDirtyInternal(static_cast<RegOffset>(RegUtils::ToInt(reg) + 1)))
+			next.Offset = RegUtils::ToInt(RegOffset::AtRate);
+			next.Count = 1;
+			next.Predictions++;
+			next.PredictionCount--;
+			next.IsContinuation = true;
+			if (m_Queue.GetSize() != 0 && m_Queue.TryPush(next))
 			{
-				m_HasError = true;
-				m_IsTransactionInProgress = false;
+				DispatchOrRelease();
 				return;
 			}
+
+			if (!StartAtRateWrite(next) && !Retry(next))
+			{
+				Complete(next, false);
+			}
 		}
 	};
 };
\ No newline at end of file
@@ -1,16 +1,31 @@
 #pragma once
 
+#include "PiSubmarine/Max1726/MicroAmperes.h"
+#include "PiSubmarine/Max1726/UnitKernels.h"
+#include <algorithm>
 #include <cstdint>
 #include <limits>
+#include <span>
 
 
 namespace PiSubmarine::Max1726
 {
 
-    struct MicroAmpereHours
+    // Charge in uAh. The sense resistor only affects raw conversion: the gauge integrates the voltage across it
+    template<int64_t RSense = DefaultRSenseMicroOhms>
+    struct BasicMicroAmpereHours
     {
+        static_assert(RSense > 0, "Sense resistor must be positive");
+
         constexpr static size_t BitShift = 0;
-        constexpr static size_t RSenseMicroOhms = 10000;
+        constexpr static int64_t RSenseMicroOhms = RSense;
+
+        // 5.0 uVh per LSB, in pVh, scaled to the internal representation
+        constexpr static uint64_t RawScaleNumerator = 5000000ULL << BitShift;
+
+        // Internal value per LSB when the sense resistor divides the scale. Conversions then fold to one multiply or divide
+        constexpr static bool IsExactScale = RawScaleNumerator % static_cast<uint64_t>(RSense) == 0;
+        constexpr static uint64_t RawScale = RawScaleNumerator / static_cast<uint64_t>(RSense);
 
         constexpr uint64_t GetMicroAmpereHours() const
         {
@@ -18,54 +33,101 @@ namespace PiSubmarine::Max1726
         }
 
         // Constructor
-        constexpr explicit MicroAmpereHours(uint64_t uAh = 0) : value(uAh << BitShift) {}
+        constexpr explicit BasicMicroAmpereHours(uint64_t uAh = 0) : value(uAh << BitShift) {}
 
-        // Convert from raw device value to MicroAmpereHours
-        static constexpr MicroAmpereHours FromRaw(uint16_t raw)
+        // Same physical charge, only the raw scaling differs
+        template<int64_t OtherRSense>
+        constexpr BasicMicroAmpereHours(const BasicMicroAmpereHours<OtherRSense>& other) : value(other.value) {}
+
+        // Builds from the fixed-point representation, uAh << BitShift
+        static constexpr BasicMicroAmpereHours FromFixedPoint(uint64_t fixedPoint)
         {
-            // 5.0 uVh per LSB = 5 uWh per Rsense (uOhm)
-            // I = V / R -> uAh = raw * 5.0 / Rsense
-            // Multiply raw by 5000 (to convert 5.0 to 5000 pAh)
-            uint64_t temp = ((static_cast<uint64_t>(raw) * 5000000) << BitShift) / RSenseMicroOhms;
+            BasicMicroAmpereHours result;
+            result.value = fixedPoint;
+            return result;
+        }
 
-            MicroAmpereHours result;
-            result.value = temp;
+        // Convert from raw device value to MicroAmpereHours
+        static constexpr BasicMicroAmpereHours FromRaw(uint16_t raw)
+        {
+            // I = V / R -> uAh = raw * 5.0 uVh / Rsense
+            BasicMicroAmpereHours result;
+            if constexpr (IsExactScale)
+            {
+                result.value = static_cast<uint64_t>(raw) * RawScale;
+            }
+            else
+            {
+                result.value = (static_cast<uint64_t>(raw) * RawScaleNumerator) / static_cast<uint64_t>(RSense);
+            }
             return result;
         }
 
         // Convert to raw device format
         constexpr uint16_t ToRaw() const
         {
-            // raw = uAh * Rsense / 5.0
-            // Multiply by Rsense first, then divide by 5000 (with rounding)
-            uint64_t temp = (value * RSenseMicroOhms) >> BitShift;
-            uint64_t raw = temp / 5000000;
-
+            // raw = uAh * Rsense / 5.0 uVh, rounded to nearest so ToRaw(FromRaw(raw)) == raw even though FromRaw truncates
+            uint64_t raw;
+            if constexpr (IsExactScale)
+            {
+                raw = value / RawScale;
+            }
+            else
+            {
+                raw = (value * static_cast<uint64_t>(RSense) + RawScaleNumerator / 2) / RawScaleNumerator;
+            }
             return static_cast<uint16_t>(raw);
         }
 
+        // Batch FromRaw, bit-exact with the scalar one
+        static void FromRaw(std::span<const uint16_t> raw, std::span<BasicMicroAmpereHours> out)
+        {
+            size_t count = std::min(raw.size(), out.size());
+            if constexpr (IsExactScale && RawScale * 65535 <= INT32_MAX)
+            {
+                UnitKernels::Scale<uint16_t, static_cast<int32_t>(RawScale)>(raw.data(), out.data(), count);
+            }
+            else
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    out[i] = FromRaw(raw[i]);
+                }
+            }
+        }
+
+        // Batch ToRaw. A plain loop on purpose, see UnitKernels
+        static void ToRaw(std::span<const BasicMicroAmpereHours> values, std::span<uint16_t> raw)
+        {
+            size_t count = std::min(values.size(), raw.size());
+            for (size_t i = 0; i < count; i++)
+            {
+                raw[i] = values[i].ToRaw();
+            }
+        }
+
         // Arithmetic operators
-        constexpr MicroAmpereHours operator+(const MicroAmpereHours& other) const
+        constexpr BasicMicroAmpereHours operator+(const BasicMicroAmpereHours& other) const
         {
-            MicroAmpereHours result;
+            BasicMicroAmpereHours result;
             result.value = this->value + other.value;
             return result;
         }
 
-        constexpr MicroAmpereHours operator-(const MicroAmpereHours& other) const
+        constexpr BasicMicroAmpereHours operator-(const BasicMicroAmpereHours& other) const
         {
-            MicroAmpereHours result;
+            BasicMicroAmpereHours result;
             result.value = this->value - other.value;
             return result;
         }
 
-        constexpr MicroAmpereHours& operator+=(const MicroAmpereHours& other)
+        constexpr BasicMicroAmpereHours& operator+=(const BasicMicroAmpereHours& other)
         {
             this->value += other.value;
             return *this;
         }
 
-        constexpr MicroAmpereHours& operator-=(const MicroAmpereHours& other)
+        constexpr BasicMicroAmpereHours& operator-=(const BasicMicroAmpereHours& other)
         {
             this->value -= other.value;
             return *this;
@@ -74,9 +136,14 @@ namespace PiSubmarine::Max1726
     private:
         uint64_t value;
 
-        friend constexpr MicroAmpereHours operator"" _uAh(long double uAh);
+        template<int64_t>
+        friend struct BasicMicroAmpereHours;
     };
 
+    using MicroAmpereHours = BasicMicroAmpereHours<>;
+
+    static_assert(sizeof(MicroAmpereHours) == sizeof(uint64_t), "Batch conversions access MicroAmpereHours as its value member");
+
     // Integer literal: 1000_uAh
     constexpr MicroAmpereHours operator"" _uAh(unsigned long long uAh)
     {
@@ -87,9 +154,7 @@ namespace PiSubmarine::Max1726
     constexpr MicroAmpereHours operator"" _uAh(long double uAh)
     {
         uint64_t value = static_cast<uint64_t>(uAh * (1 << MicroAmpereHours::BitShift));
-        MicroAmpereHours result;
-        result.value = value;
-        return result;
+        return MicroAmpereHours::FromFixedPoint(value);
     }
 
 }
\ No newline at end of file
@@ -1,62 +1,130 @@
 #pragma once
 
+#include "PiSubmarine/Max1726/UnitKernels.h"
+#include <algorithm>
 #include <cstdint>
 #include <limits>
+#include <span>
 
 namespace PiSubmarine::Max1726
 {
-    struct MicroAmperes
+    // Sense resistor of the reference design, 0.010 Ohm
+    constexpr static int64_t DefaultRSenseMicroOhms = 10000;
+
+    // Current in uA. The sense resistor only affects raw conversion: the gauge measures the voltage across it
+    template<int64_t RSense = DefaultRSenseMicroOhms>
+    struct BasicMicroAmperes
     {
+        static_assert(RSense > 0, "Sense resistor must be positive");
+
         constexpr static size_t BitShift = 4;
-        constexpr static int64_t RSenseMicroOhms = 10000;
+        constexpr static int64_t RSenseMicroOhms = RSense;
+
+        // 1.5625 uV per LSB, in nV, scaled to the internal representation
+        constexpr static int64_t RawScaleNumerator = 1562500 << BitShift;
+
+        // Internal value per LSB when the sense resistor divides the scale. Conversions then fold to one multiply or divide
+        constexpr static bool IsExactScale = RawScaleNumerator % RSense == 0;
+        constexpr static int64_t RawScale = RawScaleNumerator / RSense;
 
         // Constructor
-        constexpr explicit MicroAmperes(int64_t uA = 0) : value(uA << BitShift) {}
+        constexpr explicit BasicMicroAmperes(int64_t uA = 0) : value(uA << BitShift) {}
+
+        // Same physical current, only the raw scaling differs
+        template<int64_t OtherRSense>
+        constexpr BasicMicroAmperes(const BasicMicroAmperes<OtherRSense>& other) : value(other.value) {}
+
+        // Builds from the fixed-point representation, uA << BitShift
+        static constexpr BasicMicroAmperes FromFixedPoint(int64_t fixedPoint)
+        {
+            BasicMicroAmperes result;
+            result.value = fixedPoint;
+            return result;
+        }
 
         constexpr int64_t GetMicroAmperes() const
         {
             return value >> BitShift;
         }
 
-        static constexpr MicroAmperes FromRaw(int16_t raw)
+        static constexpr BasicMicroAmperes FromRaw(int16_t raw)
         {
-            int64_t uv = static_cast<int64_t>(raw) * 1562500; // in nV
-            int64_t ua = (uv * (1 << BitShift)) / RSenseMicroOhms;
-            MicroAmperes result;
-            result.value = ua;
+            BasicMicroAmperes result;
+            if constexpr (IsExactScale)
+            {
+                result.value = static_cast<int64_t>(raw) * RawScale;
+            }
+            else
+            {
+                result.value = (static_cast<int64_t>(raw) * RawScaleNumerator) / RSense;
+            }
             return result;
         }
 
         constexpr int16_t ToRaw() const
         {
-            constexpr int64_t scale = 1562500;
-            int64_t uv = value * RSenseMicroOhms;
-            int64_t raw = uv / scale;
-            raw /= (1 << BitShift);
+            int64_t raw;
+            if constexpr (IsExactScale)
+            {
+                raw = value / RawScale;
+            }
+            else
+            {
+                // Rounded to nearest, so ToRaw(FromRaw(raw)) == raw even though FromRaw truncates
+                int64_t scaled = value * RSense;
+                raw = (scaled + (scaled < 0 ? -RawScaleNumerator : RawScaleNumerator) / 2) / RawScaleNumerator;
+            }
             return static_cast<int16_t>(raw);
         }
 
-        constexpr MicroAmperes operator+(const MicroAmperes& other) const
+        // Batch FromRaw, bit-exact with the scalar one
+        static void FromRaw(std::span<const int16_t> raw, std::span<BasicMicroAmperes> out)
         {
-            MicroAmperes result;
+            size_t count = std::min(raw.size(), out.size());
+            if constexpr (IsExactScale && RawScale * 65535 <= INT32_MAX)
+            {
+                UnitKernels::Scale<int16_t, static_cast<int32_t>(RawScale)>(raw.data(), out.data(), count);
+            }
+            else
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    out[i] = FromRaw(raw[i]);
+                }
+            }
+        }
+
+        // Batch ToRaw. A plain loop on purpose, see UnitKernels
+        static void ToRaw(std::span<const BasicMicroAmperes> values, std::span<int16_t> raw)
+        {
+            size_t count = std::min(values.size(), raw.size());
+            for (size_t i = 0; i < count; i++)
+            {
+                raw[i] = values[i].ToRaw();
+            }
+        }
+
+        constexpr BasicMicroAmperes operator+(const BasicMicroAmperes& other) const
+        {
+            BasicMicroAmperes result;
             result.value = this->value + other.value;
             return result;
         }
 
-        constexpr MicroAmperes operator-(const MicroAmperes& other) const
+        constexpr BasicMicroAmperes operator-(const BasicMicroAmperes& other) const
         {
-            MicroAmperes result;
+            BasicMicroAmperes result;
             result.value = this->value - other.value;
             return result;
         }
 
-        constexpr MicroAmperes& operator+=(const MicroAmperes& other)
+        constexpr BasicMicroAmperes& operator+=(const BasicMicroAmperes& other)
         {
             this->value += other.value;
             return *this;
         }
 
-        constexpr MicroAmperes& operator-=(const MicroAmperes& other)
+        constexpr BasicMicroAmperes& operator-=(const BasicMicroAmperes& other)
         {
             this->value -= other.value;
             return *this;
@@ -65,9 +133,14 @@ namespace PiSubmarine::Max1726
     private:
         int64_t value;
 
-        friend constexpr MicroAmperes operator"" _uA(long double uA);
+        template<int64_t>
+        friend struct BasicMicroAmperes;
     };
 
+    using MicroAmperes = BasicMicroAmperes<>;
+
+    static_assert(sizeof(MicroAmperes) == sizeof(int64_t), "Batch conversions access MicroAmperes as its value member");
+
     // Literal operator for integer microamperes
     constexpr MicroAmperes operator"" _uA(unsigned long long uA)
     {
@@ -77,9 +150,7 @@ namespace PiSubmarine::Max1726
     constexpr MicroAmperes operator"" _uA(long double uA)
     {
         int64_t value = static_cast<int64_t>(uA * (1 << MicroAmperes::BitShift));
-        MicroAmperes result;
-        result.value = value;
-        return result;
+        return MicroAmperes::FromFixedPoint(value);
     }
 
 }
\ No newline at end of file
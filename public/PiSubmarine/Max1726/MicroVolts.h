@@ -1,7 +1,10 @@
 #pragma once
 
+#include "PiSubmarine/Max1726/UnitKernels.h"
+#include <algorithm>
 #include <cstdint>
 #include <limits>
+#include <span>
 
 namespace PiSubmarine::Max1726
 {
@@ -14,6 +17,14 @@ namespace PiSubmarine::Max1726
         // Constructor
         constexpr explicit MicroVolts(uint64_t uV = 0) : value(uV << BitShift) {}
 
+        // Builds from the fixed-point representation, uV << BitShift
+        static constexpr MicroVolts FromFixedPoint(uint64_t fixedPoint)
+        {
+            MicroVolts result;
+            result.value = fixedPoint;
+            return result;
+        }
+
         constexpr uint64_t GetMicroVolts() const
         {
             uint64_t temp = value >> BitShift;
@@ -51,6 +62,22 @@ namespace PiSubmarine::Max1726
             return static_cast<uint16_t>(raw);
         }
 
+        // Batch FromRaw, bit-exact with the scalar one: (raw * 6250 << 1) / 80 == raw * 625 >> 2
+        static void FromRaw(std::span<const uint16_t> raw, std::span<MicroVolts> out)
+        {
+            UnitKernels::Scale<uint16_t, 625, 2>(raw.data(), out.data(), std::min(raw.size(), out.size()));
+        }
+
+        // Batch ToRaw. A plain loop on purpose, see UnitKernels
+        static void ToRaw(std::span<const MicroVolts> values, std::span<uint16_t> raw)
+        {
+            size_t count = std::min(values.size(), raw.size());
+            for (size_t i = 0; i < count; i++)
+            {
+                raw[i] = values[i].ToRaw();
+            }
+        }
+
         // Arithmetic operators
         constexpr MicroVolts operator+(const MicroVolts& other) const
         {
@@ -84,6 +111,8 @@ namespace PiSubmarine::Max1726
         friend constexpr MicroVolts operator"" _uV(long double uV);
     };
 
+    static_assert(sizeof(MicroVolts) == sizeof(uint64_t), "Batch conversions access MicroVolts as its value member");
+
     constexpr MicroVolts operator"" _uV(unsigned long long uV)
     {
         return MicroVolts(static_cast<uint64_t>(uV));
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "PiSubmarine/Max1726/MicroAmperes.h"
+#include "PiSubmarine/Max1726/UnitKernels.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+namespace PiSubmarine::Max1726
+{
+    // Power in uW. Positive while charging, like current. The gauge computes it from the voltage across the sense resistor
+    template<int64_t RSense = DefaultRSenseMicroOhms>
+    struct BasicMicroWatts
+    {
+        static_assert(RSense > 0, "Sense resistor must be positive");
+
+        constexpr static size_t BitShift = 0;
+        constexpr static int64_t RSenseMicroOhms = RSense;
+
+        // 8 mV^2 per LSB, in uV^2 * 1e-6, scaled to the internal representation
+        constexpr static int64_t RawScaleNumerator = 8000000LL << BitShift;
+
+        // Internal value per LSB when the sense resistor divides the scale. Conversions then fold to one multiply or divide
+        constexpr static bool IsExactScale = RawScaleNumerator % RSense == 0;
+        constexpr static int64_t RawScale = RawScaleNumerator / RSense;
+
+        // Constructor
+        constexpr explicit BasicMicroWatts(int64_t uW = 0) : value(uW << BitShift) {}
+
+        // Same physical power, only the raw scaling differs
+        template<int64_t OtherRSense>
+        constexpr BasicMicroWatts(const BasicMicroWatts<OtherRSense>& other) : value(other.value) {}
+
+        // Builds from the fixed-point representation, uW << BitShift
+        static constexpr BasicMicroWatts FromFixedPoint(int64_t fixedPoint)
+        {
+            BasicMicroWatts result;
+            result.value = fixedPoint;
+            return result;
+        }
+
+        constexpr int64_t GetMicroWatts() const
+        {
+            return value >> BitShift;
+        }
+
+        constexpr int64_t GetMilliWatts() const
+        {
+            return GetMicroWatts() / 1000;
+        }
+
+        // Convert from Power or AvgPower register, 0.8 mW per LSB with 0.010 Ohm
+        static constexpr BasicMicroWatts FromRaw(int16_t raw)
+        {
+            BasicMicroWatts result;
+            if constexpr (IsExactScale)
+            {
+                result.value = static_cast<int64_t>(raw) * RawScale;
+            }
+            else
+            {
+                result.value = (static_cast<int64_t>(raw) * RawScaleNumerator) / RSense;
+            }
+            return result;
+        }
+
+        constexpr int16_t ToRaw() const
+        {
+            int64_t raw;
+            if constexpr (IsExactScale)
+            {
+                raw = value / RawScale;
+            }
+            else
+            {
+                // Rounded to nearest, so ToRaw(FromRaw(raw)) == raw even though FromRaw truncates
+                int64_t scaled = value * RSense;
+                raw = (scaled + (scaled < 0 ? -RawScaleNumerator : RawScaleNumerator) / 2) / RawScaleNumerator;
+            }
+            return static_cast<int16_t>(raw);
+        }
+
+        // Batch FromRaw, bit-exact with the scalar one
+        static void FromRaw(std::span<const int16_t> raw, std::span<BasicMicroWatts> out)
+        {
+            size_t count = std::min(raw.size(), out.size());
+            if constexpr (IsExactScale && RawScale * 65535 <= INT32_MAX)
+            {
+                UnitKernels::Scale<int16_t, static_cast<int32_t>(RawScale)>(raw.data(), out.data(), count);
+            }
+            else
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    out[i] = FromRaw(raw[i]);
+                }
+            }
+        }
+
+        // Batch ToRaw. A plain loop on purpose, see UnitKernels
+        static void ToRaw(std::span<const BasicMicroWatts> values, std::span<int16_t> raw)
+        {
+            size_t count = std::min(values.size(), raw.size());
+            for (size_t i = 0; i < count; i++)
+            {
+                raw[i] = values[i].ToRaw();
+            }
+        }
+
+        constexpr BasicMicroWatts operator+(const BasicMicroWatts& other) const
+        {
+            BasicMicroWatts result;
+            result.value = this->value + other.value;
+            return result;
+        }
+
+        constexpr BasicMicroWatts operator-(const BasicMicroWatts& other) const
+        {
+            BasicMicroWatts result;
+            result.value = this->value - other.value;
+            return result;
+        }
+
+        constexpr BasicMicroWatts& operator+=(const BasicMicroWatts& other)
+        {
+            this->value += other.value;
+            return *this;
+        }
+
+        constexpr BasicMicroWatts& operator-=(const BasicMicroWatts& other)
+        {
+            this->value -= other.value;
+            return *this;
+        }
+
+    private:
+        int64_t value;
+
+        template<int64_t>
+        friend struct BasicMicroWatts;
+    };
+
+    using MicroWatts = BasicMicroWatts<>;
+
+    static_assert(sizeof(MicroWatts) == sizeof(int64_t), "Batch conversions access MicroWatts as its value member");
+
+    // Literal operator for integer microwatts
+    constexpr MicroWatts operator"" _uW(unsigned long long uW)
+    {
+        return MicroWatts(static_cast<int64_t>(uW));
+    }
+
+}
@@ -1,7 +1,10 @@
 #pragma once
 
+#include "PiSubmarine/Max1726/UnitKernels.h"
+#include <algorithm>
 #include <cstdint>
 #include <limits>
+#include <span>
 
 struct MilliCelsius
 {
@@ -10,6 +13,14 @@ struct MilliCelsius
     // Constructor
     constexpr explicit MilliCelsius(int64_t mC = 0) : value(mC << BitShift) {}
 
+    // Builds from the fixed-point representation, mC << BitShift
+    static constexpr MilliCelsius FromFixedPoint(int64_t fixedPoint)
+    {
+        MilliCelsius result;
+        result.value = fixedPoint;
+        return result;
+    }
+
     constexpr int64_t GetMilliCelsius() const
     {
         return value >> BitShift;
@@ -32,6 +43,23 @@ struct MilliCelsius
     }
 
 
+    // Batch FromRaw, bit-exact with the scalar one
+    static void FromRaw(std::span<const int16_t> raw, std::span<MilliCelsius> out)
+    {
+        namespace Kernels = PiSubmarine::Max1726::UnitKernels;
+        Kernels::Scale<int16_t, (1000 << BitShift) / 256>(raw.data(), out.data(), std::min(raw.size(), out.size()));
+    }
+
+    // Batch ToRaw. A plain loop on purpose, see UnitKernels
+    static void ToRaw(std::span<const MilliCelsius> values, std::span<int16_t> raw)
+    {
+        size_t count = std::min(values.size(), raw.size());
+        for (size_t i = 0; i < count; i++)
+        {
+            raw[i] = values[i].ToRaw();
+        }
+    }
+
     // Arithmetic operators
     constexpr MilliCelsius operator+(const MilliCelsius& other) const
     {
@@ -65,6 +93,8 @@ private:
     int64_t value;
 };
 
+static_assert(sizeof(MilliCelsius) == sizeof(int64_t), "Batch conversions access MilliCelsius as its value member");
+
 // Integer literal: 25375_mC
 constexpr MilliCelsius operator"" _mC(unsigned long long mC)
 {
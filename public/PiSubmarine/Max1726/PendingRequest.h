@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+
+namespace PiSubmarine::Max1726
+{
+	enum class RequestResult : uint8_t
+	{
+		None,
+		Pending,
+		Succeeded,
+		Failed
+	};
+
+	/// <summary>
+	/// Single request a non-blocking state machine keeps in flight on the device. Its outcome is taken from its own completion,
+	/// so other requests sharing the device neither hold it up nor leak their errors into it.
+	/// The device refers to the completion until the request finishes, so the owner must outlive it.
+	/// </summary>
+	template<typename DeviceType>
+	class PendingRequest
+	{
+	public:
+		/// <summary>
+		/// Completion to pass to the device call that starts the request.
+		/// </summary>
+		typename DeviceType::Completion& GetCompletion()
+		{
+			return m_Completion;
+		}
+
+		/// <summary>
+		/// Records whether the device call queued the request. A request that was not queued leaves nothing pending, so the caller can simply retry it.
+		/// </summary>
+		/// <returns>isQueued</returns>
+		bool Track(bool isQueued)
+		{
+			if (isQueued)
+			{
+				m_IsPending = true;
+				m_IsDiscarded = false;
+			}
+			return isQueued;
+		}
+
+		/// <summary>
+		/// Tracks the request and moves the owner to its next phase once queued. If the queue is full the phase is kept, so the owner retries it on the next step.
+		/// </summary>
+		template<typename PhaseType>
+		void Track(bool isQueued, PhaseType& phase, PhaseType next)
+		{
+			if (Track(isQueued))
+			{
+				phase = next;
+			}
+		}
+
+		/// <summary>
+		/// Drops the outcome of the request in flight, e.g. when its owner restarts. Poll() keeps returning Pending until it finishes.
+		/// </summary>
+		void Discard()
+		{
+			m_IsDiscarded = m_IsPending;
+		}
+
+		/// <summary>
+		/// Never blocks. Reports the outcome once: Succeeded or Failed on the first call after the request finished, None afterwards or if it was discarded.
+		/// </summary>
+		RequestResult Poll()
+		{
+			if (!m_IsPending)
+			{
+				return RequestResult::None;
+			}
+
+			if (!m_Completion.IsDone())
+			{
+				return RequestResult::Pending;
+			}
+
+			m_IsPending = false;
+			if (m_IsDiscarded)
+			{
+				m_IsDiscarded = false;
+				return RequestResult::None;
+			}
+			return m_Completion.IsOk() ? RequestResult::Succeeded : RequestResult::Failed;
+		}
+
+	private:
+		typename DeviceType::Completion m_Completion;
+		bool m_IsPending = false;
+		bool m_IsDiscarded = false;
+	};
+}
@@ -0,0 +1,447 @@
+#pragma once
+
+#include "PiSubmarine/Max1726/Max1726.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+namespace PiSubmarine::Max1726
+{
+	enum class GaugeMode : uint8_t
+	{
+		Active,
+		Hibernate
+	};
+
+	template<typename Clock = std::chrono::steady_clock>
+	struct PollGroupStats
+	{
+		uint64_t Issued = 0;
+		uint64_t Completed = 0;
+		uint64_t Failed = 0;
+
+		/// <summary>
+		/// Number of periods that elapsed without the group being read.
+		/// </summary>
+		uint64_t MissedDeadlines = 0;
+		typename Clock::time_point FirstIssueTime{};
+		typename Clock::time_point LastIssueTime{};
+
+		/// <summary>
+		/// Returns average number of reads per second issued for the group.
+		/// </summary>
+		double GetAchievedRate() const
+		{
+			if (Issued < 2)
+			{
+				return 0.0;
+			}
+			std::chrono::duration<double> elapsed = LastIssueTime - FirstIssueTime;
+			return elapsed.count() > 0 ? static_cast<double>(Issued - 1) / elapsed.count() : 0.0;
+		}
+	};
+
+	/// <summary>
+	/// Non-blocking multi-rate register poller. Every group of contiguous registers is read with its own period.
+	/// Driven by Tick() or by the internal thread started with Start(). Groups can be added and configured from any thread, also while the thread runs.
+	/// With cadence tracking enabled no group is read faster than the gauge updates, in active or hibernate mode.
+	/// Each read is judged by its own completion, so other requests on the device neither hold up polling nor count as group failures.
+	/// The device refers to that completion until the read finishes, so the poller must outlive its last read.
+	/// </summary>
+	template<typename DeviceType, typename Clock = std::chrono::steady_clock>
+	class Poller
+	{
+	public:
+		using Duration = typename Clock::duration;
+		using TimePoint = typename Clock::time_point;
+
+		Poller(DeviceType& device) : m_Device(device)
+		{
+
+		}
+
+		~Poller()
+		{
+			Stop();
+		}
+
+		/// <summary>
+		/// Adds a group of contiguous registers read in a single burst.
+		/// </summary>
+		/// <returns>Group index</returns>
+		size_t AddGroup(RegOffset first, RegOffset last, Duration period)
+		{
+			std::lock_guard lock(m_Mutex);
+			m_Groups.push_back(Group{ first, last, period, false });
+			return m_Groups.size() - 1;
+		}
+
+		/// <summary>
+		/// Adds a group acquired with Device::ReadTelemetry, so each read publishes a TelemetrySnapshot.
+		/// </summary>
+		/// <returns>Group index</returns>
+		size_t AddTelemetryGroup(Duration period)
+		{
+			std::lock_guard lock(m_Mutex);
+			m_Groups.push_back(Group{ DeviceType::TelemetryFirst, DeviceType::TelemetryLast, period, true });
+			return m_Groups.size() - 1;
+		}
+
+		void SetPeriod(size_t group, Duration period)
+		{
+			std::lock_guard lock(m_Mutex);
+			m_Groups[group].Period = period;
+		}
+
+		Duration GetPeriod(size_t group) const
+		{
+			std::lock_guard lock(m_Mutex);
+			return m_Groups[group].Period;
+		}
+
+		/// <summary>
+		/// Returns a consistent copy of the group statistics.
+		/// </summary>
+		PollGroupStats<Clock> GetStats(size_t group) const
+		{
+			std::lock_guard lock(m_Mutex);
+			return m_Groups[group].Stats;
+		}
+
+		size_t GetGroupCount() const
+		{
+			std::lock_guard lock(m_Mutex);
+			return m_Groups.size();
+		}
+
+		/// <summary>
+		/// Follows the gauge between active and hibernate mode and stretches every group to at least the gauge task period.
+		/// The mode is inferred like the gauge decides it, from HibCfg, FullCapRep and the Current of every telemetry group read.
+		/// The poller reads HibCfg and FullCapRep itself, ahead of the groups, and keeps the values; until both are read the gauge is assumed to stay active.
+		/// Call again after changing HibCfg to have it read anew. Groups covering either register refresh the kept values as well.
+		/// A current above the hibernate threshold brings back the configured periods on the next Tick().
+		/// When disabled, groups go back to their configured period after their next read.
+		/// </summary>
+		void SetCadenceTracking(bool value)
+		{
+			std::lock_guard lock(m_Mutex);
+			m_IsCadenceTracking = value;
+			m_IsBelowThreshold = false;
+			m_Mode = GaugeMode::Active;
+			m_HibernationConfig.reset();
+			m_FullCapacity.reset();
+		}
+
+		bool IsCadenceTracking() const
+		{
+			std::lock_guard lock(m_Mutex);
+			return m_IsCadenceTracking;
+		}
+
+		GaugeMode GetGaugeMode() const
+		{
+			std::lock_guard lock(m_Mutex);
+			return m_Mode;
+		}
+
+		/// <summary>
+		/// Returns the task period of the gauge in its present mode.
+		/// </summary>
+		Duration GetTaskPeriod() const
+		{
+			std::lock_guard lock(m_Mutex);
+			return TaskPeriod();
+		}
+
+		/// <summary>
+		/// Returns the period the group is read with: the configured one, or the gauge task period if that is longer and cadence tracking is on.
+		/// </summary>
+		Duration GetEffectivePeriod(size_t group) const
+		{
+			std::lock_guard lock(m_Mutex);
+			return EffectivePeriod(m_Groups[group]);
+		}
+
+		/// <summary>
+		/// Collects result of the previous read and starts the most overdue read, if any. Never blocks.
+		/// </summary>
+		/// <param name="now">Current time</param>
+		/// <returns>True if a new transaction was started.</returns>
+		bool Tick(TimePoint now)
+		{
+			std::lock_guard lock(m_Mutex);
+			if (m_PendingGroup)
+			{
+				if (!m_Completion.IsDone())
+				{
+					return false;
+				}
+
+				Group& pending = m_Groups[*m_PendingGroup];
+				if (m_Completion.IsOk())
+				{
+					pending.Stats.Completed++;
+					KeepCadenceRegisters(pending.First, pending.Last);
+					TrackGaugeMode(pending, now);
+				}
+				else
+				{
+					pending.Stats.Failed++;
+				}
+				m_PendingGroup.reset();
+			}
+
+			if (m_PendingCadenceRead)
+			{
+				if (!m_Completion.IsDone())
+				{
+					return false;
+				}
+
+				if (m_Completion.IsOk())
+				{
+					KeepCadenceRegisters(*m_PendingCadenceRead, *m_PendingCadenceRead);
+				}
+				m_PendingCadenceRead.reset();
+			}
+
+			if (m_IsCadenceTracking && (!m_HibernationConfig || !m_FullCapacity))
+			{
+				RegOffset reg = m_HibernationConfig ? RegOffset::FullCapRep : RegOffset::HibCfg;
+				if (m_Device.Read(reg, m_Completion))
+				{
+					m_PendingCadenceRead = reg;
+					return true;
+				}
+				return false;
+			}
+
+			std::optional<size_t> next;
+			for (size_t i = 0; i < m_Groups.size(); i++)
+			{
+				Group& group = m_Groups[i];
+				if (!group.IsScheduled)
+				{
+					group.NextDue = now;
+					group.IsScheduled = true;
+				}
+
+				if (group.NextDue > now)
+				{
+					continue;
+				}
+
+				if (!next || group.NextDue < m_Groups[*next].NextDue)
+				{
+					next = i;
+				}
+			}
+
+			if (!next)
+			{
+				return false;
+			}
+
+			Group& group = m_Groups[*next];
+			bool started = group.IsTelemetry ? m_Device.ReadTelemetry(m_Completion) : m_Device.Read(group.First, group.Last, m_Completion);
+			if (!started)
+			{
+				return false;
+			}
+
+			if (group.Stats.Issued == 0)
+			{
+				group.Stats.FirstIssueTime = now;
+			}
+			group.Stats.Issued++;
+			group.Stats.LastIssueTime = now;
+
+			Duration period = EffectivePeriod(group);
+			uint64_t missed = period.count() > 0 ? static_cast<uint64_t>((now - group.NextDue) / period) : 0;
+			group.Stats.MissedDeadlines += missed;
+			group.NextDue += period * (missed + 1);
+			m_PendingGroup = next;
+			return true;
+		}
+
+		/// <summary>
+		/// Returns time at which the next group becomes due. TimePoint::min() if a group was added but not scheduled by Tick() yet,
+		/// as it is due right away; TimePoint::max() if there are no groups.
+		/// </summary>
+		TimePoint GetNextDue() const
+		{
+			std::lock_guard lock(m_Mutex);
+			TimePoint nextDue = TimePoint::max();
+			for (const auto& group : m_Groups)
+			{
+				if (!group.IsScheduled)
+				{
+					return TimePoint::min();
+				}
+				nextDue = std::min(nextDue, group.NextDue);
+			}
+			return nextDue;
+		}
+
+		/// <summary>
+		/// Starts internal thread calling Tick() every tickPeriod.
+		/// </summary>
+		void Start(std::chrono::microseconds tickPeriod)
+		{
+			Stop();
+			m_Thread = std::jthread([this, tickPeriod](std::stop_token st) {
+				while (!st.stop_requested())
+				{
+					Tick(Clock::now());
+					std::this_thread::sleep_for(tickPeriod);
+				}
+				});
+		}
+
+		void Stop()
+		{
+			if (m_Thread.joinable())
+			{
+				m_Thread.request_stop();
+				m_Thread.join();
+			}
+		}
+
+	private:
+		struct Group
+		{
+			RegOffset First;
+			RegOffset Last;
+			Duration Period;
+			bool IsTelemetry = false;
+			bool IsScheduled = false;
+			TimePoint NextDue{};
+			PollGroupStats<Clock> Stats;
+		};
+
+		struct HibernationConfig
+		{
+			bool IsEnabled = false;
+			uint8_t Scalar = 0;
+			uint8_t Threshold = 0;
+			uint8_t EnterTime = 0;
+		};
+
+		DeviceType& m_Device;
+		mutable std::mutex m_Mutex;
+		std::vector<Group> m_Groups;
+		std::optional<size_t> m_PendingGroup;
+		std::optional<RegOffset> m_PendingCadenceRead;
+		typename DeviceType::Completion m_Completion;
+		std::jthread m_Thread;
+		bool m_IsCadenceTracking = false;
+		GaugeMode m_Mode = GaugeMode::Active;
+		bool m_IsBelowThreshold = false;
+		TimePoint m_BelowThresholdSince{};
+		std::optional<HibernationConfig> m_HibernationConfig;
+		std::optional<typename DeviceType::MicroAmpereHoursType> m_FullCapacity;
+
+		Duration TaskPeriod() const
+		{
+			if (m_Mode == GaugeMode::Active)
+			{
+				return std::chrono::duration_cast<Duration>(ActiveTaskPeriod);
+			}
+			uint8_t scalar = m_HibernationConfig ? m_HibernationConfig->Scalar : 0;
+			return std::chrono::duration_cast<Duration>(HibernateTaskPeriod * (1 << scalar));
+		}
+
+		Duration EffectivePeriod(const Group& group) const
+		{
+			return m_IsCadenceTracking ? std::max(group.Period, TaskPeriod()) : group.Period;
+		}
+
+		/// <summary>
+		/// Keeps HibCfg and FullCapRep if the read that just completed covered them. Taken right after the poller's own read,
+		/// so the Tick() thread never looks at them while a later read may be unpacking into the shadow registers.
+		/// </summary>
+		void KeepCadenceRegisters(RegOffset first, RegOffset last)
+		{
+			if (first <= RegOffset::HibCfg && last >= RegOffset::HibCfg)
+			{
+				m_HibernationConfig = HibernationConfig{ m_Device.IsHibernationEnabled(), m_Device.GetHibScalar(), m_Device.GetHibThreshold(), m_Device.GetHibEnterTime() };
+			}
+			if (first <= RegOffset::FullCapRep && last >= RegOffset::FullCapRep)
+			{
+				m_FullCapacity = m_Device.GetEstimatedFullCapacity();
+			}
+		}
+
+		/// <summary>
+		/// Updates the gauge mode from a telemetry group that just completed, using the Current of the published snapshot. Entering hibernate is timed from the first read below the threshold,
+		/// so the host switches late rather than early; leaving it is immediate, ahead of the gauge's own exit time.
+		/// </summary>
+		void TrackGaugeMode(const Group& group, TimePoint now)
+		{
+			if (!m_IsCadenceTracking || !group.IsTelemetry)
+			{
+				return;
+			}
+
+			if (!m_HibernationConfig || !m_FullCapacity || !m_HibernationConfig->IsEnabled)
+			{
+				m_IsBelowThreshold = false;
+				SetGaugeMode(GaugeMode::Active, now);
+				return;
+			}
+
+			// FullCap / 0.8 h / 2^HibThreshold
+			int64_t threshold = static_cast<int64_t>(m_FullCapacity->GetMicroAmpereHours() * 5 / 4) >> m_HibernationConfig->Threshold;
+			int64_t current = m_Device.GetTelemetry().Current.GetMicroAmperes();
+			if (current >= threshold || current <= -threshold)
+			{
+				m_IsBelowThreshold = false;
+				SetGaugeMode(GaugeMode::Active, now);
+				return;
+			}
+
+			if (!m_IsBelowThreshold)
+			{
+				m_IsBelowThreshold = true;
+				m_BelowThresholdSince = now;
+			}
+
+			auto enterTime = std::chrono::duration_cast<Duration>(HibernateEnterStep * ((1 << m_HibernationConfig->EnterTime) - 1));
+			if (now - m_BelowThresholdSince >= enterTime)
+			{
+				SetGaugeMode(GaugeMode::Hibernate, now);
+			}
+		}
+
+		/// <summary>
+		/// Switches mode. When the gauge wakes up, groups waiting out a hibernate period are brought back to their own period.
+		/// </summary>
+		void SetGaugeMode(GaugeMode mode, TimePoint now)
+		{
+			if (mode == m_Mode)
+			{
+				return;
+			}
+
+			m_Mode = mode;
+			if (mode != GaugeMode::Active)
+			{
+				return;
+			}
+
+			for (auto& group : m_Groups)
+			{
+				if (group.IsScheduled && group.Stats.Issued > 0)
+				{
+					group.NextDue = std::min(group.NextDue, std::max(now, group.Stats.LastIssueTime + group.Period));
+				}
+			}
+		}
+	};
+}
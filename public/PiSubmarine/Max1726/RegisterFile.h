@@ -0,0 +1,177 @@
+#pragma once
+
+#include "PiSubmarine/RegUtils.h"
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace PiSubmarine::Max1726
+{
+	constexpr static size_t RegisterSize = 2;
+	constexpr static size_t RegisterCount = 256;
+	constexpr static size_t MemorySize = RegisterCount * RegisterSize;
+
+	template<typename Clock = std::chrono::steady_clock>
+	struct Register
+	{
+		uint16_t Value = 0;
+
+		/// <summary>
+		/// True once the value has been read from the device at least once.
+		/// </summary>
+		bool IsValid = false;
+
+		/// <summary>
+		/// True if the value was modified locally and not yet written to the device.
+		/// </summary>
+		bool IsDirty = false;
+
+		typename Clock::time_point LastReadTime{};
+	};
+
+	/// <summary>
+	/// Shadow copy of the MAX1726 register map. One 16-bit entry per register offset.
+	/// </summary>
+	template<typename Clock = std::chrono::steady_clock>
+	class RegisterFile
+	{
+	public:
+		using Entry = Register<Clock>;
+
+		const Entry& operator[](size_t offset) const
+		{
+			return m_Registers[offset];
+		}
+
+		Entry& operator[](size_t offset)
+		{
+			return m_Registers[offset];
+		}
+
+		uint16_t GetValue(size_t offset) const
+		{
+			return m_Registers[offset].Value;
+		}
+
+		/// <summary>
+		/// Sets the raw register value and marks it dirty.
+		/// </summary>
+		void SetValue(size_t offset, uint16_t value)
+		{
+			m_Registers[offset].Value = value;
+			m_Registers[offset].IsDirty = true;
+		}
+
+		template<typename T>
+		T ReadField(size_t offset, size_t bitOffset, size_t bitLength) const
+		{
+			std::array<uint8_t, RegisterSize> bytes = ToBytes(m_Registers[offset].Value);
+			return RegUtils::Read<T, std::endian::little>(bytes.data(), bitOffset, bitLength);
+		}
+
+		/// <summary>
+		/// Writes a bit field of the register and marks it dirty.
+		/// </summary>
+		template<typename T>
+		void WriteField(size_t offset, T value, size_t bitOffset, size_t bitLength)
+		{
+			std::array<uint8_t, RegisterSize> bytes = ToBytes(m_Registers[offset].Value);
+			RegUtils::Write<T, std::endian::little>(value, bytes.data(), bitOffset, bitLength);
+			SetValue(offset, FromBytes(bytes.data()));
+		}
+
+		bool HasDirty() const
+		{
+			for (const auto& reg : m_Registers)
+			{
+				if (reg.IsDirty)
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		/// <summary>
+		/// Finds the next run of adjacent dirty registers.
+		/// </summary>
+		/// <param name="from">Offset to start searching at</param>
+		/// <param name="first">Offset of the first register in the run</param>
+		/// <param name="count">Number of registers in the run</param>
+		/// <returns>False if no dirty register was found.</returns>
+		bool FindDirtyRun(size_t from, size_t& first, size_t& count) const
+		{
+			for (size_t i = from; i < RegisterCount; i++)
+			{
+				if (!m_Registers[i].IsDirty)
+				{
+					continue;
+				}
+
+				first = i;
+				count = 1;
+				while (i + count < RegisterCount && m_Registers[i + count].IsDirty)
+				{
+					count++;
+				}
+				return true;
+			}
+			return false;
+		}
+
+		/// <summary>
+		/// Stores registers received from the device in little-endian byte order.
+		/// </summary>
+		/// <param name="first">Offset of the first register</param>
+		/// <param name="data">Received bytes, RegisterSize bytes per register</param>
+		/// <param name="count">Number of registers</param>
+		/// <param name="time">Time of reception</param>
+		void Unpack(size_t first, const uint8_t* data, size_t count, typename Clock::time_point time)
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				Entry& reg = m_Registers[first + i];
+				reg.Value = FromBytes(data + i * RegisterSize);
+				reg.IsValid = true;
+				reg.IsDirty = false;
+				reg.LastReadTime = time;
+			}
+		}
+
+		/// <summary>
+		/// Serializes registers into little-endian byte order as expected by the device.
+		/// </summary>
+		void Pack(size_t first, uint8_t* data, size_t count) const
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				std::array<uint8_t, RegisterSize> bytes = ToBytes(m_Registers[first + i].Value);
+				data[i * RegisterSize] = bytes[0];
+				data[i * RegisterSize + 1] = bytes[1];
+			}
+		}
+
+		void ClearDirty(size_t first, size_t count)
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				m_Registers[first + i].IsDirty = false;
+			}
+		}
+
+	private:
+		std::array<Entry, RegisterCount> m_Registers{};
+
+		static std::array<uint8_t, RegisterSize> ToBytes(uint16_t value)
+		{
+			return { static_cast<uint8_t>(value & 0xFF), static_cast<uint8_t>(value >> 8) };
+		}
+
+		static uint16_t FromBytes(const uint8_t* data)
+		{
+			return static_cast<uint16_t>(data[0] | (data[1] << 8));
+		}
+	};
+}
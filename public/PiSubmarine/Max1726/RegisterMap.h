@@ -0,0 +1,669 @@
+#pragma once
+
+#include "PiSubmarine/Max1726/MicroAmpereHours.h"
+#include "PiSubmarine/Max1726/MicroAmperes.h"
+#include "PiSubmarine/Max1726/MicroVolts.h"
+#include "PiSubmarine/Max1726/MicroWatts.h"
+#include "PiSubmarine/Max1726/MilliCelcius.h"
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <concepts>
+#include <optional>
+
+namespace PiSubmarine::Max1726
+{
+	enum class RegOffset : uint8_t
+	{
+		Status = 0x00,
+		VAlrtTh = 0x01,
+		TAlrtTh = 0x02,
+		SAlrtTh = 0x03,
+		AtRate = 0x04,
+		RepCap = 0x05,
+		RepSOC = 0x06,
+		Age = 0x07,
+		Temp = 0x08,
+		VCell = 0x09,
+		Current = 0x0A,
+		AvgCurrent = 0x0B,
+		QResidual = 0x0C,
+		MixSOC = 0x0D,
+		AvSOC = 0x0E,
+		MixCap = 0x0F,
+		FullCapRep = 0x10,
+		TTE = 0x11,
+		QRTable00 = 0x12,
+		FullSocThr = 0x13,
+		RCell = 0x14,
+		AvgTA = 0x16,
+		Cycles = 0x17,
+		DesignCap = 0x18,
+		AvgVCell = 0x19,
+		MaxMinTemp = 0x1A,
+		MaxMinVolt = 0x1B,
+		MaxMinCurr = 0x1C,
+		Config = 0x1D,
+		IChgTerm = 0x1E,
+		TTF = 0x20,
+		DevName = 0x21,
+		QRTable10 = 0x22,
+		FullCapNom = 0x23,
+		AIN = 0x27,
+		LearnCfg = 0x28,
+		FilterCfg = 0x29,
+		RelaxCfg = 0x2A,
+		MiscCfg = 0x2B,
+		TGain = 0x2C,
+		TOff = 0x2D,
+		CGain = 0x2E,
+		COff = 0x2F,
+		QRTable20 = 0x32,
+		DieTemp = 0x34,
+		FullCap = 0x35,
+		RComp0 = 0x38,
+		TempCo = 0x39,
+		VEmpty = 0x3A,
+		FStat = 0x3D,
+		Timer = 0x3E,
+		ShdnTimer = 0x3F,
+		QRTable30 = 0x42,
+		RGain = 0x43,
+		dQAcc = 0x45,
+		dPAcc = 0x46,
+		ConvgCfg = 0x49,
+		VFRemCap = 0x4A,
+		QH = 0x4D,
+		Command = 0x60,
+		Status2 = 0xB0,
+		Power = 0xB1,
+		ID = 0xB2,
+		AvgPower = 0xB3,
+		IAlrtTh = 0xB4,
+		TTFCfg = 0xB5,
+		CVMixCap = 0xB6,
+		CVHalfTime = 0xB7,
+		CGTempCo = 0xB8,
+		Curve = 0xB9,
+		HibCfg = 0xBA,
+		Config2 = 0xBB,
+		VRipple = 0xBC,
+		RippleCfg = 0xBD,
+		TimerH = 0xBE,
+		RSense = 0xD0,
+		ScOcvLim = 0xD1,
+		VGain = 0xD2,
+		SOCHold = 0xD3,
+		MaxPeakPower = 0xD4,
+		SusPeakPower = 0xD5,
+		PackResistance = 0xD6,
+		SysResistance = 0xD7,
+		MinSysVoltage = 0xD8,
+		MPPCurrent = 0xD9,
+		SPPCurrent = 0xDA,
+		ModelCfg = 0xDB,
+		AtQResidual = 0xDC,
+		AtTTE = 0xDD,
+		AtAvSOC = 0xDE,
+		AtAvCap = 0xDF
+	};
+
+	enum class Status : uint16_t
+	{
+		PowerOnReset = (1 << 1),
+		MinimumCurrentAlert = (1 << 2),
+		BatteryPresent = (1 << 3),
+		MaximumCurrentAlert = (1 << 6),
+		StateOfChargeChanged = (1 << 7),
+		MinimumVoltageAlert = (1 << 8),
+		MinimumTemperatureAlert = (1 << 9),
+		MinimumStateOfCharge = (1 << 10),
+		MaximumVoltageAlert = (1 << 12),
+		MaximumTemperatureAlert = (1 << 13),
+		MaximumStateOfChargeAlert = (1 << 14),
+		BatteryRemoved = (1 << 15)
+	};
+
+	enum class FStat : uint16_t
+	{
+		DataNotReady = (1 << 0),
+		RelaxedCellDetectionLong = (1 << 6),
+		FullQualified = (1 << 7),
+		EmptyDetection = (1 << 8),
+		RelaxedCellDetectionShort = (1 << 9)
+	};
+
+	/// <summary>
+	/// MAX1726 updates its outputs once per task period while in active mode.
+	/// </summary>
+	constexpr static std::chrono::microseconds ActiveTaskPeriod{ 175781 };
+
+	/// <summary>
+	/// Task period in hibernate mode is HibernateTaskPeriod * 2^HibScalar.
+	/// </summary>
+	constexpr static std::chrono::microseconds HibernateTaskPeriod{ 351562 };
+
+	/// <summary>
+	/// Hibernate enter time is (2^HibEnterTime - 1) * HibernateEnterStep.
+	/// </summary>
+	constexpr static std::chrono::microseconds HibernateEnterStep{ 5625000 };
+
+	enum class Command : uint16_t
+	{
+		Clear = 0,
+		Reset = 0x0F,
+		SoftWakeup = 0x0090
+	};
+
+	enum class ModelId : uint8_t
+	{
+		Li = 0,
+		NcrOrNca = 2,
+		LiFePo = 6
+	};
+
+	enum class ConfigFlags : uint16_t
+	{
+		BatteryRemoved = (1 << 0),
+		BatteryInserted = (1 << 1),
+		AlertEnable = (1 << 2),
+		ForceThermistorBias = (1 << 3),
+		EnableThermistor = (1 << 4),
+		CommShutdown = (1 << 6),
+		Shutdown = (1 << 7),
+		TemperatureExternal = (1 << 8),
+		EnableTemperatureChannel = (1 << 9),
+		ThPinShutdown = (1 << 10),
+		CurrentAlertSticky = (1 << 11),
+		VoltageAlertSticky = (1 << 12),
+		TemperatureAlertSticky = (1 << 13),
+		SocAlertSticky = (1 << 14),
+		TSel = (1 << 15)
+	};
+
+	enum class RegisterAccess : uint8_t
+	{
+		Read = (1 << 0),
+		Write = (1 << 1),
+
+		/// <summary>
+		/// Value is updated by the gauge itself, shadow copy goes stale.
+		/// </summary>
+		Changing = (1 << 2),
+
+		/// <summary>
+		/// Cell characterization the gauge learns over time. Lost on power-on reset.
+		/// </summary>
+		Learning = (1 << 3),
+
+		ReadOnly = Read | Changing,
+		WriteOnly = Write,
+		ReadWrite = Read | Write,
+		Volatile = Read | Write | Changing,
+		Learned = Read | Write | Changing | Learning
+	};
+
+	constexpr bool HasAccess(RegisterAccess access, RegisterAccess flags)
+	{
+		return (static_cast<uint8_t>(access) & static_cast<uint8_t>(flags)) == static_cast<uint8_t>(flags);
+	}
+
+	struct RegisterDescriptor
+	{
+		RegOffset Offset;
+		RegisterAccess Access;
+
+		/// <summary>
+		/// Power-on value where documented for MAX17260, zero otherwise.
+		/// </summary>
+		uint16_t ResetValue;
+	};
+
+	constexpr static std::array RegisterTable{
+		RegisterDescriptor{ RegOffset::Status, RegisterAccess::Volatile, 0x0002 },
+		RegisterDescriptor{ RegOffset::VAlrtTh, RegisterAccess::ReadWrite, 0xFF00 },
+		RegisterDescriptor{ RegOffset::TAlrtTh, RegisterAccess::ReadWrite, 0x7F80 },
+		RegisterDescriptor{ RegOffset::SAlrtTh, RegisterAccess::ReadWrite, 0xFF00 },
+		RegisterDescriptor{ RegOffset::AtRate, RegisterAccess::ReadWrite, 0x0000 },
+		RegisterDescriptor{ RegOffset::RepCap, RegisterAccess::Volatile, 0x0000 },
+		RegisterDescriptor{ RegOffset::RepSOC, RegisterAccess::ReadOnly, 0x0000 },
+		RegisterDescriptor{ RegOffset::Age, RegisterAccess::ReadOnly, 0x0000 },
+		RegisterDescriptor{ RegOffset::Temp, RegisterAccess::Volatile, 0x0000 },
+		RegisterDescriptor{ RegOffset::VCell, RegisterAccess::ReadOnly, 0x0000 },
+		RegisterDescriptor{ RegOffset::Current, RegisterAccess::ReadOnly, 0x0000 },
+		RegisterDescriptor{ RegOffset::AvgCurrent, RegisterAccess::ReadOnly, 0x0000 },
+		RegisterDescriptor{ RegOffset::QResidual, RegisterAccess::ReadOnly, 0x0000 },
+		RegisterDescriptor{ RegOffset::MixSOC, RegisterAccess::ReadOnly, 0x0000 },
+		RegisterDescriptor{ RegOffset::AvSOC, RegisterAccess::ReadOnly, 0x0000 },
+		RegisterDescriptor{ RegOffset::MixCap, RegisterAccess::Volatile, 0x0000 },
+		RegisterDescriptor{ RegOffset::FullCapRep, RegisterAccess::Learned, 0x0BB8 },
+		RegisterDescriptor{ RegOffset::TTE, RegisterAccess::ReadOnly, 0x0000 },
+		RegisterDescriptor{ RegOffset::QRTable00, RegisterAccess::Learned, 0x0000 },
+		RegisterDescriptor{ RegOffset::FullSocThr, RegisterAccess::ReadWrite, 0x0000 },
+		RegisterDescriptor{ RegOffset::RCell, RegisterAccess::ReadOnly, 0x0000 },
+		RegisterDescriptor{ RegOffset::AvgTA, RegisterAccess::ReadOnly, 0x0000 },
+		RegisterDescriptor{ RegOffset::Cycles, RegisterAccess::Learned, 0x0000 },
+		RegisterDescriptor{ RegOffset::DesignCap, RegisterAccess::ReadWrite, 0x0BB8 },
+		RegisterDescriptor{ RegOffset::AvgVCell, RegisterAccess::ReadOnly, 0x0000 },
+		RegisterDescriptor{ RegOffset::MaxMinTemp, RegisterAccess::Volatile, 0x0000 },
+		RegisterDescriptor{ RegOffset::MaxMinVolt, RegisterAccess::Volatile, 0x0000 },
+		RegisterDescriptor{ RegOffset::MaxMinCurr, RegisterAccess::Volatile, 0x0000 },
+		RegisterDescriptor{ RegOffset::Config, RegisterAccess::ReadWrite, 0x0000 },
+		RegisterDescriptor{ RegOffset::IChgTerm, RegisterAccess::ReadWrite, 0x0640 },
+		RegisterDescriptor{ RegOffset::TTF, RegisterAccess::ReadOnly, 0x0000 },
+		RegisterDescriptor{ RegOffset::DevName, RegisterAccess::ReadOnly, 0x4031 },
+		RegisterDescriptor{ RegOffset::QRTable10, RegisterAccess::Learned, 0x0000 },
+		RegisterDescriptor{ RegOffset::FullCapNom, RegisterAccess::Learned, 0x0BB8 },
+		RegisterDescriptor{ RegOffset::AIN, RegisterAccess::ReadOnly, 0x0000 },
+		RegisterDescriptor{ RegOffset::LearnCfg, RegisterAccess::ReadWrite, 0x0000 },
+		RegisterDescriptor{ RegOffset::FilterCfg, RegisterAccess::ReadWrite, 0x0000 },
+		RegisterDescriptor{ RegOffset::RelaxCfg, RegisterAccess::ReadWrite, 0x0000 },
+		RegisterDescriptor{ RegOffset::MiscCfg, RegisterAccess::ReadWrite, 0x0000 },
+		RegisterDescriptor{ RegOffset::TGain, RegisterAccess::ReadWrite, 0x0000 },
+		RegisterDescriptor{ RegOffset::TOff, RegisterAccess::ReadWrite, 0x0000 },
+		RegisterDescriptor{ RegOffset::CGain, RegisterAccess::ReadWrite, 0x0000 },
+		RegisterDescriptor{ RegOffset::COff, RegisterAccess::ReadWrite, 0x0000 },
+		RegisterDescriptor{ RegOffset::QRTable20, RegisterAccess::Learned, 0x0000 },
+		RegisterDescriptor{ RegOffset::DieTemp, RegisterAccess::ReadOnly, 0x0000 },
+		RegisterDescriptor{ RegOffset::FullCap, RegisterAccess::Volatile, 0x0000 },
+		RegisterDescriptor{ RegOffset::RComp0, RegisterAccess::Learned, 0x0000 },
+		RegisterDescriptor{ RegOffset::TempCo, RegisterAccess::Learned, 0x0000 },
+		RegisterDescriptor{ RegOffset::VEmpty, RegisterAccess::ReadWrite, 0xA561 },
+		RegisterDescriptor{ RegOffset::FStat, RegisterAccess::ReadOnly, 0x0001 },
+		RegisterDescriptor{ RegOffset::Timer, RegisterAccess::Volatile, 0x0000 },
+		RegisterDescriptor{ RegOffset::ShdnTimer, RegisterAccess::ReadWrite, 0x0000 },
+		RegisterDescriptor{ RegOffset::QRTable30, RegisterAccess::Learned, 0x0000 },
+		RegisterDescriptor{ RegOffset::RGain, RegisterAccess::ReadWrite, 0x0000 },
+		RegisterDescriptor{ RegOffset::dQAcc, RegisterAccess::Learned, 0x0000 },
+		RegisterDescriptor{ RegOffset::dPAcc, RegisterAccess::Learned, 0x0000 },
+		RegisterDescriptor{ RegOffset::ConvgCfg, RegisterAccess::ReadWrite, 0x0000 },
+		RegisterDescriptor{ RegOffset::VFRemCap, RegisterAccess::ReadOnly, 0x0000 },
+		RegisterDescriptor{ RegOffset::QH, RegisterAccess::Volatile, 0x0000 },
+		RegisterDescriptor{ RegOffset::Command, RegisterAccess::WriteOnly, 0x0000 },
+		RegisterDescriptor{ RegOffset::Status2, RegisterAccess::Volatile, 0x0000 },
+		RegisterDescriptor{ RegOffset::Power, RegisterAccess::ReadOnly, 0x0000 },
+		RegisterDescriptor{ RegOffset::ID, RegisterAccess::ReadOnly, 0x0000 },
+		RegisterDescriptor{ RegOffset::AvgPower, RegisterAccess::ReadOnly, 0x0000 },
+		RegisterDescriptor{ RegOffset::IAlrtTh, RegisterAccess::ReadWrite, 0x7F80 },
+		RegisterDescriptor{ RegOffset::TTFCfg, RegisterAccess::ReadWrite, 0x0000 },
+		RegisterDescriptor{ RegOffset::CVMixCap, RegisterAccess::Volatile, 0x0000 },
+		RegisterDescriptor{ RegOffset::CVHalfTime, RegisterAccess::Volatile, 0x0000 },
+		RegisterDescriptor{ RegOffset::CGTempCo, RegisterAccess::ReadWrite, 0x0000 },
+		RegisterDescriptor{ RegOffset::Curve, RegisterAccess::ReadWrite, 0x0000 },
+		RegisterDescriptor{ RegOffset::HibCfg, RegisterAccess::ReadWrite, 0x870C },
+		RegisterDescriptor{ RegOffset::Config2, RegisterAccess::ReadWrite, 0x0000 },
+		RegisterDescriptor{ RegOffset::VRipple, RegisterAccess::ReadOnly, 0x0000 },
+		RegisterDescriptor{ RegOffset::RippleCfg, RegisterAccess::ReadWrite, 0x0000 },
+		RegisterDescriptor{ RegOffset::TimerH, RegisterAccess::Volatile, 0x0000 },
+		RegisterDescriptor{ RegOffset::RSense, RegisterAccess::ReadWrite, 0x03E8 },
+		RegisterDescriptor{ RegOffset::ScOcvLim, RegisterAccess::ReadWrite, 0x0000 },
+		RegisterDescriptor{ RegOffset::VGain, RegisterAccess::ReadWrite, 0x0000 },
+		RegisterDescriptor{ RegOffset::SOCHold, RegisterAccess::ReadWrite, 0x0000 },
+		RegisterDescriptor{ RegOffset::MaxPeakPower, RegisterAccess::ReadOnly, 0x0000 },
+		RegisterDescriptor{ RegOffset::SusPeakPower, RegisterAccess::ReadOnly, 0x0000 },
+		RegisterDescriptor{ RegOffset::PackResistance, RegisterAccess::ReadWrite, 0x0000 },
+		RegisterDescriptor{ RegOffset::SysResistance, RegisterAccess::ReadWrite, 0x0000 },
+		RegisterDescriptor{ RegOffset::MinSysVoltage, RegisterAccess::ReadWrite, 0x0000 },
+		RegisterDescriptor{ RegOffset::MPPCurrent, RegisterAccess::ReadOnly, 0x0000 },
+		RegisterDescriptor{ RegOffset::SPPCurrent, RegisterAccess::ReadOnly, 0x0000 },
+		RegisterDescriptor{ RegOffset::ModelCfg, RegisterAccess::ReadWrite, 0x0000 },
+		RegisterDescriptor{ RegOffset::AtQResidual, RegisterAccess::ReadOnly, 0x0000 },
+		RegisterDescriptor{ RegOffset::AtTTE, RegisterAccess::ReadOnly, 0x0000 },
+		RegisterDescriptor{ RegOffset::AtAvSOC, RegisterAccess::ReadOnly, 0x0000 },
+		RegisterDescriptor{ RegOffset::AtAvCap, RegisterAccess::ReadOnly, 0x0000 }
+	};
+
+	constexpr std::optional<RegisterDescriptor> FindRegister(RegOffset reg)
+	{
+		for (const auto& descriptor : RegisterTable)
+		{
+			if (descriptor.Offset == reg)
+			{
+				return descriptor;
+			}
+		}
+		return std::nullopt;
+	}
+
+	constexpr bool IsRegisterDefined(RegOffset reg)
+	{
+		return FindRegister(reg).has_value();
+	}
+
+	/// <summary>
+	/// How fast the shadow copy of a register goes stale. Derived from its access flags.
+	/// </summary>
+	enum class Volatility : uint8_t
+	{
+		/// <summary>
+		/// Changes only when written by the host.
+		/// </summary>
+		Static,
+
+		/// <summary>
+		/// Updated by the gauge every task period.
+		/// </summary>
+		Measurement,
+
+		/// <summary>
+		/// Cell characterization, updated by the gauge on learning events.
+		/// </summary>
+		Learned
+	};
+
+	constexpr static size_t VolatilityCount = 3;
+
+	constexpr Volatility GetVolatility(RegOffset reg)
+	{
+		auto descriptor = FindRegister(reg);
+		if (!descriptor || !HasAccess(descriptor->Access, RegisterAccess::Changing))
+		{
+			return Volatility::Static;
+		}
+		return HasAccess(descriptor->Access, RegisterAccess::Learning) ? Volatility::Learned : Volatility::Measurement;
+	}
+
+	constexpr bool HasRegisterAccess(RegOffset reg, RegisterAccess flags)
+	{
+		auto descriptor = FindRegister(reg);
+		return descriptor && HasAccess(descriptor->Access, flags);
+	}
+
+	/// <summary>
+	/// Bits of a register that read back what was written. Zero for registers that cannot be read back or that the gauge
+	/// overwrites with measurements, so a written value is gone by the time it is read. Self-clearing command bits are left out.
+	/// </summary>
+	constexpr uint16_t GetVerifyMask(RegOffset reg)
+	{
+		auto descriptor = FindRegister(reg);
+		if (!descriptor || !HasAccess(descriptor->Access, RegisterAccess::ReadWrite) || GetVolatility(reg) == Volatility::Measurement)
+		{
+			return 0;
+		}
+
+		switch (reg)
+		{
+		case RegOffset::Config2:
+			// POR_CMD and LdMdl
+			return 0xFFDE;
+		case RegOffset::ModelCfg:
+			// Refresh
+			return 0x7FFF;
+		default:
+			return 0xFFFF;
+		}
+	}
+
+	/// <summary>
+	/// True if registers first to last can be fetched in one burst: range is ordered and contains no write-only register. Reserved offsets read as don't-care.
+	/// </summary>
+	constexpr bool IsReadableRange(RegOffset first, RegOffset last)
+	{
+		if (first > last)
+		{
+			return false;
+		}
+		for (size_t i = static_cast<size_t>(first); i <= static_cast<size_t>(last); i++)
+		{
+			auto descriptor = FindRegister(static_cast<RegOffset>(i));
+			if (descriptor && !HasAccess(descriptor->Access, RegisterAccess::Read))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/// <summary>
+	/// True if registers first to last can be written in one burst: range is ordered and every register in it is defined and writable.
+	/// </summary>
+	constexpr bool IsWritableRange(RegOffset first, RegOffset last)
+	{
+		if (first > last)
+		{
+			return false;
+		}
+		for (size_t i = static_cast<size_t>(first); i <= static_cast<size_t>(last); i++)
+		{
+			if (!HasRegisterAccess(static_cast<RegOffset>(i), RegisterAccess::Write))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	template<typename T, typename Raw>
+	concept RawConvertible = requires(Raw raw, T value)
+	{
+		{ T::FromRaw(raw) } -> std::same_as<T>;
+		value.ToRaw();
+	};
+
+	/// <summary>
+	/// Converts unit types through FromRaw/ToRaw, everything else by cast.
+	/// </summary>
+	template<typename T, typename Raw>
+	struct DefaultCodec
+	{
+		constexpr static T Decode(Raw raw)
+		{
+			if constexpr (RawConvertible<T, Raw>)
+			{
+				return T::FromRaw(raw);
+			}
+			else
+			{
+				return static_cast<T>(raw);
+			}
+		}
+
+		constexpr static Raw Encode(T value)
+		{
+			if constexpr (RawConvertible<T, Raw>)
+			{
+				return static_cast<Raw>(value.ToRaw());
+			}
+			else
+			{
+				return static_cast<Raw>(value);
+			}
+		}
+	};
+
+	template<uint64_t MicroVoltsPerLsb>
+	struct ScaledVoltageCodec
+	{
+		constexpr static MicroVolts Decode(uint16_t raw)
+		{
+			return MicroVolts(raw * MicroVoltsPerLsb);
+		}
+
+		constexpr static uint16_t Encode(MicroVolts value)
+		{
+			return static_cast<uint16_t>(value.GetMicroVolts() / MicroVoltsPerLsb);
+		}
+	};
+
+	/// <summary>
+	/// Signed 8-bit alert threshold in 1 degree steps. Out-of-range values saturate.
+	/// </summary>
+	struct AlertTemperatureCodec
+	{
+		constexpr static MilliCelsius Decode(int8_t raw)
+		{
+			return MilliCelsius(raw * 1000);
+		}
+
+		constexpr static int8_t Encode(MilliCelsius value)
+		{
+			int64_t degrees = value.GetMilliCelsius() / 1000;
+			return static_cast<int8_t>(degrees < INT8_MIN ? INT8_MIN : (degrees > INT8_MAX ? INT8_MAX : degrees));
+		}
+	};
+
+	/// <summary>
+	/// Signed 8-bit alert threshold in 400 uV / RSense steps. Out-of-range values saturate.
+	/// </summary>
+	template<int64_t RSense = DefaultRSenseMicroOhms>
+	struct AlertCurrentCodec
+	{
+		constexpr static int64_t MicroAmperesPerLsb = 400000000 / RSense;
+
+		constexpr static BasicMicroAmperes<RSense> Decode(int8_t raw)
+		{
+			return BasicMicroAmperes<RSense>(raw * MicroAmperesPerLsb);
+		}
+
+		constexpr static int8_t Encode(BasicMicroAmperes<RSense> value)
+		{
+			int64_t raw = value.GetMicroAmperes() / MicroAmperesPerLsb;
+			return static_cast<int8_t>(raw < INT8_MIN ? INT8_MIN : (raw > INT8_MAX ? INT8_MAX : raw));
+		}
+	};
+
+	/// <summary>
+	/// Unsigned 8-bit alert threshold in 20 mV steps. Out-of-range values saturate.
+	/// </summary>
+	struct AlertVoltageCodec
+	{
+		constexpr static uint64_t MicroVoltsPerLsb = 20000;
+
+		constexpr static MicroVolts Decode(uint8_t raw)
+		{
+			return MicroVolts(raw * MicroVoltsPerLsb);
+		}
+
+		constexpr static uint8_t Encode(MicroVolts value)
+		{
+			uint64_t raw = value.GetMicroVolts() / MicroVoltsPerLsb;
+			return static_cast<uint8_t>(raw > UINT8_MAX ? UINT8_MAX : raw);
+		}
+	};
+
+	/// <summary>
+	/// Compile-time descriptor of a bit field. Device::Get and Device::Set generate the accessor from it.
+	/// </summary>
+	/// <typeparam name="Reg">Register holding the field</typeparam>
+	/// <typeparam name="T">Value type seen by the user</typeparam>
+	/// <typeparam name="Raw">Integer type of the raw bits. Signed for two's complement fields</typeparam>
+	template<RegOffset Reg, typename T, size_t BitOffset = 0, size_t BitLength = 16, typename Raw = uint16_t, typename Codec = DefaultCodec<T, Raw>>
+	struct Field
+	{
+		static_assert(BitLength > 0 && BitOffset + BitLength <= 16, "Field must fit in a 16-bit register");
+		static_assert(IsRegisterDefined(Reg), "Register is not in RegisterTable");
+
+		using ValueType = T;
+		using RawType = Raw;
+		using CodecType = Codec;
+		constexpr static RegOffset Register = Reg;
+		constexpr static size_t Offset = BitOffset;
+		constexpr static size_t Length = BitLength;
+		constexpr static bool IsWritable = HasRegisterAccess(Reg, RegisterAccess::Write);
+	};
+
+	/// <summary>
+	/// Fields whose scaling depends on the sense resistor, for a given RSense in uOhm. Fields holds the ones for the default 0.010 Ohm.
+	/// </summary>
+	template<int64_t RSense>
+	struct SenseFields
+	{
+		using CurrentAlertMin = Field<RegOffset::IAlrtTh, BasicMicroAmperes<RSense>, 0, 8, int8_t, AlertCurrentCodec<RSense>>;
+		using CurrentAlertMax = Field<RegOffset::IAlrtTh, BasicMicroAmperes<RSense>, 8, 8, int8_t, AlertCurrentCodec<RSense>>;
+
+		using DesignCap = Field<RegOffset::DesignCap, BasicMicroAmpereHours<RSense>>;
+		using IChgTerm = Field<RegOffset::IChgTerm, BasicMicroAmperes<RSense>, 0, 16, int16_t>;
+
+		using RepCap = Field<RegOffset::RepCap, BasicMicroAmpereHours<RSense>>;
+		using FullCapRep = Field<RegOffset::FullCapRep, BasicMicroAmpereHours<RSense>>;
+		using FullCapNom = Field<RegOffset::FullCapNom, BasicMicroAmpereHours<RSense>>;
+		using Current = Field<RegOffset::Current, BasicMicroAmperes<RSense>, 0, 16, int16_t>;
+		using AvgCurrent = Field<RegOffset::AvgCurrent, BasicMicroAmperes<RSense>, 0, 16, int16_t>;
+		using Power = Field<RegOffset::Power, BasicMicroWatts<RSense>, 0, 16, int16_t>;
+		using AvgPower = Field<RegOffset::AvgPower, BasicMicroWatts<RSense>, 0, 16, int16_t>;
+
+		using AtRate = Field<RegOffset::AtRate, BasicMicroAmperes<RSense>, 0, 16, int16_t>;
+		using AtQResidual = Field<RegOffset::AtQResidual, BasicMicroAmpereHours<RSense>>;
+		using AtAvCap = Field<RegOffset::AtAvCap, BasicMicroAmpereHours<RSense>>;
+	};
+
+	namespace Fields
+	{
+		using Status = Field<RegOffset::Status, Max1726::Status>;
+		using FStat = Field<RegOffset::FStat, Max1726::FStat>;
+		using Command = Field<RegOffset::Command, Max1726::Command>;
+		using Config = Field<RegOffset::Config, ConfigFlags>;
+		using AlertEnable = Field<RegOffset::Config, bool, 2, 1, uint8_t>;
+
+		/// <summary>
+		/// Is, Vs, Ts and Ss bits. When set, alert Status flags stay set until cleared by the host.
+		/// </summary>
+		using AlertSticky = Field<RegOffset::Config, uint8_t, 11, 4, uint8_t>;
+		using SocChangeAlertEnable = Field<RegOffset::Config2, bool, 7, 1, uint8_t>;
+		using LearnCfg = Field<RegOffset::LearnCfg, uint16_t>;
+		using FilterCfg = Field<RegOffset::FilterCfg, uint16_t>;
+
+		using HibScalar = Field<RegOffset::HibCfg, uint8_t, 0, 3, uint8_t>;
+		using HibExitTime = Field<RegOffset::HibCfg, uint8_t, 3, 2, uint8_t>;
+		using HibThreshold = Field<RegOffset::HibCfg, uint8_t, 8, 4, uint8_t>;
+		using HibEnterTime = Field<RegOffset::HibCfg, uint8_t, 12, 3, uint8_t>;
+		using HibernationEnabled = Field<RegOffset::HibCfg, bool, 15, 1, uint8_t>;
+
+		using ModelId = Field<RegOffset::ModelCfg, Max1726::ModelId, 4, 4, uint8_t>;
+		using HighChargeVoltage = Field<RegOffset::ModelCfg, bool, 10, 1, uint8_t>;
+		using ModelRefresh = Field<RegOffset::ModelCfg, bool, 15, 1, uint8_t>;
+
+		using VoltageAlertMin = Field<RegOffset::VAlrtTh, MicroVolts, 0, 8, uint8_t, AlertVoltageCodec>;
+		using VoltageAlertMax = Field<RegOffset::VAlrtTh, MicroVolts, 8, 8, uint8_t, AlertVoltageCodec>;
+		using TemperatureAlertMin = Field<RegOffset::TAlrtTh, MilliCelsius, 0, 8, int8_t, AlertTemperatureCodec>;
+		using TemperatureAlertMax = Field<RegOffset::TAlrtTh, MilliCelsius, 8, 8, int8_t, AlertTemperatureCodec>;
+		using SocAlertMin = Field<RegOffset::SAlrtTh, uint8_t, 0, 8, uint8_t>;
+		using SocAlertMax = Field<RegOffset::SAlrtTh, uint8_t, 8, 8, uint8_t>;
+		using CurrentAlertMin = SenseFields<DefaultRSenseMicroOhms>::CurrentAlertMin;
+		using CurrentAlertMax = SenseFields<DefaultRSenseMicroOhms>::CurrentAlertMax;
+
+		using DesignCap = SenseFields<DefaultRSenseMicroOhms>::DesignCap;
+		using IChgTerm = SenseFields<DefaultRSenseMicroOhms>::IChgTerm;
+		using VEmpty = Field<RegOffset::VEmpty, MicroVolts, 7, 9, uint16_t, ScaledVoltageCodec<10000>>;
+		using VRecovery = Field<RegOffset::VEmpty, MicroVolts, 0, 7, uint16_t, ScaledVoltageCodec<40000>>;
+
+		using RepCap = SenseFields<DefaultRSenseMicroOhms>::RepCap;
+		using RepSOC = Field<RegOffset::RepSOC, uint16_t>;
+		using FullCapRep = SenseFields<DefaultRSenseMicroOhms>::FullCapRep;
+		using FullCapNom = SenseFields<DefaultRSenseMicroOhms>::FullCapNom;
+		using VCell = Field<RegOffset::VCell, MicroVolts>;
+		using Current = SenseFields<DefaultRSenseMicroOhms>::Current;
+		using AvgCurrent = SenseFields<DefaultRSenseMicroOhms>::AvgCurrent;
+		using Power = SenseFields<DefaultRSenseMicroOhms>::Power;
+		using AvgPower = SenseFields<DefaultRSenseMicroOhms>::AvgPower;
+		using Temp = Field<RegOffset::Temp, MilliCelsius, 0, 16, int16_t>;
+		using TTE = Field<RegOffset::TTE, uint16_t>;
+		using TTF = Field<RegOffset::TTF, uint16_t>;
+
+		/// <summary>
+		/// Load the At* predictions are computed for. Same format as Current.
+		/// </summary>
+		using AtRate = SenseFields<DefaultRSenseMicroOhms>::AtRate;
+		using AtQResidual = SenseFields<DefaultRSenseMicroOhms>::AtQResidual;
+		using AtAvCap = SenseFields<DefaultRSenseMicroOhms>::AtAvCap;
+		using AtTTE = Field<RegOffset::AtTTE, uint16_t>;
+		using AtAvSOC = Field<RegOffset::AtAvSOC, uint16_t>;
+
+		using Cycles = Field<RegOffset::Cycles, uint16_t>;
+		using RComp0 = Field<RegOffset::RComp0, uint16_t>;
+		using TempCo = Field<RegOffset::TempCo, uint16_t>;
+		using dQAcc = Field<RegOffset::dQAcc, uint16_t>;
+		using dPAcc = Field<RegOffset::dPAcc, uint16_t>;
+
+		/// <summary>
+		/// Raw coulomb counter in capacity LSBs. Counts up while charging and wraps.
+		/// </summary>
+		using QH = Field<RegOffset::QH, uint16_t>;
+
+		/// <summary>
+		/// Sense resistor in 10 uOhm steps, as configured by the host.
+		/// </summary>
+		using RSense = Field<RegOffset::RSense, uint16_t>;
+	}
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "PiSubmarine/Max1726/RegisterFile.h"
+#include "PiSubmarine/Max1726/RegisterMap.h"
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace PiSubmarine::Max1726
+{
+	/// <summary>
+	/// Default Device stats policy. Collects nothing, takes no space and Device skips every hook at compile time.
+	/// </summary>
+	struct NoRegisterStats
+	{
+		constexpr static bool IsEnabled = false;
+	};
+
+	struct RegisterCounters
+	{
+		constexpr static size_t BucketCount = 16;
+
+		uint64_t Reads = 0;
+		uint64_t Writes = 0;
+		uint64_t ReadBytes = 0;
+		uint64_t WriteBytes = 0;
+		uint64_t Errors = 0;
+		uint64_t Retries = 0;
+
+		/// <summary>
+		/// Issue-to-callback latency of transactions starting at this register. Bucket i counts latencies below 2^(i+1) us, the last bucket everything above.
+		/// </summary>
+		std::array<uint64_t, BucketCount> LatencyHistogram{};
+	};
+
+	/// <summary>
+	/// Device stats policy counting traffic, errors and retries per register. Burst transactions count for every register they cover,
+	/// latency is attributed to the first register. Counters may be read from any thread while the driver updates them.
+	/// </summary>
+	template<typename Clock = std::chrono::steady_clock>
+	class RegisterStats
+	{
+	public:
+		constexpr static bool IsEnabled = true;
+		constexpr static size_t BucketCount = RegisterCounters::BucketCount;
+
+		RegisterCounters Get(RegOffset reg) const
+		{
+			const Entry& entry = m_Entries[static_cast<size_t>(reg)];
+			RegisterCounters counters;
+			counters.Reads = entry.Reads.load(std::memory_order_relaxed);
+			counters.Writes = entry.Writes.load(std::memory_order_relaxed);
+			counters.ReadBytes = entry.ReadBytes.load(std::memory_order_relaxed);
+			counters.WriteBytes = entry.WriteBytes.load(std::memory_order_relaxed);
+			counters.Errors = entry.Errors.load(std::memory_order_relaxed);
+			counters.Retries = entry.Retries.load(std::memory_order_relaxed);
+			for (size_t i = 0; i < BucketCount; i++)
+			{
+				counters.LatencyHistogram[i] = entry.LatencyHistogram[i].load(std::memory_order_relaxed);
+			}
+			return counters;
+		}
+
+		/// <summary>
+		/// Returns exclusive upper bound of the histogram bucket.
+		/// </summary>
+		constexpr static std::chrono::microseconds GetBucketUpperBound(size_t bucket)
+		{
+			return bucket + 1 < BucketCount ? std::chrono::microseconds(int64_t(1) << (bucket + 1)) : std::chrono::microseconds::max();
+		}
+
+		void Reset()
+		{
+			for (auto& entry : m_Entries)
+			{
+				entry.Reads = 0;
+				entry.Writes = 0;
+				entry.ReadBytes = 0;
+				entry.WriteBytes = 0;
+				entry.Errors = 0;
+				entry.Retries = 0;
+				for (auto& bucket : entry.LatencyHistogram)
+				{
+					bucket = 0;
+				}
+			}
+		}
+
+		void OnIssue(typename Clock::time_point now)
+		{
+			m_IssueTime = now;
+		}
+
+		void OnComplete(uint8_t first, uint16_t count, bool isWrite, bool ok, typename Clock::time_point now)
+		{
+			for (size_t i = 0; i < count && first + i < RegisterCount; i++)
+			{
+				Entry& entry = m_Entries[first + i];
+				if (!ok)
+				{
+					entry.Errors.fetch_add(1, std::memory_order_relaxed);
+				}
+				else if (isWrite)
+				{
+					entry.Writes.fetch_add(1, std::memory_order_relaxed);
+					entry.WriteBytes.fetch_add(RegisterSize, std::memory_order_relaxed);
+				}
+				else
+				{
+					entry.Reads.fetch_add(1, std::memory_order_relaxed);
+					entry.ReadBytes.fetch_add(RegisterSize, std::memory_order_relaxed);
+				}
+			}
+
+			auto latency = std::chrono::duration_cast<std::chrono::microseconds>(now - m_IssueTime).count();
+			m_Entries[first].LatencyHistogram[GetBucket(latency)].fetch_add(1, std::memory_order_relaxed);
+		}
+
+		void OnRetry(uint8_t first, uint16_t count)
+		{
+			for (size_t i = 0; i < count && first + i < RegisterCount; i++)
+			{
+				m_Entries[first + i].Retries.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+	private:
+		struct Entry
+		{
+			std::atomic<uint64_t> Reads = 0;
+			std::atomic<uint64_t> Writes = 0;
+			std::atomic<uint64_t> ReadBytes = 0;
+			std::atomic<uint64_t> WriteBytes = 0;
+			std::atomic<uint64_t> Errors = 0;
+			std::atomic<uint64_t> Retries = 0;
+			std::array<std::atomic<uint64_t>, BucketCount> LatencyHistogram{};
+		};
+
+		std::array<Entry, RegisterCount> m_Entries{};
+		typename Clock::time_point m_IssueTime{};
+
+		static size_t GetBucket(int64_t latencyUs)
+		{
+			if (latencyUs < 2)
+			{
+				return 0;
+			}
+			size_t bucket = static_cast<size_t>(std::bit_width(static_cast<uint64_t>(latencyUs))) - 1;
+			return bucket < BucketCount ? bucket : BucketCount - 1;
+		}
+	};
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace PiSubmarine::Max1726
+{
+	/// <summary>
+	/// Single-writer, multi-reader sequence lock. Readers never block the writer and retry if they raced with a store.
+	/// Payload is kept in relaxed atomic words, so concurrent access is free of data races.
+	/// </summary>
+	/// <typeparam name="T">Trivially copyable payload</typeparam>
+	template<typename T>
+		requires std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>
+	class SeqLock
+	{
+	public:
+		/// <summary>
+		/// Publishes new value. Must only be called from a single writer thread at a time.
+		/// </summary>
+		void Store(const T& value)
+		{
+			std::array<uint64_t, WordCount> words{};
+			std::memcpy(words.data(), static_cast<const void*>(&value), sizeof(T));
+
+			uint32_t sequence = m_Sequence.load(std::memory_order_relaxed);
+			m_Sequence.store(sequence + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+
+			for (size_t i = 0; i < WordCount; i++)
+			{
+				m_Words[i].store(words[i], std::memory_order_relaxed);
+			}
+
+			m_Sequence.store(sequence + 2, std::memory_order_release);
+		}
+
+		/// <summary>
+		/// Returns the last published value. Lock-free, retries while a store is in progress.
+		/// </summary>
+		T Load() const
+		{
+			std::array<uint64_t, WordCount> words{};
+			while (true)
+			{
+				uint32_t before = m_Sequence.load(std::memory_order_acquire);
+				if (before & 1)
+				{
+					continue;
+				}
+
+				for (size_t i = 0; i < WordCount; i++)
+				{
+					words[i] = m_Words[i].load(std::memory_order_relaxed);
+				}
+
+				std::atomic_thread_fence(std::memory_order_acquire);
+				uint32_t after = m_Sequence.load(std::memory_order_relaxed);
+				if (before == after)
+				{
+					break;
+				}
+			}
+
+			T value;
+			std::memcpy(static_cast<void*>(&value), words.data(), sizeof(T));
+			return value;
+		}
+
+		/// <summary>
+		/// Returns number of completed stores.
+		/// </summary>
+		uint32_t GetVersion() const
+		{
+			return m_Sequence.load(std::memory_order_acquire) / 2;
+		}
+
+	private:
+		constexpr static size_t WordCount = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+		std::atomic<uint32_t> m_Sequence = 0;
+		std::array<std::atomic<uint64_t>, WordCount> m_Words{};
+	};
+}
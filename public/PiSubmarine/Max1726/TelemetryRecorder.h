@@ -0,0 +1,445 @@
+#pragma once
+
+#include "PiSubmarine/Max1726/Max1726.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace PiSubmarine::Max1726
+{
+	/// <summary>
+	/// One telemetry sample as raw register values, the unit the recorder stores.
+	/// </summary>
+	struct TelemetryRecord
+	{
+		constexpr static size_t ValueCount = 8;
+
+		/// <summary>
+		/// Microseconds since the epoch of the acquisition clock.
+		/// </summary>
+		int64_t Timestamp = 0;
+		uint16_t RepSoc = 0;
+		uint16_t VCell = 0;
+		uint16_t Current = 0;
+		uint16_t AvgCurrent = 0;
+		uint16_t Temp = 0;
+		uint16_t RepCap = 0;
+		uint16_t TimeToEmpty = 0;
+		uint16_t Status = 0;
+
+		template<typename Clock, int64_t RSense>
+		static TelemetryRecord FromSnapshot(const TelemetrySnapshot<Clock, RSense>& snapshot)
+		{
+			TelemetryRecord record;
+			record.Timestamp = std::chrono::duration_cast<std::chrono::microseconds>(snapshot.Timestamp.time_since_epoch()).count();
+			record.RepSoc = snapshot.RemainingSoc;
+			record.VCell = snapshot.VCell.ToRaw();
+			record.Current = static_cast<uint16_t>(snapshot.Current.ToRaw());
+			record.AvgCurrent = static_cast<uint16_t>(snapshot.AverageCurrent.ToRaw());
+			record.Temp = static_cast<uint16_t>(snapshot.Temperature.ToRaw());
+			record.RepCap = snapshot.RemainingCapacity.ToRaw();
+			record.TimeToEmpty = snapshot.TimeToEmpty;
+			record.Status = RegUtils::ToInt(snapshot.Status);
+			return record;
+		}
+
+		/// <summary>
+		/// Converts back to unit types. Sequence is left zero. RSense must be the one the record was taken with.
+		/// </summary>
+		template<typename Clock = std::chrono::steady_clock, int64_t RSense = DefaultRSenseMicroOhms>
+		TelemetrySnapshot<Clock, RSense> ToSnapshot() const
+		{
+			TelemetrySnapshot<Clock, RSense> snapshot;
+			snapshot.Timestamp = typename Clock::time_point(std::chrono::duration_cast<typename Clock::duration>(std::chrono::microseconds(Timestamp)));
+			snapshot.Status = static_cast<Max1726::Status>(Status);
+			snapshot.RemainingCapacity = BasicMicroAmpereHours<RSense>::FromRaw(RepCap);
+			snapshot.RemainingSoc = RepSoc;
+			snapshot.Temperature = MilliCelsius::FromRaw(static_cast<int16_t>(Temp));
+			snapshot.VCell = MicroVolts::FromRaw(VCell);
+			snapshot.Current = BasicMicroAmperes<RSense>::FromRaw(static_cast<int16_t>(Current));
+			snapshot.AverageCurrent = BasicMicroAmperes<RSense>::FromRaw(static_cast<int16_t>(AvgCurrent));
+			snapshot.TimeToEmpty = TimeToEmpty;
+			return snapshot;
+		}
+
+		std::array<uint16_t, ValueCount> GetValues() const
+		{
+			return { RepSoc, VCell, Current, AvgCurrent, Temp, RepCap, TimeToEmpty, Status };
+		}
+
+		void SetValues(const std::array<uint16_t, ValueCount>& values)
+		{
+			RepSoc = values[0];
+			VCell = values[1];
+			Current = values[2];
+			AvgCurrent = values[3];
+			Temp = values[4];
+			RepCap = values[5];
+			TimeToEmpty = values[6];
+			Status = values[7];
+		}
+	};
+
+	/// <summary>
+	/// Recorder storage layout: header, then a ring of fixed-size blocks.
+	/// Header: magic (2), version (1), reserved (1), block size (2), reserved (2), block count (4), reserved (4).
+	/// Block: sequence (4, zero if empty), timestamp of the first sample (8), sample count (2), payload size (2), payload.
+	/// Payload: first sample as raw little-endian values, then per sample a varint timestamp delta and a zigzag varint delta per value.
+	/// </summary>
+	constexpr static std::array<uint8_t, 2> RecorderMagic{ 'T', 'R' };
+	constexpr static uint8_t RecorderVersion = 1;
+	constexpr static size_t RecorderHeaderSize = 16;
+	constexpr static size_t RecorderBlockSize = 256;
+	constexpr static size_t RecorderBlockHeaderSize = 16;
+	constexpr static size_t RecorderPayloadSize = RecorderBlockSize - RecorderBlockHeaderSize;
+
+	/// <summary>
+	/// Returns storage size needed for the given number of blocks.
+	/// </summary>
+	constexpr size_t GetRecorderStorageSize(size_t blockCount)
+	{
+		return RecorderHeaderSize + blockCount * RecorderBlockSize;
+	}
+
+	namespace RecorderEncoding
+	{
+		constexpr static size_t MaxSampleSize = 10 + TelemetryRecord::ValueCount * 3;
+
+		template<typename T>
+		void Store(uint8_t* data, T value)
+		{
+			for (size_t i = 0; i < sizeof(T); i++)
+			{
+				data[i] = static_cast<uint8_t>(static_cast<uint64_t>(value) >> (i * 8));
+			}
+		}
+
+		template<typename T>
+		T Load(const uint8_t* data)
+		{
+			uint64_t value = 0;
+			for (size_t i = 0; i < sizeof(T); i++)
+			{
+				value |= static_cast<uint64_t>(data[i]) << (i * 8);
+			}
+			return static_cast<T>(value);
+		}
+
+		inline size_t StoreVarint(uint8_t* data, uint64_t value)
+		{
+			size_t size = 0;
+			while (value >= 0x80)
+			{
+				data[size++] = static_cast<uint8_t>(value | 0x80);
+				value >>= 7;
+			}
+			data[size++] = static_cast<uint8_t>(value);
+			return size;
+		}
+
+		/// <returns>Bytes consumed, or zero if the varint runs past end.</returns>
+		inline size_t LoadVarint(std::span<const uint8_t> data, uint64_t& value)
+		{
+			value = 0;
+			for (size_t i = 0; i < data.size() && i < 10; i++)
+			{
+				value |= static_cast<uint64_t>(data[i] & 0x7F) << (i * 7);
+				if ((data[i] & 0x80) == 0)
+				{
+					return i + 1;
+				}
+			}
+			return 0;
+		}
+
+		constexpr uint16_t ZigZag(uint16_t value, uint16_t previous)
+		{
+			auto delta = static_cast<int16_t>(value - previous);
+			return static_cast<uint16_t>((static_cast<uint16_t>(delta) << 1) ^ static_cast<uint16_t>(delta >> 15));
+		}
+
+		constexpr uint16_t UnZigZag(uint16_t encoded, uint16_t previous)
+		{
+			auto delta = static_cast<uint16_t>((encoded >> 1) ^ static_cast<uint16_t>(-(encoded & 1)));
+			return static_cast<uint16_t>(previous + delta);
+		}
+	}
+
+	/// <summary>
+	/// Flight recorder of raw telemetry. Appends samples to a ring of delta-encoded blocks in caller-provided storage, normally a MappedFile,
+	/// overwriting the oldest block when full. Append() encodes into a block buffer held inside the recorder and copies at most one block
+	/// into storage; it never allocates, locks or calls into the OS. Single writer.
+	/// </summary>
+	class TelemetryRecorder
+	{
+	public:
+		TelemetryRecorder(std::span<uint8_t> storage) : m_Storage(storage)
+		{
+
+		}
+
+		/// <summary>
+		/// Resumes recording after the newest block of an existing recording, or formats the storage if it holds none.
+		/// </summary>
+		/// <returns>False if storage cannot hold a single block.</returns>
+		bool Open()
+		{
+			using namespace RecorderEncoding;
+
+			if (m_Storage.size() < GetRecorderStorageSize(1))
+			{
+				return false;
+			}
+
+			uint32_t blockCount = static_cast<uint32_t>((m_Storage.size() - RecorderHeaderSize) / RecorderBlockSize);
+			bool isValid = m_Storage[0] == RecorderMagic[0] && m_Storage[1] == RecorderMagic[1] && m_Storage[2] == RecorderVersion
+				&& Load<uint16_t>(&m_Storage[4]) == RecorderBlockSize && Load<uint32_t>(&m_Storage[8]) == blockCount;
+
+			m_BlockCount = blockCount;
+			m_BlockIndex = 0;
+			m_Sequence = 1;
+			if (isValid)
+			{
+				for (uint32_t i = 0; i < m_BlockCount; i++)
+				{
+					uint32_t sequence = Load<uint32_t>(GetBlock(i));
+					if (sequence >= m_Sequence)
+					{
+						m_Sequence = sequence + 1;
+						m_BlockIndex = (i + 1) % m_BlockCount;
+					}
+				}
+			}
+			else
+			{
+				std::fill(m_Storage.begin(), m_Storage.end(), uint8_t(0));
+				m_Storage[0] = RecorderMagic[0];
+				m_Storage[1] = RecorderMagic[1];
+				m_Storage[2] = RecorderVersion;
+				Store<uint16_t>(&m_Storage[4], RecorderBlockSize);
+				Store<uint32_t>(&m_Storage[8], m_BlockCount);
+			}
+
+			m_SampleCount = 0;
+			m_IsBlockStored = false;
+			m_PayloadSize = 0;
+			m_IsOpen = true;
+			return true;
+		}
+
+		bool IsOpen() const
+		{
+			return m_IsOpen;
+		}
+
+		bool Append(const TelemetryRecord& record)
+		{
+			using namespace RecorderEncoding;
+
+			if (!m_IsOpen)
+			{
+				return false;
+			}
+
+			if (m_SampleCount > 0 && (record.Timestamp < m_LastTimestamp || RecorderPayloadSize - m_PayloadSize < MaxSampleSize || m_SampleCount == UINT16_MAX))
+			{
+				Commit();
+			}
+
+			auto values = record.GetValues();
+			uint8_t* payload = m_Block.data() + RecorderBlockHeaderSize;
+			if (m_SampleCount == 0)
+			{
+				m_BaseTimestamp = record.Timestamp;
+				for (size_t i = 0; i < values.size(); i++)
+				{
+					Store<uint16_t>(payload + i * 2, values[i]);
+				}
+				m_PayloadSize = values.size() * 2;
+			}
+			else
+			{
+				m_PayloadSize += StoreVarint(payload + m_PayloadSize, static_cast<uint64_t>(record.Timestamp - m_LastTimestamp));
+				for (size_t i = 0; i < values.size(); i++)
+				{
+					m_PayloadSize += StoreVarint(payload + m_PayloadSize, ZigZag(values[i], m_LastValues[i]));
+				}
+			}
+
+			m_LastTimestamp = record.Timestamp;
+			m_LastValues = values;
+			m_SampleCount++;
+			m_TotalSampleCount++;
+			return true;
+		}
+
+		template<typename Clock, int64_t RSense>
+		bool Append(const TelemetrySnapshot<Clock, RSense>& snapshot)
+		{
+			return Append(TelemetryRecord::FromSnapshot(snapshot));
+		}
+
+		/// <summary>
+		/// Copies the partially filled block into storage so it survives a crash. Later samples keep filling the same block.
+		/// </summary>
+		void Flush()
+		{
+			using namespace RecorderEncoding;
+
+			if (!m_IsOpen || m_SampleCount == 0)
+			{
+				return;
+			}
+
+			Store<uint32_t>(m_Block.data(), m_Sequence);
+			Store<uint64_t>(m_Block.data() + 4, static_cast<uint64_t>(m_BaseTimestamp));
+			Store<uint16_t>(m_Block.data() + 12, m_SampleCount);
+			Store<uint16_t>(m_Block.data() + 14, static_cast<uint16_t>(m_PayloadSize));
+
+			// Payload first, header last. Refilling a block only appends, so a torn copy leaves the stored header describing a valid prefix.
+			// A block taking over the slot of the oldest one invalidates it first.
+			uint8_t* block = GetBlock(m_BlockIndex);
+			if (!m_IsBlockStored)
+			{
+				Store<uint32_t>(block, 0);
+				m_IsBlockStored = true;
+			}
+			memcpy(block + RecorderBlockHeaderSize, m_Block.data() + RecorderBlockHeaderSize, m_PayloadSize);
+			memcpy(block, m_Block.data(), RecorderBlockHeaderSize);
+		}
+
+		size_t GetBlockCount() const
+		{
+			return m_BlockCount;
+		}
+
+		/// <summary>
+		/// Returns number of samples appended since Open().
+		/// </summary>
+		uint64_t GetSampleCount() const
+		{
+			return m_TotalSampleCount;
+		}
+
+	private:
+		std::span<uint8_t> m_Storage;
+		std::array<uint8_t, RecorderBlockSize> m_Block{};
+		std::array<uint16_t, TelemetryRecord::ValueCount> m_LastValues{};
+		bool m_IsOpen = false;
+		uint32_t m_BlockCount = 0;
+		uint32_t m_BlockIndex = 0;
+		uint32_t m_Sequence = 1;
+		uint16_t m_SampleCount = 0;
+		bool m_IsBlockStored = false;
+		size_t m_PayloadSize = 0;
+		int64_t m_BaseTimestamp = 0;
+		int64_t m_LastTimestamp = 0;
+		uint64_t m_TotalSampleCount = 0;
+
+		uint8_t* GetBlock(uint32_t index)
+		{
+			return m_Storage.data() + RecorderHeaderSize + static_cast<size_t>(index) * RecorderBlockSize;
+		}
+
+		void Commit()
+		{
+			Flush();
+			m_BlockIndex = (m_BlockIndex + 1) % m_BlockCount;
+			m_Sequence++;
+			m_SampleCount = 0;
+			m_IsBlockStored = false;
+			m_PayloadSize = 0;
+		}
+	};
+
+	/// <summary>
+	/// Decodes storage written by TelemetryRecorder into records, oldest first. Intended for offline analysis; allocates.
+	/// </summary>
+	/// <returns>False if storage holds no recording. Corrupted blocks are skipped.</returns>
+	inline bool DecodeTelemetry(std::span<const uint8_t> storage, std::vector<TelemetryRecord>& records)
+	{
+		using namespace RecorderEncoding;
+
+		if (storage.size() < RecorderHeaderSize || storage[0] != RecorderMagic[0] || storage[1] != RecorderMagic[1] || storage[2] != RecorderVersion
+			|| Load<uint16_t>(&storage[4]) != RecorderBlockSize)
+		{
+			return false;
+		}
+
+		uint32_t blockCount = Load<uint32_t>(&storage[8]);
+		if (storage.size() < GetRecorderStorageSize(blockCount))
+		{
+			return false;
+		}
+
+		std::vector<std::pair<uint32_t, const uint8_t*>> blocks;
+		for (uint32_t i = 0; i < blockCount; i++)
+		{
+			const uint8_t* block = storage.data() + RecorderHeaderSize + static_cast<size_t>(i) * RecorderBlockSize;
+			uint32_t sequence = Load<uint32_t>(block);
+			if (sequence != 0)
+			{
+				blocks.emplace_back(sequence, block);
+			}
+		}
+		std::sort(blocks.begin(), blocks.end());
+
+		for (const auto& [sequence, block] : blocks)
+		{
+			uint16_t sampleCount = Load<uint16_t>(block + 12);
+			uint16_t payloadSize = Load<uint16_t>(block + 14);
+			if (sampleCount == 0 || payloadSize > RecorderPayloadSize || payloadSize < TelemetryRecord::ValueCount * 2)
+			{
+				continue;
+			}
+
+			std::span<const uint8_t> payload(block + RecorderBlockHeaderSize, payloadSize);
+			std::array<uint16_t, TelemetryRecord::ValueCount> values{};
+			for (size_t i = 0; i < values.size(); i++)
+			{
+				values[i] = Load<uint16_t>(&payload[i * 2]);
+			}
+
+			TelemetryRecord record;
+			record.Timestamp = static_cast<int64_t>(Load<uint64_t>(block + 4));
+			record.SetValues(values);
+			records.push_back(record);
+
+			size_t position = values.size() * 2;
+			for (uint16_t sample = 1; sample < sampleCount; sample++)
+			{
+				uint64_t value = 0;
+				size_t size = LoadVarint(payload.subspan(position), value);
+				if (size == 0)
+				{
+					break;
+				}
+				position += size;
+				record.Timestamp += static_cast<int64_t>(value);
+
+				bool isComplete = true;
+				for (size_t i = 0; i < values.size() && isComplete; i++)
+				{
+					size = LoadVarint(payload.subspan(position), value);
+					isComplete = size != 0;
+					position += size;
+					values[i] = UnZigZag(static_cast<uint16_t>(value), values[i]);
+				}
+				if (!isComplete)
+				{
+					break;
+				}
+
+				record.SetValues(values);
+				records.push_back(record);
+			}
+		}
+		return true;
+	}
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+/// <summary>
+/// Kernels behind the span overloads of the unit types' FromRaw. Compile with AVX2 (-mavx2) or for AArch64 to get the vector paths;
+/// otherwise the same integer math runs as a plain loop. Results are bit-exact with the scalar conversions in every configuration.
+/// </summary>
+namespace PiSubmarine::Max1726::UnitKernels
+{
+	/// <summary>
+	/// out[i] = Unit::FromFixedPoint((raw[i] * Multiplier) >> Shift). The product must fit 32 bits for every 16-bit input.
+	/// The vector paths store whole units, so Unit must be exactly its 64-bit fixed-point value.
+	/// There is no ToRaw kernel: compilers turn the constant divisions into 64-bit multiply-high, which neither AVX2 nor NEON has,
+	/// and double-precision vector division measured slower, so the units' span ToRaw stay plain loops.
+	/// </summary>
+	template<typename Raw, int32_t Multiplier, int Shift = 0, typename Unit>
+	void Scale(const Raw* raw, Unit* out, size_t count)
+	{
+		static_assert(std::is_same_v<Raw, uint16_t> || std::is_same_v<Raw, int16_t>);
+		static_assert(sizeof(Unit) == 8 && std::is_standard_layout_v<Unit> && std::is_trivially_copyable_v<Unit>);
+		static_assert(std::is_same_v<decltype(std::declval<const Unit&>().ToRaw()), Raw>);
+		static_assert(int64_t(Multiplier) * 65535 <= INT32_MAX && Shift >= 0 && Shift < 32);
+		static_assert(Shift == 0 || std::is_unsigned_v<Raw>, "Shift of negative products rounds differently from division");
+
+		size_t i = 0;
+#if defined(__AVX2__)
+		constexpr bool isSigned = std::is_signed_v<Raw>;
+		const __m256i multiplier = _mm256_set1_epi32(Multiplier);
+		for (; i + 8 <= count; i += 8)
+		{
+			__m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(raw + i));
+			__m256i wide = isSigned ? _mm256_cvtepi16_epi32(packed) : _mm256_cvtepu16_epi32(packed);
+			wide = _mm256_mullo_epi32(wide, multiplier);
+			wide = isSigned ? _mm256_srai_epi32(wide, Shift) : _mm256_srli_epi32(wide, Shift);
+			__m128i low = _mm256_castsi256_si128(wide);
+			__m128i high = _mm256_extracti128_si256(wide, 1);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), isSigned ? _mm256_cvtepi32_epi64(low) : _mm256_cvtepu32_epi64(low));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + 4), isSigned ? _mm256_cvtepi32_epi64(high) : _mm256_cvtepu32_epi64(high));
+		}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+		constexpr bool isSigned = std::is_signed_v<Raw>;
+		const int32x4_t shift = vdupq_n_s32(-Shift);
+		for (; i + 8 <= count; i += 8)
+		{
+			if constexpr (isSigned)
+			{
+				int16x8_t packed = vld1q_s16(raw + i);
+				int32x4_t low = vshlq_s32(vmulq_n_s32(vmovl_s16(vget_low_s16(packed)), Multiplier), shift);
+				int32x4_t high = vshlq_s32(vmulq_n_s32(vmovl_s16(vget_high_s16(packed)), Multiplier), shift);
+				vst1q_s64(reinterpret_cast<int64_t*>(out + i), vmovl_s32(vget_low_s32(low)));
+				vst1q_s64(reinterpret_cast<int64_t*>(out + i + 2), vmovl_s32(vget_high_s32(low)));
+				vst1q_s64(reinterpret_cast<int64_t*>(out + i + 4), vmovl_s32(vget_low_s32(high)));
+				vst1q_s64(reinterpret_cast<int64_t*>(out + i + 6), vmovl_s32(vget_high_s32(high)));
+			}
+			else
+			{
+				uint16x8_t packed = vld1q_u16(raw + i);
+				uint32x4_t low = vshlq_u32(vmulq_n_u32(vmovl_u16(vget_low_u16(packed)), Multiplier), shift);
+				uint32x4_t high = vshlq_u32(vmulq_n_u32(vmovl_u16(vget_high_u16(packed)), Multiplier), shift);
+				vst1q_u64(reinterpret_cast<uint64_t*>(out + i), vmovl_u32(vget_low_u32(low)));
+				vst1q_u64(reinterpret_cast<uint64_t*>(out + i + 2), vmovl_u32(vget_high_u32(low)));
+				vst1q_u64(reinterpret_cast<uint64_t*>(out + i + 4), vmovl_u32(vget_low_u32(high)));
+				vst1q_u64(reinterpret_cast<uint64_t*>(out + i + 6), vmovl_u32(vget_high_u32(high)));
+			}
+		}
+#endif
+		for (; i < count; i++)
+		{
+			out[i] = Unit::FromFixedPoint((static_cast<int32_t>(raw[i]) * Multiplier) >> Shift);
+		}
+	}
+}
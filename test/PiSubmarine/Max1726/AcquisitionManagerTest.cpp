@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+#include "PiSubmarine/Max1726/AcquisitionManager.h"
+#include "I2CDriverMock.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace PiSubmarine::Max1726
+{
+	TEST(AcquisitionManagerTest, MuxSwitchesAreMinimised)
+	{
+		std::array<uint8_t, MemorySize> memory{ 0 };
+		I2CDriverMock driver(memory, 1ms);
+		std::vector<uint8_t> selected;
+
+		AcquisitionManager<I2CDriverMock> manager;
+		size_t bus = *manager.AddBus(driver, [&selected](uint8_t channel) {
+			selected.push_back(channel);
+			return true;
+			});
+		size_t gauge2 = *manager.AddGauge(bus, 2);
+		size_t gauge0 = *manager.AddGauge(bus, 0);
+		size_t gauge1 = *manager.AddGauge(bus, 1);
+
+		for (int i = 0; i < 3; i++)
+		{
+			ASSERT_TRUE(manager.RunCycle(bus));
+		}
+
+		EXPECT_EQ(selected, (std::vector<uint8_t>{ 0, 1, 2, 1, 0, 1, 2 }));
+		auto stats = manager.GetBusStats(bus);
+		EXPECT_EQ(stats.Cycles, 3);
+		EXPECT_EQ(stats.Transactions, 9);
+		EXPECT_EQ(stats.Failures, 0);
+		EXPECT_EQ(stats.MuxSwitches, 7);
+		EXPECT_EQ(manager.GetDevice(gauge0).GetTelemetry().Sequence, 3);
+		EXPECT_EQ(manager.GetDevice(gauge1).GetTelemetry().Sequence, 3);
+		EXPECT_EQ(manager.GetDevice(gauge2).GetTelemetry().Sequence, 3);
+	}
+
+	TEST(AcquisitionManagerTest, FailedMuxSelectSkipsGauge)
+	{
+		std::array<uint8_t, MemorySize> memory{ 0 };
+		I2CDriverMock driver(memory, 1ms);
+
+		AcquisitionManager<I2CDriverMock> manager;
+		size_t bus = *manager.AddBus(driver, [](uint8_t channel) {
+			return channel != 1;
+			});
+		size_t gauge0 = *manager.AddGauge(bus, 0);
+		size_t gauge1 = *manager.AddGauge(bus, 1);
+
+		EXPECT_FALSE(manager.RunCycle(bus));
+		EXPECT_EQ(manager.GetBusStats(bus).Failures, 1);
+		EXPECT_EQ(manager.GetDevice(gauge0).GetTelemetry().Sequence, 1);
+		EXPECT_EQ(manager.GetDevice(gauge1).GetTelemetry().Sequence, 0);
+	}
+
+	TEST(AcquisitionManagerTest, BusWorkersRunInParallel)
+	{
+		std::array<uint8_t, MemorySize> memory0{ 0 };
+		std::array<uint8_t, MemorySize> memory1{ 0 };
+		I2CDriverMock driver0(memory0, 1ms);
+		I2CDriverMock driver1(memory1, 1ms);
+
+		AcquisitionManager<I2CDriverMock> manager;
+		size_t bus0 = *manager.AddBus(driver0);
+		size_t bus1 = *manager.AddBus(driver1);
+		size_t gauge0 = *manager.AddGauge(bus0);
+		size_t gauge1 = *manager.AddGauge(bus1);
+
+		manager.Start(5ms);
+		std::this_thread::sleep_for(100ms);
+		manager.Stop();
+
+		for (size_t bus : { bus0, bus1 })
+		{
+			auto stats = manager.GetBusStats(bus);
+			EXPECT_GT(stats.Cycles, 1);
+			EXPECT_EQ(stats.Failures, 0);
+			EXPECT_GT(stats.GetUtilisation(), 0.0);
+			EXPECT_LE(stats.GetUtilisation(), 1.0);
+		}
+		EXPECT_GT(manager.GetDevice(gauge0).GetTelemetry().Sequence, 1);
+		EXPECT_GT(manager.GetDevice(gauge1).GetTelemetry().Sequence, 1);
+	}
+
+	TEST(AcquisitionManagerTest, AccessSelectsChannelBetweenWorkerReads)
+	{
+		std::array<uint8_t, MemorySize> memory{ 0 };
+		I2CDriverMock driver(memory, 1ms);
+		std::atomic<uint8_t> channel = AcquisitionManager<I2CDriverMock>::NoMux;
+		std::atomic<bool> isAccessing = false;
+		std::atomic<bool> isOverlapping = false;
+
+		AcquisitionManager<I2CDriverMock> manager;
+		size_t bus = *manager.AddBus(driver, [&](uint8_t selected) {
+			if (isAccessing)
+			{
+				isOverlapping = true;
+			}
+			channel = selected;
+			return true;
+			});
+		manager.AddGauge(bus, 0);
+		size_t gauge1 = *manager.AddGauge(bus, 1);
+
+		manager.Start(1ms);
+		for (int i = 0; i < 5; i++)
+		{
+			bool ok = manager.Access(gauge1, [&](AcquisitionManager<I2CDriverMock>::DeviceType& device) {
+				isAccessing = true;
+				bool isSelected = channel == 1;
+				bool isRead = device.ReadAsync(RegOffset::RSense).Wait();
+				isAccessing = false;
+				return isSelected && isRead;
+				});
+			EXPECT_TRUE(ok);
+		}
+		EXPECT_FALSE(manager.AddGauge(bus, 2).has_value());
+		EXPECT_FALSE(manager.AddBus(driver).has_value());
+		manager.Stop();
+
+		EXPECT_FALSE(isOverlapping);
+		EXPECT_EQ(manager.GetBusStats(bus).Failures, 0);
+		EXPECT_TRUE(manager.AddGauge(bus, 2).has_value());
+	}
+
+	TEST(AcquisitionManagerTest, GaugesOnABusMustNotShareAnAddress)
+	{
+		std::array<uint8_t, MemorySize> memory{ 0 };
+		I2CDriverMock driver(memory, 1ms);
+
+		AcquisitionManager<I2CDriverMock> manager;
+		size_t direct = *manager.AddBus(driver);
+		EXPECT_TRUE(manager.AddGauge(direct).has_value());
+		EXPECT_FALSE(manager.AddGauge(direct).has_value());
+		EXPECT_FALSE(manager.AddGauge(direct, 0).has_value());
+
+		size_t muxed = *manager.AddBus(driver, [](uint8_t) { return true; });
+		EXPECT_TRUE(manager.AddGauge(muxed, 0).has_value());
+		EXPECT_TRUE(manager.AddGauge(muxed, 1).has_value());
+		EXPECT_FALSE(manager.AddGauge(muxed, 1).has_value());
+		EXPECT_FALSE(manager.AddGauge(muxed).has_value());
+		EXPECT_EQ(manager.GetGaugeCount(), 3);
+	}
+
+	TEST(AcquisitionManagerTest, DevicesFollowSenseResistor)
+	{
+		constexpr int64_t RSense = 5000;
+		using Manager = AcquisitionManager<I2CDriverMock, std::chrono::steady_clock, RegisterStats<>, RSense>;
+		static_assert(std::is_same_v<Manager::DeviceType, Device<I2CDriverMock, std::chrono::steady_clock, RegisterStats<>, RSense>>);
+
+		std::array<uint8_t, MemorySize> memory{ 0 };
+		I2CDriverMock driver(memory, 1ms);
+		SetMockRegister(memory, RegOffset::Current, 1000);
+
+		Manager manager;
+		size_t bus = *manager.AddBus(driver);
+		size_t gauge = *manager.AddGauge(bus);
+		ASSERT_TRUE(manager.RunCycle(bus));
+		// 1.5625 uV / 5 mOhm per LSB
+		EXPECT_EQ(manager.GetDevice(gauge).GetTelemetry().Current.GetMicroAmperes(), 312500);
+		EXPECT_EQ(manager.GetDevice(gauge).GetRegisterStats().Get(RegOffset::Current).Reads, 1);
+	}
+}
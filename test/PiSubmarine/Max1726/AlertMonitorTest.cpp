@@ -0,0 +1,205 @@
+#include <gtest/gtest.h>
+#include "PiSubmarine/Max1726/AlertMonitor.h"
+#include "SimulatedGauge.h"
+#include <chrono>
+
+using namespace std::chrono_literals;
+
+namespace PiSubmarine::Max1726
+{
+	using SimulatedDevice = Device<SimulatedGauge, SimulatedClock>;
+
+	static AlertState RunMonitor(AlertMonitor<SimulatedDevice>& monitor, SimulatedGauge& gauge)
+	{
+		for (int i = 0; i < 100; i++)
+		{
+			AlertState state = monitor.Step();
+			if (state != AlertState::Busy)
+			{
+				return state;
+			}
+			gauge.Pump();
+		}
+		return AlertState::Busy;
+	}
+
+	TEST(AlertMonitorTest, ThresholdEncoding)
+	{
+		SimulatedGauge gauge;
+		SimulatedDevice device(gauge);
+
+		device.SetVoltageAlertThresholds(MicroVolts(3000000), MicroVolts(4200000));
+		EXPECT_EQ(device.GetRegisterValue(RegOffset::VAlrtTh), 0xD296);
+		EXPECT_EQ(device.GetVoltageAlertMin().GetMicroVolts(), 3000000);
+
+		device.SetTemperatureAlertThresholds(MilliCelsius(-5000), MilliCelsius(200000));
+		EXPECT_EQ(device.GetRegisterValue(RegOffset::TAlrtTh), 0x7FFB);
+		EXPECT_EQ(device.GetTemperatureAlertMin().GetMilliCelsius(), -5000);
+
+		device.SetCurrentAlertThresholds(MicroAmperes(-2000000), MicroAmperes(1000000));
+		EXPECT_EQ(device.GetRegisterValue(RegOffset::IAlrtTh), 0x19CE);
+		EXPECT_EQ(device.GetCurrentAlertMax().GetMicroAmperes(), 1000000);
+
+		device.SetSocAlertThresholds(10, 90);
+		EXPECT_EQ(device.GetRegisterValue(RegOffset::SAlrtTh), 0x5A0A);
+
+		device.DisableAlertThresholds();
+		EXPECT_EQ(device.GetRegisterValue(RegOffset::VAlrtTh), 0xFF00);
+		EXPECT_EQ(device.GetRegisterValue(RegOffset::TAlrtTh), 0x7F80);
+		EXPECT_EQ(device.GetRegisterValue(RegOffset::SAlrtTh), 0xFF00);
+		EXPECT_EQ(device.GetRegisterValue(RegOffset::IAlrtTh), 0x7F80);
+
+		device.SetAlertEnabled(true);
+		device.SetAlertSticky(true);
+		device.SetSocChangeAlertEnabled(true);
+		EXPECT_EQ(device.GetRegisterValue(RegOffset::Config), 0x7804);
+		EXPECT_EQ(device.GetRegisterValue(RegOffset::Config2), 0x0080);
+	}
+
+	TEST(AlertMonitorTest, BeginArmsWindowsAroundPresentValues)
+	{
+		SimulatedGauge gauge;
+		SimulatedDevice device(gauge);
+		ASSERT_TRUE(device.InitBlocking(gauge.GetWaitFunc(), MicroAmpereHours(3000000), MicroAmperes::FromRaw(640), MicroVolts(3300000)));
+
+		AlertMonitor<SimulatedDevice> monitor(device);
+		monitor.EnableVoltageAlert(MicroVolts(100000));
+		monitor.EnableSocAlert(5);
+		monitor.Begin();
+		ASSERT_EQ(RunMonitor(monitor, gauge), AlertState::Armed);
+
+		uint16_t vcell = gauge.PeekRegister(RegOffset::VCell);
+		uint16_t vAlrtTh = gauge.PeekRegister(RegOffset::VAlrtTh);
+		EXPECT_NEAR((vAlrtTh & 0xFF) * 256, vcell - 1280, 256);
+		EXPECT_NEAR((vAlrtTh >> 8) * 256, vcell + 1280, 256);
+		uint16_t soc = gauge.PeekRegister(RegOffset::RepSOC) >> 8;
+		EXPECT_EQ(gauge.PeekRegister(RegOffset::SAlrtTh), ((soc + 5) << 8) | (soc - 5));
+		EXPECT_EQ(gauge.PeekRegister(RegOffset::TAlrtTh), 0x7F80);
+		EXPECT_EQ(gauge.PeekRegister(RegOffset::IAlrtTh), 0x7F80);
+		EXPECT_NE(gauge.PeekRegister(RegOffset::Config) & 0x0004, 0);
+		EXPECT_FALSE(gauge.IsAlertAsserted());
+		EXPECT_EQ(monitor.GetAlertCount(), 0);
+	}
+
+	TEST(AlertMonitorTest, AlertReadsOnlyFiredRegistersAndRearms)
+	{
+		SimulatedGauge gauge;
+		gauge.SetLoadProfile([](double) { return 0.0; });
+		SimulatedDevice device(gauge);
+		ASSERT_TRUE(device.InitBlocking(gauge.GetWaitFunc(), MicroAmpereHours(3000000), MicroAmperes::FromRaw(640), MicroVolts(3300000)));
+
+		AlertMonitor<SimulatedDevice> monitor(device);
+		Status fired{};
+		monitor.SetAlertHandler([&](Status flags) { fired = flags; });
+		monitor.EnableTemperatureAlert(MilliCelsius(2000));
+		monitor.EnableVoltageAlert(MicroVolts(100000));
+		monitor.Begin();
+		ASSERT_EQ(RunMonitor(monitor, gauge), AlertState::Armed);
+
+		gauge.Advance(10s);
+		EXPECT_FALSE(gauge.IsAlertAsserted());
+
+		gauge.SetTemperature(40.0);
+		gauge.Advance(1s);
+		ASSERT_TRUE(gauge.IsAlertAsserted());
+
+		uint64_t bytes = gauge.GetByteCount();
+		monitor.NotifyAlert();
+		ASSERT_EQ(RunMonitor(monitor, gauge), AlertState::Armed);
+
+		EXPECT_EQ(fired, Status::MaximumTemperatureAlert);
+		EXPECT_EQ(monitor.GetAlertCount(), 1);
+		EXPECT_EQ(device.GetTemperature().GetMilliCelsius(), 40000);
+		EXPECT_EQ(gauge.PeekRegister(RegOffset::TAlrtTh), 0x2A26);
+		EXPECT_FALSE(gauge.IsAlertAsserted());
+
+		// Status and Temp reads (address write + 2 bytes each), then TAlrtTh and Status writes
+		EXPECT_EQ(gauge.GetByteCount() - bytes, 5u + 5u + 4u + 4u);
+	}
+
+	TEST(AlertMonitorTest, SpuriousAlertReadsOnlyStatus)
+	{
+		SimulatedGauge gauge;
+		SimulatedDevice device(gauge);
+		ASSERT_TRUE(device.InitBlocking(gauge.GetWaitFunc(), MicroAmpereHours(3000000), MicroAmperes::FromRaw(640), MicroVolts(3300000)));
+
+		AlertMonitor<SimulatedDevice> monitor(device);
+		bool isHandlerCalled = false;
+		monitor.SetAlertHandler([&](Status) { isHandlerCalled = true; });
+		monitor.EnableSocAlert(10);
+		monitor.Begin();
+		ASSERT_EQ(RunMonitor(monitor, gauge), AlertState::Armed);
+
+		uint64_t transactions = gauge.GetTransactionCount();
+		monitor.NotifyAlert();
+		ASSERT_EQ(RunMonitor(monitor, gauge), AlertState::Armed);
+		EXPECT_EQ(gauge.GetTransactionCount() - transactions, 2);
+		EXPECT_FALSE(isHandlerCalled);
+	}
+
+	TEST(AlertMonitorTest, ForeignFailureDoesNotFailMonitor)
+	{
+		SimulatedGauge gauge;
+		SimulatedDevice device(gauge);
+		ASSERT_TRUE(device.InitBlocking(gauge.GetWaitFunc(), MicroAmpereHours(3000000), MicroAmperes::FromRaw(640), MicroVolts(3300000)));
+
+		AlertMonitor<SimulatedDevice> monitor(device);
+		monitor.EnableSocAlert(10);
+		monitor.Begin();
+		ASSERT_EQ(RunMonitor(monitor, gauge), AlertState::Armed);
+
+		monitor.NotifyAlert();
+		ASSERT_EQ(monitor.Step(), AlertState::Busy);
+		ASSERT_TRUE(device.Read(RegOffset::Cycles));
+		gauge.FailTransfers(1, 1);
+		gauge.Pump();
+		ASSERT_TRUE(device.HasError());
+
+		EXPECT_EQ(RunMonitor(monitor, gauge), AlertState::Armed);
+	}
+
+	TEST(AlertMonitorTest, SocChangeAlertFollowsDischarge)
+	{
+		SimulatedBattery battery;
+		battery.CapacityAh = 1.0;
+		SimulatedGauge gauge(battery);
+		gauge.SetLoadProfile([](double) { return -1.0; });
+		SimulatedDevice device(gauge);
+		ASSERT_TRUE(device.InitBlocking(gauge.GetWaitFunc(), MicroAmpereHours(1000000), MicroAmperes::FromRaw(640), MicroVolts(3300000)));
+
+		AlertMonitor<SimulatedDevice> monitor(device);
+		int alerts = 0;
+		monitor.SetAlertHandler([&](Status flags) {
+			EXPECT_TRUE(RegUtils::HasAnyFlag(flags, Status::StateOfChargeChanged));
+			alerts++;
+			});
+		monitor.EnableSocChangeAlert();
+		monitor.Begin();
+		ASSERT_EQ(RunMonitor(monitor, gauge), AlertState::Armed);
+		EXPECT_NE(gauge.PeekRegister(RegOffset::Config2) & 0x0080, 0);
+
+		for (int i = 0; i < 360; i++)
+		{
+			gauge.Advance(1s);
+			if (gauge.IsAlertAsserted())
+			{
+				monitor.NotifyAlert();
+			}
+			ASSERT_EQ(RunMonitor(monitor, gauge), AlertState::Armed);
+		}
+
+		EXPECT_NEAR(alerts, 10, 1);
+		EXPECT_NEAR(device.GetRemainingSoc() / 256, 70, 1);
+	}
+
+	TEST(AlertMonitorTest, BusErrorFails)
+	{
+		SimulatedGauge gauge;
+		SimulatedDevice device(gauge);
+		AlertMonitor<SimulatedDevice> monitor(device);
+		monitor.EnableVoltageAlert(MicroVolts(100000));
+		gauge.SetSimulateError(true);
+		monitor.Begin();
+		EXPECT_EQ(RunMonitor(monitor, gauge), AlertState::Failed);
+	}
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstddef>
+
+namespace PiSubmarine::Max1726
+{
+	/// <summary>
+	/// Number of global operator new calls so far, in any of its plain, array, nothrow or aligned forms. Counted by the replacements in AllocationCounter.cpp,
+	/// which every executable linking that file gets for all of its allocations.
+	/// </summary>
+	size_t GetAllocationCount();
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include "PiSubmarine/Max1726/Max1726.h"
+#include "PiSubmarine/Max1726/TelemetryRecorder.h"
+#include "I2CDriverMock.h"
+#include "AllocationCounter.h"
+#include <chrono>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+namespace PiSubmarine::Max1726
+{
+	namespace
+	{
+		bool RunTelemetryCycle(Device<I2CDriverMock>& device, uint16_t cycles)
+		{
+			if (!device.ReadAndWait(RegOffset::RepCap, RegOffset::AvgCurrent, Sleep))
+			{
+				return false;
+			}
+
+			device.SetCycles(cycles);
+			if (!device.WriteDirty())
+			{
+				return false;
+			}
+			return device.WaitForTransaction(Sleep);
+		}
+	}
+
+	TEST(AllocationTest, TelemetryCycleDoesNotAllocate)
+	{
+		std::array<uint8_t, MemorySize> memory{ 0 };
+		I2CDriverMock driver(memory, 1ms);
+		Device<I2CDriverMock> device(driver);
+
+		// Warm up the mock's own request buffers.
+		ASSERT_TRUE(RunTelemetryCycle(device, 0));
+
+		constexpr size_t cycleCount = 10;
+		size_t allocationsBefore = GetAllocationCount();
+		bool ok = true;
+		for (size_t i = 0; i < cycleCount; i++)
+		{
+			ok = ok && RunTelemetryCycle(device, static_cast<uint16_t>(i));
+		}
+		size_t allocations = GetAllocationCount() - allocationsBefore;
+
+		ASSERT_TRUE(ok);
+		EXPECT_EQ(allocations, 0) << "allocations per cycle: " << static_cast<double>(allocations) / cycleCount;
+	}
+
+	TEST(AllocationTest, RecorderAppendDoesNotAllocate)
+	{
+		std::vector<uint8_t> storage(GetRecorderStorageSize(4));
+		TelemetryRecorder recorder(storage);
+		ASSERT_TRUE(recorder.Open());
+
+		TelemetrySnapshot<> snapshot;
+		size_t allocationsBefore = GetAllocationCount();
+		for (int i = 0; i < 1000; i++)
+		{
+			snapshot.Timestamp += 175ms;
+			snapshot.RemainingSoc = static_cast<uint16_t>(20000 - i);
+			recorder.Append(snapshot);
+		}
+		recorder.Flush();
+
+		EXPECT_EQ(GetAllocationCount() - allocationsBefore, 0);
+	}
+}
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include "PiSubmarine/Max1726/Max1726.h"
+#include "I2CDriverMock.h"
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <exception>
+
+using namespace std::chrono_literals;
+
+namespace PiSubmarine::Max1726
+{
+	namespace
+	{
+		struct FireAndForget
+		{
+			struct promise_type
+			{
+				FireAndForget get_return_object()
+				{
+					return {};
+				}
+
+				std::suspend_never initial_suspend() noexcept
+				{
+					return {};
+				}
+
+				std::suspend_never final_suspend() noexcept
+				{
+					return {};
+				}
+
+				void return_void()
+				{
+				}
+
+				void unhandled_exception()
+				{
+					std::terminate();
+				}
+			};
+		};
+
+		FireAndForget ReadModifyWrite(Device<I2CDriverMock>& device, std::atomic<int>& result)
+		{
+			if (!co_await device.ReadAsync(RegOffset::Cycles))
+			{
+				result = -1;
+				result.notify_all();
+				co_return;
+			}
+
+			device.SetCycles(device.GetCycles() + 1);
+			if (!co_await device.WriteAsync(RegOffset::Cycles))
+			{
+				result = -1;
+				result.notify_all();
+				co_return;
+			}
+
+			bool ok = co_await device.ReadTelemetryAsync();
+			result = ok ? 1 : -1;
+			result.notify_all();
+		}
+	}
+
+	TEST(AwaiterTest, CoroutineChainsTransactions)
+	{
+		std::array<uint8_t, MemorySize> memory{ 0 };
+		SetMockRegister(memory, RegOffset::Cycles, 41);
+		I2CDriverMock driver(memory, 0ms);
+		Device<I2CDriverMock> device(driver);
+
+		std::atomic<int> result = 0;
+		ReadModifyWrite(device, result);
+		result.wait(0);
+
+		EXPECT_EQ(result, 1);
+		EXPECT_EQ(GetMockRegister(memory, RegOffset::Cycles), 42);
+		EXPECT_EQ(device.GetTelemetry().Sequence, 1);
+		EXPECT_EQ(driver.GetTransactionCount(), 3);
+	}
+
+	TEST(AwaiterTest, BlockingWaitWakesOnCompletion)
+	{
+		std::array<uint8_t, MemorySize> memory{ 0 };
+		SetMockRegister(memory, RegOffset::VCell, 47360);
+		I2CDriverMock driver(memory, 0ms);
+		Device<I2CDriverMock> device(driver);
+
+		ASSERT_TRUE(device.ReadAsync(RegOffset::VCell).Wait());
+		EXPECT_EQ(device.GetVCell().GetMicroVolts(), MicroVolts::FromRaw(47360).GetMicroVolts());
+
+		device.SetDesignCapacity(MicroAmpereHours::FromRaw(6000));
+		ASSERT_TRUE(device.WriteDirtyAsync().Wait());
+		EXPECT_EQ(GetMockRegister(memory, RegOffset::DesignCap), 6000);
+
+		ASSERT_TRUE(device.Read(RegOffset::RepCap, RegOffset::AvgCurrent));
+		EXPECT_TRUE(device.WaitForTransaction());
+		EXPECT_FALSE(device.IsTransactionInProgress());
+	}
+
+	TEST(AwaiterTest, FailedTransactionReportsError)
+	{
+		std::array<uint8_t, MemorySize> memory{ 0 };
+		I2CDriverMock driver(memory, 0ms);
+		driver.SetSimulateError(true);
+		Device<I2CDriverMock> device(driver);
+
+		EXPECT_FALSE(device.WriteAsync(RegOffset::Cycles).Wait());
+		EXPECT_FALSE(device.ReadAsync(RegOffset::VCell).Wait());
+		EXPECT_TRUE(device.HasError());
+	}
+}
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include "PiSubmarine/Max1726/BoundedQueue.h"
+#include <thread>
+#include <vector>
+
+namespace PiSubmarine::Max1726
+{
+	TEST(BoundedQueueTest, PushPopInOrder)
+	{
+		BoundedQueue<int, 4> queue;
+		int value = 0;
+		EXPECT_FALSE(queue.TryPop(value));
+		for (int i = 0; i < 4; i++)
+		{
+			EXPECT_TRUE(queue.TryPush(i));
+		}
+		EXPECT_FALSE(queue.TryPush(4));
+		EXPECT_EQ(queue.GetSize(), 4);
+
+		for (int i = 0; i < 4; i++)
+		{
+			ASSERT_TRUE(queue.TryPop(value));
+			EXPECT_EQ(value, i);
+		}
+		EXPECT_EQ(queue.GetSize(), 0);
+	}
+
+	TEST(BoundedQueueTest, ManyProducersSingleConsumer)
+	{
+		constexpr int producerCount = 4;
+		constexpr int itemsPerProducer = 20000;
+		BoundedQueue<int, 64> queue;
+
+		std::vector<std::jthread> producers;
+		for (int p = 0; p < producerCount; p++)
+		{
+			producers.emplace_back([&queue, p]() {
+				for (int i = 0; i < itemsPerProducer; i++)
+				{
+					while (!queue.TryPush(p * itemsPerProducer + i))
+					{
+						std::this_thread::yield();
+					}
+				}
+				});
+		}
+
+		std::vector<int> lastSeen(producerCount, -1);
+		int received = 0;
+		bool ordered = true;
+		while (received < producerCount * itemsPerProducer)
+		{
+			int value = 0;
+			if (!queue.TryPop(value))
+			{
+				std::this_thread::yield();
+				continue;
+			}
+			int producer = value / itemsPerProducer;
+			int index = value % itemsPerProducer;
+			ordered = ordered && index > lastSeen[producer];
+			lastSeen[producer] = index;
+			received++;
+		}
+
+		EXPECT_TRUE(ordered);
+		EXPECT_EQ(received, producerCount * itemsPerProducer);
+	}
+}
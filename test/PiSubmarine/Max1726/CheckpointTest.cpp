@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include "PiSubmarine/Max1726/Max1726.h"
+#include "I2CDriverMock.h"
+#include <chrono>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+namespace PiSubmarine::Max1726
+{
+	namespace
+	{
+		LearnedParameters MakeParameters()
+		{
+			LearnedParameters params;
+			params.Rcomp0 = 0x0070;
+			params.TempCo = 0x263D;
+			params.FullCapRep = 0x0B9A;
+			params.FullCapNom = 0x0BB8;
+			params.Cycles = 0x0123;
+			params.QRTable = { 0x1050, 0x2012, 0x0A04, 0x0804 };
+			params.DQAcc = 0x00BB;
+			params.DPAcc = 0x0C80;
+			return params;
+		}
+
+		void ExpectEqual(const LearnedParameters& a, const LearnedParameters& b)
+		{
+			EXPECT_EQ(a.Rcomp0, b.Rcomp0);
+			EXPECT_EQ(a.TempCo, b.TempCo);
+			EXPECT_EQ(a.FullCapRep, b.FullCapRep);
+			EXPECT_EQ(a.FullCapNom, b.FullCapNom);
+			EXPECT_EQ(a.Cycles, b.Cycles);
+			EXPECT_EQ(a.QRTable, b.QRTable);
+			EXPECT_EQ(a.DQAcc, b.DQAcc);
+			EXPECT_EQ(a.DPAcc, b.DPAcc);
+		}
+	}
+
+	TEST(CheckpointTest, RoundTrip)
+	{
+		std::array<uint8_t, CheckpointSize> data{};
+		SerializeCheckpoint(MakeParameters(), data);
+
+		LearnedParameters params;
+		ASSERT_TRUE(DeserializeCheckpoint(data, params));
+		ExpectEqual(params, MakeParameters());
+	}
+
+	TEST(CheckpointTest, RejectsCorruptedData)
+	{
+		std::array<uint8_t, CheckpointSize> data{};
+		SerializeCheckpoint(MakeParameters(), data);
+		LearnedParameters params;
+
+		auto corrupted = data;
+		corrupted[10] ^= 0x01;
+		EXPECT_FALSE(DeserializeCheckpoint(corrupted, params));
+
+		auto wrongVersion = data;
+		wrongVersion[2] = CheckpointVersion + 1;
+		EXPECT_FALSE(DeserializeCheckpoint(wrongVersion, params));
+
+		EXPECT_FALSE(DeserializeCheckpoint(std::span<const uint8_t>(data.data(), CheckpointSize - 1), params));
+	}
+
+	TEST(CheckpointTest, CaptureReadsLearnedRegisters)
+	{
+		std::array<uint8_t, MemorySize> memory{ 0 };
+		LearnedParameters expected = MakeParameters();
+		SetMockRegister(memory, RegOffset::RComp0, expected.Rcomp0);
+		SetMockRegister(memory, RegOffset::TempCo, expected.TempCo);
+		SetMockRegister(memory, RegOffset::FullCapRep, expected.FullCapRep);
+		SetMockRegister(memory, RegOffset::FullCapNom, expected.FullCapNom);
+		SetMockRegister(memory, RegOffset::Cycles, expected.Cycles);
+		SetMockRegister(memory, RegOffset::QRTable00, expected.QRTable[0]);
+		SetMockRegister(memory, RegOffset::QRTable10, expected.QRTable[1]);
+		SetMockRegister(memory, RegOffset::QRTable20, expected.QRTable[2]);
+		SetMockRegister(memory, RegOffset::QRTable30, expected.QRTable[3]);
+		SetMockRegister(memory, RegOffset::dQAcc, expected.DQAcc);
+		SetMockRegister(memory, RegOffset::dPAcc, expected.DPAcc);
+		I2CDriverMock driver(memory, 1ms);
+		Device device(driver);
+
+		ASSERT_TRUE(device.ReadLearnedParametersAndWait(Sleep));
+		ExpectEqual(device.GetLearnedParameters(), expected);
+	}
+
+	TEST(CheckpointTest, RestoreWritesLearnedRegistersWithoutModelRefresh)
+	{
+		std::array<uint8_t, MemorySize> memory{ 0 };
+		SetMockRegister(memory, RegOffset::Status, RegUtils::ToInt(Status::PowerOnReset));
+		SetMockRegister(memory, RegOffset::HibCfg, 0x870C);
+		I2CDriverMock driver(memory, 1ms);
+		Device device(driver);
+
+		LearnedParameters params = MakeParameters();
+		ASSERT_TRUE(device.RestoreBlocking(Sleep, params, 3000000_uAh, 50000_uA, 3300000_uV));
+
+		EXPECT_EQ(GetMockRegister(memory, RegOffset::RComp0), params.Rcomp0);
+		EXPECT_EQ(GetMockRegister(memory, RegOffset::TempCo), params.TempCo);
+		EXPECT_EQ(GetMockRegister(memory, RegOffset::FullCapRep), params.FullCapRep);
+		EXPECT_EQ(GetMockRegister(memory, RegOffset::FullCapNom), params.FullCapNom);
+		EXPECT_EQ(GetMockRegister(memory, RegOffset::Cycles), params.Cycles);
+		EXPECT_EQ(GetMockRegister(memory, RegOffset::QRTable00), params.QRTable[0]);
+		EXPECT_EQ(GetMockRegister(memory, RegOffset::QRTable30), params.QRTable[3]);
+		EXPECT_EQ(GetMockRegister(memory, RegOffset::dQAcc), params.DQAcc);
+		EXPECT_EQ(GetMockRegister(memory, RegOffset::dPAcc), params.DPAcc);
+		EXPECT_EQ(GetMockRegister(memory, RegOffset::HibCfg), 0x870C);
+		EXPECT_EQ(GetMockRegister(memory, RegOffset::ModelCfg) & 0x8000, 0);
+		EXPECT_EQ(GetMockRegister(memory, RegOffset::Status) & RegUtils::ToInt(Status::PowerOnReset), 0);
+	}
+}
@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+#include "PiSubmarine/Max1726/EnergyIntegrator.h"
+#include "SimulatedGauge.h"
+#include <chrono>
+
+using namespace std::chrono_literals;
+
+namespace PiSubmarine::Max1726
+{
+	namespace
+	{
+		TelemetrySnapshot<> MakeSnapshot(uint64_t sequence, std::chrono::nanoseconds time, int64_t microVolts, int64_t microAmperes)
+		{
+			TelemetrySnapshot<> snapshot;
+			snapshot.Sequence = sequence;
+			snapshot.Timestamp = std::chrono::steady_clock::time_point(time);
+			snapshot.VCell = MicroVolts(static_cast<uint64_t>(microVolts));
+			snapshot.Current = MicroAmperes(microAmperes);
+			snapshot.RemainingCapacity = MicroAmpereHours(3000000);
+			return snapshot;
+		}
+	}
+
+	TEST(EnergyIntegratorTest, ConstantLoadDoesNotDrift)
+	{
+		EnergyIntegrator<> integrator;
+
+		// Period is not a whole number of microseconds, so per-sample rounding would accumulate 0.4 us each
+		constexpr std::chrono::nanoseconds period(175000400);
+		constexpr uint64_t count = 20572;
+		for (uint64_t i = 0; i < count; i++)
+		{
+			ASSERT_TRUE(integrator.Add(MakeSnapshot(i + 1, period * i, 3700000, -1000000)));
+		}
+
+		int64_t duration = std::chrono::duration_cast<std::chrono::microseconds>(period * (count - 1)).count();
+		auto usage = integrator.GetUsage();
+		EXPECT_EQ(usage.Duration.count(), duration);
+		EXPECT_EQ(usage.ConsumedCharge.GetMicroAmpereHours(), static_cast<uint64_t>((1000000 * duration + 1800000000) / 3600000000));
+		EXPECT_EQ(usage.ConsumedMicroWattHours, static_cast<uint64_t>((3700000 * duration + 1800000000) / 3600000000));
+		EXPECT_EQ(usage.RecoveredCharge.GetMicroAmpereHours(), 0);
+		EXPECT_EQ(usage.AveragePower.GetMicroWatts(), -3700000);
+		EXPECT_EQ(integrator.GetPower().GetMicroWatts(), -3700000);
+		EXPECT_EQ(integrator.GetChargeChange(), -static_cast<int64_t>(usage.ConsumedCharge.GetMicroAmpereHours()));
+	}
+
+	TEST(EnergyIntegratorTest, TrapezoidIsExactForRamp)
+	{
+		EnergyIntegrator<> integrator;
+		for (int64_t second = 0; second <= 3600; second++)
+		{
+			integrator.Add(MakeSnapshot(static_cast<uint64_t>(second + 1), std::chrono::seconds(second), 4000000, -1000 * second));
+		}
+
+		auto usage = integrator.GetUsage();
+		EXPECT_EQ(usage.ConsumedCharge.GetMicroAmpereHours(), 1800000);
+		EXPECT_EQ(usage.ConsumedMicroWattHours, 7200000);
+	}
+
+	TEST(EnergyIntegratorTest, LongSessionAtFullScaleDoesNotOverflow)
+	{
+		EnergyIntegrator<> integrator;
+
+		// 25 W for 72 h; a plain sum in 2 * uW*us would overflow int64 after about 51 h
+		constexpr uint64_t minutes = 72 * 60;
+		integrator.OpenWindow(0);
+		for (uint64_t minute = 0; minute <= minutes; minute++)
+		{
+			ASSERT_TRUE(integrator.Add(MakeSnapshot(minute + 1, std::chrono::minutes(minute), 5000000, -5000000)));
+		}
+
+		auto usage = integrator.GetUsage();
+		EXPECT_EQ(usage.ConsumedCharge.GetMicroAmpereHours(), 5000000ULL * 72);
+		EXPECT_EQ(usage.ConsumedMicroWattHours, 25000000ULL * 72);
+		EXPECT_EQ(usage.AveragePower.GetMicroWatts(), -25000000);
+		EXPECT_EQ(integrator.GetChargeChange(), -5000000LL * 72);
+		EXPECT_EQ(integrator.GetWindowUsage(0).ConsumedMicroWattHours, 25000000ULL * 72);
+	}
+
+	TEST(EnergyIntegratorTest, WindowsAttributeUsage)
+	{
+		EnergyIntegrator<std::chrono::steady_clock, DefaultRSenseMicroOhms, 2> integrator;
+		EXPECT_TRUE(integrator.OpenWindow(0));
+		EXPECT_FALSE(integrator.OpenWindow(2));
+
+		uint64_t sequence = 0;
+		auto run = [&](int seconds) {
+			for (int i = 0; i < seconds; i++)
+			{
+				sequence++;
+				integrator.Add(MakeSnapshot(sequence, std::chrono::seconds(sequence), 3600000, -1000000));
+			}
+			};
+
+		run(1801);
+		EXPECT_TRUE(integrator.OpenWindow(1));
+		run(900);
+		EXPECT_TRUE(integrator.CloseWindow(1));
+		EXPECT_FALSE(integrator.IsWindowOpen(1));
+		run(900);
+		EXPECT_TRUE(integrator.OpenWindow(1));
+		run(900);
+
+		EXPECT_TRUE(integrator.IsWindowOpen(0));
+		EXPECT_EQ(integrator.GetUsage().ConsumedCharge.GetMicroAmpereHours(), 1250000);
+		EXPECT_EQ(integrator.GetWindowUsage(0).ConsumedCharge.GetMicroAmpereHours(), 1250000);
+		EXPECT_EQ(integrator.GetWindowUsage(1).ConsumedCharge.GetMicroAmpereHours(), 500000);
+		EXPECT_EQ(integrator.GetWindowUsage(1).ConsumedMicroWattHours, 1800000);
+		EXPECT_EQ(integrator.GetWindowUsage(1).Duration, 1800s);
+		EXPECT_EQ(integrator.GetWindowUsage(1).AveragePower.GetMicroWatts(), -3600000);
+
+		integrator.Reset();
+		EXPECT_EQ(integrator.GetUsage().ConsumedCharge.GetMicroAmpereHours(), 0);
+		EXPECT_FALSE(integrator.IsWindowOpen(0));
+	}
+
+	TEST(EnergyIntegratorTest, RepeatedAndOlderSnapshotsAreIgnored)
+	{
+		EnergyIntegrator<> integrator;
+		EXPECT_TRUE(integrator.Add(MakeSnapshot(1, 0s, 3700000, 500000)));
+		EXPECT_TRUE(integrator.Add(MakeSnapshot(2, 1s, 3700000, 500000)));
+		EXPECT_FALSE(integrator.Add(MakeSnapshot(2, 1s, 3700000, 500000)));
+		EXPECT_FALSE(integrator.Add(MakeSnapshot(3, 500ms, 3700000, 500000)));
+
+		auto usage = integrator.GetUsage();
+		EXPECT_EQ(usage.Duration, 1s);
+		EXPECT_EQ(usage.ConsumedCharge.GetMicroAmpereHours(), 0);
+		EXPECT_EQ(usage.RecoveredCharge.GetMicroAmpereHours(), 139);
+	}
+
+	TEST(EnergyIntegratorTest, CoulombCounterWraps)
+	{
+		EnergyIntegrator<> integrator;
+		integrator.AddCoulombCounter(0x7FF0);
+		integrator.AddCoulombCounter(0x8010);
+		integrator.AddCoulombCounter(0xFFF0);
+		integrator.AddCoulombCounter(0x0010);
+		EXPECT_EQ(integrator.GetCoulombCounterChange(), (0x20 + 0x7FE0 + 0x20) * 500);
+	}
+
+	TEST(EnergyIntegratorTest, MatchesGaugeCounters)
+	{
+		SimulatedGauge gauge;
+		gauge.SetLoadProfile([](double) { return -2.0; });
+		Device<SimulatedGauge, SimulatedClock> device(gauge);
+		auto wait = gauge.GetWaitFunc();
+		ASSERT_TRUE(device.InitBlocking(wait, MicroAmpereHours(3000000), MicroAmperes::FromRaw(640), MicroVolts(3300000)));
+
+		// Let the model publish RepCap against the refreshed FullCapRep before taking the baseline
+		gauge.Advance(1s);
+
+		EnergyIntegrator<SimulatedClock> integrator;
+		for (int i = 0; i <= 600; i++)
+		{
+			ASSERT_TRUE(device.ReadTelemetry());
+			ASSERT_TRUE(device.WaitForTransaction(wait));
+			ASSERT_TRUE(device.ReadAndWait(RegOffset::QH, wait));
+			ASSERT_TRUE(integrator.Add(device.GetTelemetry()));
+			integrator.AddCoulombCounter(device.GetCoulombCounter());
+			gauge.Advance(1s);
+		}
+
+		EXPECT_NEAR(static_cast<double>(integrator.GetChargeChange()), -2e6 * 600 / 3600, 2e3);
+		EXPECT_NEAR(static_cast<double>(integrator.GetCoulombCounterChange()), static_cast<double>(integrator.GetChargeChange()), 2e3);
+		EXPECT_NEAR(static_cast<double>(integrator.GetRepCapChange()), static_cast<double>(integrator.GetChargeChange()), 2e3);
+
+		ASSERT_TRUE(device.ReadAndWait(RegOffset::Power, wait));
+		EXPECT_NEAR(static_cast<double>(device.GetPower().GetMicroWatts()), static_cast<double>(integrator.GetPower().GetMicroWatts()), 2 * MicroWatts::RawScale);
+	}
+}
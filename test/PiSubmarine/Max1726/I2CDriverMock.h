@@ -7,6 +7,10 @@
 #include <stop_token>
 #include <vector>
 #include <condition_variable>
+#include <atomic>
+#include <mutex>
+#include <array>
+#include <cstring>
 #include "PiSubmarine/Api/Internal/I2C/Callback.h"
 #include "PiSubmarine/Api/Internal/I2C/DriverConcept.h"
 #include "PiSubmarine/Max1726/Max1726.h"
@@ -28,7 +32,7 @@ namespace PiSubmarine::Max1726
 	class I2CDriverMock
 	{
 	public:
-		I2CDriverMock(std::array<uint8_t, Max1726::MemorySize>& data) : m_Data(data)
+		I2CDriverMock(std::array<uint8_t, Max1726::MemorySize>& data, std::chrono::milliseconds transactionDelay = std::chrono::milliseconds(250)) : m_Data(data), m_TransactionDelay(transactionDelay)
 		{
 			m_WorkerThread = std::jthread([this](std::stop_token st) {
 				this->WorkerMethod(st);
@@ -45,16 +49,21 @@ namespace PiSubmarine::Max1726
 			m_SimalateError = value;
 		}
 
+		size_t GetTransactionCount()
+		{
+			return m_TransactionCount;
+		}
+
 		bool Read(uint8_t deviceAddress, uint8_t* rxData, size_t len)
 		{
-			memcpy(rxData, m_Data.data() + m_DataOffset, len);
+			memcpy(rxData, m_Data.data() + m_DataOffset * Max1726::RegisterSize, len);
 			return !m_SimalateError;
 		}
 
 		bool Write(uint8_t deviceAddress, uint8_t* txData, size_t len)
 		{
 			m_DataOffset = txData[0];
-			memcpy(m_Data.data() + m_DataOffset, txData + 1, len - 1);
+			memcpy(m_Data.data() + m_DataOffset * Max1726::RegisterSize, txData + 1, len - 1);
 			return !m_SimalateError;
 		}
 
@@ -72,6 +81,7 @@ namespace PiSubmarine::Max1726
 			m_Request.Callback = callback;
 			m_Request.IsWrite = false;
 			m_Request.Tag = "ReadAsync";
+			m_TransactionCount++;
 
 			m_HasRequest = true;
 			return true;
@@ -91,6 +101,7 @@ namespace PiSubmarine::Max1726
 			m_Request.Callback = callback;
 			m_Request.IsWrite = true;
 			m_Request.Tag = "WriteAsync";
+			m_TransactionCount++;
 
 			m_HasRequest = true;
 			return true;
@@ -98,11 +109,12 @@ namespace PiSubmarine::Max1726
 
 	private:
 		std::array<uint8_t, Max1726::MemorySize>& m_Data;
-		std::chrono::milliseconds m_TransactionDelay = std::chrono::milliseconds(250);
+		std::chrono::milliseconds m_TransactionDelay;
 		I2CRequest m_Request{ 0 };
 		bool m_SimalateError = false;
 		bool m_HasRequest = false;
 		uint8_t m_DataOffset = 0;
+		std::atomic<size_t> m_TransactionCount = 0;
 		std::mutex m_Mutex;
 		std::jthread m_WorkerThread;
 
@@ -130,14 +142,33 @@ namespace PiSubmarine::Max1726
 					ok = Read(m_Request.DeviceAddress, m_Request.RxData, m_Request.RxLen);
 				}
 
+				Api::Internal::I2C::Callback callback = m_Request.Callback;
+				uint8_t deviceAddress = m_Request.DeviceAddress;
 				{
 					std::lock_guard lock(m_Mutex);
 					m_HasRequest = false;
 				}
 
-				m_Request.Callback(m_Request.DeviceAddress, ok);
+				callback(deviceAddress, ok);
 			}
 		}
 	};
 
+	inline void SetMockRegister(std::array<uint8_t, MemorySize>& memory, RegOffset reg, uint16_t value)
+	{
+		RegUtils::Write<uint16_t, std::endian::little>(value, memory.data() + RegUtils::ToInt(reg) * RegisterSize, 0, 16);
+	}
+
+	inline uint16_t GetMockRegister(const std::array<uint8_t, MemorySize>& memory, RegOffset reg)
+	{
+		return RegUtils::Read<uint16_t, std::endian::little>(memory.data() + RegUtils::ToInt(reg) * RegisterSize, 0, 16);
+	}
+
+	/// <summary>
+	/// WaitFunc for blocking device calls against the mock, which completes on its own worker thread.
+	/// </summary>
+	inline void Sleep(std::chrono::milliseconds duration)
+	{
+		std::this_thread::sleep_for(duration);
+	}
 }
\ No newline at end of file
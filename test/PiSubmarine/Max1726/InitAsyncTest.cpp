@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+#include "PiSubmarine/Max1726/InitAsync.h"
+#include "I2CDriverMock.h"
+#include "SimulatedGauge.h"
+#include <chrono>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+namespace PiSubmarine::Max1726
+{
+	namespace
+	{
+		template<typename Init>
+		InitState RunUntilFinished(Init& init, std::chrono::steady_clock::time_point& now)
+		{
+			for (size_t i = 0; i < 10000; i++)
+			{
+				InitState state = init.Step(now);
+				if (state == InitState::Done || state == InitState::Failed)
+				{
+					return state;
+				}
+				now += 10ms;
+				std::this_thread::sleep_for(100us);
+			}
+			return init.GetState();
+		}
+	}
+
+	TEST(InitAsyncTest, PowerOnResetRunsEzConfig)
+	{
+		SimulatedGauge gauge;
+		Device<SimulatedGauge, SimulatedClock> device(gauge);
+		InitAsync<Device<SimulatedGauge, SimulatedClock>, SimulatedClock> init(device);
+
+		EXPECT_EQ(init.GetState(), InitState::Idle);
+		init.Begin(MicroAmpereHours::FromRaw(6000), MicroAmperes::FromRaw(640), MicroVolts(3300000));
+
+		auto start = SimulatedClock::now();
+		for (size_t i = 0; i < 10000 && init.Step(SimulatedClock::now()) == InitState::Running; i++)
+		{
+			gauge.Advance(std::chrono::milliseconds(1));
+		}
+		ASSERT_EQ(init.GetState(), InitState::Done);
+
+		EXPECT_GE(SimulatedClock::now() - start, SimulatedGauge::DataNotReadyTime + SimulatedGauge::ModelRefreshTime);
+		EXPECT_EQ(gauge.PeekRegister(RegOffset::DesignCap), 6000);
+		EXPECT_EQ(gauge.PeekRegister(RegOffset::IChgTerm), 640);
+		EXPECT_EQ(gauge.PeekRegister(RegOffset::FullCapRep), 6000);
+		EXPECT_EQ(gauge.PeekRegister(RegOffset::ModelCfg) & 0x8000, 0);
+		EXPECT_EQ(gauge.PeekRegister(RegOffset::HibCfg), 0x870C);
+		EXPECT_EQ(gauge.GetLastCommand(), Command::Clear);
+		EXPECT_FALSE(RegUtils::HasAnyFlag(static_cast<Status>(gauge.PeekRegister(RegOffset::Status)), Status::PowerOnReset));
+	}
+
+	TEST(InitAsyncTest, ForeignFailureDoesNotFailInit)
+	{
+		SimulatedGauge gauge;
+		Device<SimulatedGauge, SimulatedClock> device(gauge);
+		InitAsync<Device<SimulatedGauge, SimulatedClock>, SimulatedClock> init(device);
+
+		init.Begin(MicroAmpereHours::FromRaw(6000), MicroAmperes::FromRaw(640), MicroVolts(3300000));
+		ASSERT_EQ(init.Step(SimulatedClock::now()), InitState::Running);
+		ASSERT_TRUE(device.Read(RegOffset::Cycles));
+		gauge.FailTransfers(1, 1);
+		gauge.Pump();
+		ASSERT_TRUE(device.HasError());
+
+		for (size_t i = 0; i < 10000 && init.Step(SimulatedClock::now()) == InitState::Running; i++)
+		{
+			gauge.Advance(std::chrono::milliseconds(1));
+		}
+		EXPECT_EQ(init.GetState(), InitState::Done);
+	}
+
+	TEST(InitAsyncTest, ForcedResetWaitsWithoutBlocking)
+	{
+		std::array<uint8_t, MemorySize> memory{ 0 };
+		SetMockRegister(memory, RegOffset::RSense, Device<I2CDriverMock>::RSenseRegisterValue);
+		I2CDriverMock driver(memory, 0ms);
+		Device<I2CDriverMock> device(driver);
+		InitAsync<Device<I2CDriverMock>> init(device);
+
+		init.Begin(MicroAmpereHours::FromRaw(6000), MicroAmperes::FromRaw(640), MicroVolts(3300000), true);
+
+		std::chrono::steady_clock::time_point start{};
+		std::chrono::steady_clock::time_point now = start;
+		ASSERT_EQ(RunUntilFinished(init, now), InitState::Done);
+		EXPECT_GE(now - start, 1000ms);
+		EXPECT_EQ(GetMockRegister(memory, RegOffset::Config2), 0x01);
+	}
+
+	TEST(InitAsyncTest, BusErrorFails)
+	{
+		std::array<uint8_t, MemorySize> memory{ 0 };
+		I2CDriverMock driver(memory, 0ms);
+		driver.SetSimulateError(true);
+		Device<I2CDriverMock> device(driver);
+		InitAsync<Device<I2CDriverMock>> init(device);
+
+		init.Begin(MicroAmpereHours::FromRaw(6000), MicroAmperes::FromRaw(640), MicroVolts(3300000));
+		std::chrono::steady_clock::time_point now{};
+		EXPECT_EQ(RunUntilFinished(init, now), InitState::Failed);
+	}
+}
@@ -0,0 +1,186 @@
+#include <benchmark/benchmark.h>
+#include "AllocationCounter.h"
+#include "SimulatedGauge.h"
+#include <array>
+#include <chrono>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace PiSubmarine::Max1726
+{
+	namespace
+	{
+		using BenchDevice = Device<SimulatedGauge, SimulatedClock>;
+
+		/// <summary>
+		/// Reports bus and heap cost of the measured loop as per-iteration averages.
+		/// </summary>
+		class CycleCounters
+		{
+		public:
+			CycleCounters(const SimulatedGauge& gauge) : m_Gauge(gauge), m_Transactions(gauge.GetTransactionCount()), m_Bytes(gauge.GetByteCount()), m_Allocations(GetAllocationCount())
+			{
+
+			}
+
+			void Report(benchmark::State& state) const
+			{
+				state.counters["transactions"] = benchmark::Counter(static_cast<double>(m_Gauge.GetTransactionCount() - m_Transactions), benchmark::Counter::kAvgIterations);
+				state.counters["bus_bytes"] = benchmark::Counter(static_cast<double>(m_Gauge.GetByteCount() - m_Bytes), benchmark::Counter::kAvgIterations);
+				state.counters["allocations"] = benchmark::Counter(static_cast<double>(GetAllocationCount() - m_Allocations), benchmark::Counter::kAvgIterations);
+			}
+
+		private:
+			const SimulatedGauge& m_Gauge;
+			uint64_t m_Transactions;
+			uint64_t m_Bytes;
+			size_t m_Allocations;
+		};
+	}
+
+	static void TelemetrySample(benchmark::State& state)
+	{
+		SimulatedGauge gauge;
+		BenchDevice device(gauge);
+
+		CycleCounters counters(gauge);
+		for (auto _ : state)
+		{
+			device.ReadTelemetry();
+			gauge.Pump();
+			benchmark::DoNotOptimize(device.GetTelemetry());
+		}
+		counters.Report(state);
+	}
+	BENCHMARK(TelemetrySample);
+
+	static void ReadCycle(benchmark::State& state)
+	{
+		SimulatedGauge gauge;
+		BenchDevice device(gauge);
+
+		CycleCounters counters(gauge);
+		for (auto _ : state)
+		{
+			device.Read(RegOffset::RepCap, RegOffset::AvgCurrent);
+			gauge.Pump();
+			benchmark::DoNotOptimize(device.GetCurrent());
+		}
+		counters.Report(state);
+	}
+	BENCHMARK(ReadCycle);
+
+	static void WriteDirtyCycle(benchmark::State& state)
+	{
+		SimulatedGauge gauge;
+		BenchDevice device(gauge);
+
+		CycleCounters counters(gauge);
+		for (auto _ : state)
+		{
+			device.SetDesignCapacity(MicroAmpereHours::FromRaw(6000));
+			device.SetTerminationCurrent(MicroAmperes::FromRaw(640));
+			device.SetEmptyVoltage(MicroVolts(3300000));
+			device.WriteDirty();
+			gauge.Pump();
+		}
+		counters.Report(state);
+	}
+	BENCHMARK(WriteDirtyCycle);
+
+	static void InitBlocking(benchmark::State& state)
+	{
+		SimulatedGauge gauge;
+		BenchDevice device(gauge);
+		auto wait = gauge.GetWaitFunc();
+
+		CycleCounters counters(gauge);
+		SimulatedClock::duration virtualTime{};
+		for (auto _ : state)
+		{
+			gauge.PowerOnReset();
+			auto start = SimulatedClock::now();
+			benchmark::DoNotOptimize(device.InitBlocking(wait, MicroAmpereHours::FromRaw(6000), MicroAmperes::FromRaw(640), MicroVolts(3300000)));
+			virtualTime += SimulatedClock::now() - start;
+		}
+		counters.Report(state);
+		state.counters["device_ms"] = benchmark::Counter(std::chrono::duration<double, std::milli>(virtualTime).count(), benchmark::Counter::kAvgIterations);
+	}
+	BENCHMARK(InitBlocking)->UseRealTime();
+
+	template<typename Unit, typename Raw>
+	static void UnitConversion(benchmark::State& state)
+	{
+		std::vector<Raw> raw(4096);
+		for (size_t i = 0; i < raw.size(); i++)
+		{
+			raw[i] = static_cast<Raw>(i * 16);
+		}
+
+		for (auto _ : state)
+		{
+			for (Raw value : raw)
+			{
+				benchmark::DoNotOptimize(Unit::FromRaw(value));
+			}
+		}
+		state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * raw.size()));
+	}
+	BENCHMARK(UnitConversion<MicroVolts, uint16_t>);
+	BENCHMARK(UnitConversion<MicroAmperes, int16_t>);
+	BENCHMARK(UnitConversion<MicroAmpereHours, uint16_t>);
+	BENCHMARK(UnitConversion<MilliCelsius, int16_t>);
+
+	template<typename Unit, typename Raw>
+	static void BatchUnitConversion(benchmark::State& state)
+	{
+		std::vector<Raw> raw(4096);
+		for (size_t i = 0; i < raw.size(); i++)
+		{
+			raw[i] = static_cast<Raw>(i * 16);
+		}
+		std::vector<Unit> values(raw.size());
+		std::vector<Raw> back(raw.size());
+
+		for (auto _ : state)
+		{
+			Unit::FromRaw(std::span<const Raw>(raw), std::span<Unit>(values));
+			Unit::ToRaw(std::span<const Unit>(values), std::span<Raw>(back));
+			benchmark::DoNotOptimize(back.data());
+		}
+		state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * raw.size()));
+	}
+	BENCHMARK(BatchUnitConversion<MicroVolts, uint16_t>);
+	BENCHMARK(BatchUnitConversion<MicroAmperes, int16_t>);
+	BENCHMARK(BatchUnitConversion<MicroAmpereHours, uint16_t>);
+	BENCHMARK(BatchUnitConversion<MilliCelsius, int16_t>);
+}
+
+/// <summary>
+/// Same as BENCHMARK_MAIN, but results are written as JSON unless another format is requested.
+/// </summary>
+int main(int argc, char** argv)
+{
+	std::vector<char*> args(argv, argv + argc);
+	std::string jsonFormat = "--benchmark_format=json";
+	bool hasFormat = false;
+	for (int i = 1; i < argc; i++)
+	{
+		hasFormat = hasFormat || std::string(argv[i]).starts_with("--benchmark_format");
+	}
+	if (!hasFormat)
+	{
+		args.push_back(jsonFormat.data());
+	}
+
+	int count = static_cast<int>(args.size());
+	benchmark::Initialize(&count, args.data());
+	if (benchmark::ReportUnrecognizedArguments(count, args.data()))
+	{
+		return 1;
+	}
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	return 0;
+}
@@ -1,7 +1,9 @@
 #include <gtest/gtest.h>
 #include "PiSubmarine/Max1726/Max1726.h"
 #include "I2CDriverMock.h"
+#include "SimulatedGauge.h"
 #include <chrono>
+#include <thread>
 
 using namespace std::chrono_literals;
 
@@ -12,5 +14,354 @@ namespace PiSubmarine::Max1726
 		
 
 	}
+
+	TEST(Max1726Test, BlockReadIsSingleTransaction)
+	{
+		std::array<uint8_t, MemorySize> memory{ 0 };
+		SetMockRegister(memory, RegOffset::RepCap, 2000);
+		SetMockRegister(memory, RegOffset::RepSOC, 0x3200);
+		SetMockRegister(memory, RegOffset::Temp, 0x1900);
+		SetMockRegister(memory, RegOffset::VCell, 47360);
+		SetMockRegister(memory, RegOffset::Current, 0xFF00);
+		SetMockRegister(memory, RegOffset::AvgCurrent, 0x0100);
+
+		I2CDriverMock driver(memory, 1ms);
+		Device<I2CDriverMock> device(driver);
+
+		ASSERT_TRUE(device.ReadAndWait(RegOffset::RepCap, RegOffset::AvgCurrent, Sleep));
+		EXPECT_EQ(driver.GetTransactionCount(), 1);
+
+		EXPECT_EQ(device.GetRemainingCapacity().GetMicroAmpereHours(), MicroAmpereHours::FromRaw(2000).GetMicroAmpereHours());
+		EXPECT_EQ(device.GetRemainingSoc(), 0x3200);
+		EXPECT_EQ(device.GetVCell().GetMicroVolts(), MicroVolts::FromRaw(47360).GetMicroVolts());
+		EXPECT_EQ(device.GetCurrent().GetMicroAmperes(), MicroAmperes::FromRaw(static_cast<int16_t>(0xFF00)).GetMicroAmperes());
+	}
+
+	TEST(Max1726Test, BlockReadRejectsReversedRange)
+	{
+		std::array<uint8_t, MemorySize> memory{ 0 };
+		I2CDriverMock driver(memory, 1ms);
+		Device<I2CDriverMock> device(driver);
+
+		EXPECT_FALSE(device.Read(RegOffset::AvgCurrent, RegOffset::RepCap));
+		EXPECT_EQ(driver.GetTransactionCount(), 0);
+	}
+
+	TEST(Max1726Test, WriteDirtyCoalescesAdjacentRegisters)
+	{
+		std::array<uint8_t, MemorySize> memory{ 0 };
+		I2CDriverMock driver(memory, 1ms);
+		Device<I2CDriverMock> device(driver);
+
+		device.SetCycles(0x1234);
+		device.SetDesignCapacity(MicroAmpereHours::FromRaw(6000));
+		device.SetTerminationCurrent(MicroAmperes::FromRaw(640));
+
+		ASSERT_TRUE(device.WriteDirty());
+		ASSERT_TRUE(device.WaitForTransaction(Sleep));
+		EXPECT_EQ(device.GetWriteDirtyTransactionCount(), 2);
+		EXPECT_EQ(driver.GetTransactionCount(), 2);
+		EXPECT_FALSE(device.HasDirtyRegisters());
+
+		EXPECT_EQ(GetMockRegister(memory, RegOffset::Cycles), 0x1234);
+		EXPECT_EQ(GetMockRegister(memory, RegOffset::DesignCap), 6000);
+		EXPECT_EQ(GetMockRegister(memory, RegOffset::IChgTerm), 640);
+	}
+
+	TEST(Max1726Test, WriteDirtyWithoutDirtyRegistersSendsNothing)
+	{
+		std::array<uint8_t, MemorySize> memory{ 0 };
+		I2CDriverMock driver(memory, 1ms);
+		Device<I2CDriverMock> device(driver);
+
+		EXPECT_TRUE(device.WriteDirty());
+		EXPECT_FALSE(device.IsTransactionInProgress());
+		EXPECT_FALSE(device.HasError());
+		EXPECT_EQ(driver.GetTransactionCount(), 0);
+		EXPECT_EQ(device.GetWriteDirtyTransactionCount(), 0);
+	}
+
+	TEST(Max1726Test, AdjacentRegistersDoNotOverlap)
+	{
+		std::array<uint8_t, MemorySize> memory{ 0 };
+		SetMockRegister(memory, RegOffset::RepCap, 0x1122);
+		SetMockRegister(memory, RegOffset::RepSOC, 0x3344);
+		I2CDriverMock driver(memory, 1ms);
+		Device<I2CDriverMock> device(driver);
+
+		EXPECT_FALSE(device.IsRegisterValid(RegOffset::RepCap));
+		auto before = std::chrono::steady_clock::now();
+		ASSERT_TRUE(device.ReadAndWait(RegOffset::RepCap, Sleep));
+		ASSERT_TRUE(device.ReadAndWait(RegOffset::RepSOC, Sleep));
+
+		EXPECT_EQ(device.GetRegisters().GetValue(RegUtils::ToInt(RegOffset::RepCap)), 0x1122);
+		EXPECT_EQ(device.GetRegisters().GetValue(RegUtils::ToInt(RegOffset::RepSOC)), 0x3344);
+		EXPECT_TRUE(device.IsRegisterValid(RegOffset::RepCap));
+		EXPECT_TRUE(device.IsRegisterValid(RegOffset::RepSOC));
+		EXPECT_FALSE(device.IsRegisterValid(RegOffset::Age));
+		EXPECT_GE(device.GetRegisterReadTime(RegOffset::RepSOC), before);
+	}
+
+	TEST(Max1726Test, FieldWritesMarkOnlyOwnRegisterDirty)
+	{
+		std::array<uint8_t, MemorySize> memory{ 0 };
+		I2CDriverMock driver(memory, 1ms);
+		Device<I2CDriverMock> device(driver);
+
+		device.SetEmptyVoltage(MicroVolts(3300000));
+		device.SetRecoveryVoltage(MicroVolts(3880000));
+		EXPECT_EQ(device.GetEmptyVoltage().GetMicroVolts(), 3300000);
+		EXPECT_EQ(device.GetRecoveryVoltage().GetMicroVolts(), 3880000);
+
+		const auto& registers = device.GetRegisters();
+		EXPECT_TRUE(registers[RegUtils::ToInt(RegOffset::VEmpty)].IsDirty);
+		for (size_t i = 0; i < RegisterCount; i++)
+		{
+			if (i != RegUtils::ToInt(RegOffset::VEmpty))
+			{
+				EXPECT_FALSE(registers[i].IsDirty) << i;
+			}
+		}
+
+		ASSERT_TRUE(device.WriteDirty());
+		ASSERT_TRUE(device.WaitForTransaction(Sleep));
+		EXPECT_EQ(GetMockRegister(memory, RegOffset::VEmpty), (330 << 7) | 97);
+	}
+
+	TEST(Max1726Test, ReadTelemetryPublishesSnapshot)
+	{
+		std::array<uint8_t, MemorySize> memory{ 0 };
+		SetMockRegister(memory, RegOffset::Status, RegUtils::ToInt(Status::BatteryPresent));
+		SetMockRegister(memory, RegOffset::RepCap, 2000);
+		SetMockRegister(memory, RegOffset::RepSOC, 0x3200);
+		SetMockRegister(memory, RegOffset::Temp, 0x1900);
+		SetMockRegister(memory, RegOffset::VCell, 47360);
+		SetMockRegister(memory, RegOffset::Current, 0xFF00);
+		SetMockRegister(memory, RegOffset::AvgCurrent, 0x0100);
+		SetMockRegister(memory, RegOffset::TTE, 5625);
+		I2CDriverMock driver(memory, 1ms);
+		Device<I2CDriverMock> device(driver);
+
+		EXPECT_EQ(device.GetTelemetry().Sequence, 0);
+		ASSERT_TRUE(device.ReadTelemetry());
+		ASSERT_TRUE(device.WaitForTransaction(Sleep));
+		EXPECT_EQ(driver.GetTransactionCount(), 1);
+
+		auto snapshot = device.GetTelemetry();
+		EXPECT_EQ(snapshot.Sequence, 1);
+		EXPECT_EQ(snapshot.Timestamp, device.GetRegisterReadTime(RegOffset::VCell));
+		EXPECT_EQ(snapshot.Status, Status::BatteryPresent);
+		EXPECT_EQ(snapshot.RemainingCapacity.GetMicroAmpereHours(), MicroAmpereHours::FromRaw(2000).GetMicroAmpereHours());
+		EXPECT_EQ(snapshot.RemainingSoc, 0x3200);
+		EXPECT_EQ(snapshot.Temperature.GetMilliCelsius(), 25000);
+		EXPECT_EQ(snapshot.VCell.GetMicroVolts(), MicroVolts::FromRaw(47360).GetMicroVolts());
+		EXPECT_EQ(snapshot.Current.GetMicroAmperes(), MicroAmperes::FromRaw(static_cast<int16_t>(0xFF00)).GetMicroAmperes());
+		EXPECT_EQ(snapshot.AverageCurrent.GetMicroAmperes(), MicroAmperes::FromRaw(0x0100).GetMicroAmperes());
+		EXPECT_EQ(snapshot.TimeToEmpty, 5625);
+	}
+
+	TEST(Max1726Test, RequestsAreQueuedWhileBusy)
+	{
+		std::array<uint8_t, MemorySize> memory{ 0 };
+		SetMockRegister(memory, RegOffset::Cycles, 42);
+		SetMockRegister(memory, RegOffset::DesignCap, 6000);
+		I2CDriverMock driver(memory, 1ms);
+		Device<I2CDriverMock> device(driver);
+
+		device.SetRcomp0(0x1234);
+		ASSERT_TRUE(device.ReadTelemetry());
+		ASSERT_TRUE(device.Read(RegOffset::Cycles, RegOffset::DesignCap));
+		ASSERT_TRUE(device.WriteDirty());
+		EXPECT_TRUE(device.IsTransactionInProgress());
+		EXPECT_GT(device.GetQueueDepth(), 0);
+
+		ASSERT_TRUE(device.WaitForTransaction(Sleep));
+		EXPECT_EQ(device.GetQueueDepth(), 0);
+		EXPECT_EQ(driver.GetTransactionCount(), 3);
+		EXPECT_EQ(device.GetCycles(), 42);
+		EXPECT_EQ(device.GetTelemetry().Sequence, 1);
+		EXPECT_EQ(GetMockRegister(memory, RegOffset::RComp0), 0x1234);
+
+		auto stats = device.GetQueueStats();
+		EXPECT_EQ(stats.Dispatched, 3);
+		EXPECT_EQ(stats.Rejected, 0);
+		EXPECT_GE(stats.MaxDepth, 2);
+		EXPECT_GT(stats.MaxWaitTime, std::chrono::steady_clock::duration::zero());
+	}
+
+	TEST(Max1726Test, RequestsFromManyThreadsAllComplete)
+	{
+		std::array<uint8_t, MemorySize> memory{ 0 };
+		I2CDriverMock driver(memory, 0ms);
+		Device<I2CDriverMock> device(driver);
+
+		constexpr size_t threadCount = 4;
+		constexpr size_t requestsPerThread = 50;
+		{
+			std::vector<std::jthread> threads;
+			for (size_t t = 0; t < threadCount; t++)
+			{
+				threads.emplace_back([&device, t]() {
+					for (size_t i = 0; i < requestsPerThread; i++)
+					{
+						RegOffset reg = static_cast<RegOffset>(RegUtils::ToInt(RegOffset::RepCap) + t);
+						while (!device.Read(reg))
+						{
+							std::this_thread::yield();
+						}
+					}
+					});
+			}
+		}
+
+		ASSERT_TRUE(device.WaitForTransaction(Sleep));
+		auto stats = device.GetQueueStats();
+		EXPECT_EQ(stats.Dispatched, threadCount * requestsPerThread);
+		EXPECT_EQ(driver.GetTransactionCount(), threadCount * requestsPerThread);
+		EXPECT_FALSE(device.HasError());
+	}
+
+	TEST(Max1726Test, RequestsRacingBusReleaseAreNeverStranded)
+	{
+		std::array<uint8_t, MemorySize> memory{ 0 };
+		I2CDriverMock driver(memory, 0ms);
+		Device<I2CDriverMock> device(driver);
+
+		// Producers submit in short bursts, so the bus is released and taken again many times while others push
+		constexpr size_t threadCount = 8;
+		constexpr size_t burstCount = 200;
+		constexpr size_t requestsPerBurst = 3;
+		{
+			std::vector<std::jthread> threads;
+			for (size_t t = 0; t < threadCount; t++)
+			{
+				threads.emplace_back([&device, t]() {
+					RegOffset reg = static_cast<RegOffset>(RegUtils::ToInt(RegOffset::RepCap) + t);
+					for (size_t burst = 0; burst < burstCount; burst++)
+					{
+						for (size_t i = 0; i < requestsPerBurst; i++)
+						{
+							while (!device.Read(reg))
+							{
+								std::this_thread::yield();
+							}
+						}
+						while (device.IsTransactionInProgress() && (burst + t) % 4 == 0)
+						{
+							std::this_thread::yield();
+						}
+					}
+					});
+			}
+		}
+
+		// A stranded request keeps the device busy forever
+		auto deadline = std::chrono::steady_clock::now() + 10s;
+		while (device.IsTransactionInProgress() && std::chrono::steady_clock::now() < deadline)
+		{
+			std::this_thread::sleep_for(1ms);
+		}
+		ASSERT_FALSE(device.IsTransactionInProgress());
+		EXPECT_EQ(device.GetQueueStats().Dispatched, threadCount * burstCount * requestsPerBurst);
+		EXPECT_EQ(device.GetQueueDepth(), 0);
+	}
+
+	TEST(Max1726Test, ReadThroughRefreshesStaleRegistersOnce)
+	{
+		using DeviceType = Device<SimulatedGauge, SimulatedClock>;
+		using RepCap = DeviceType::SenseFieldsType::RepCap;
+		SimulatedGauge gauge;
+		DeviceType device(gauge);
+		gauge.Advance(1s);
+		device.GetRemainingCapacity();
+		EXPECT_FALSE(device.IsTransactionInProgress());
+
+		EXPECT_EQ(device.GetOrRefresh<RepCap>().GetMicroAmpereHours(), 0);
+		device.GetOrRefresh<RepCap>();
+		device.GetRemainingCapacity();
+		EXPECT_EQ(device.GetQueueStats().Dispatched, 1);
+
+		gauge.Pump();
+		EXPECT_EQ(device.GetOrRefresh<RepCap>().ToRaw(), gauge.PeekRegister(RegOffset::RepCap));
+		EXPECT_EQ(device.GetQueueStats().Dispatched, 1);
+
+		// Plain getters stay off the bus even when the shadow value is stale
+		gauge.Advance(ActiveTaskPeriod);
+		device.GetRemainingCapacity();
+		EXPECT_FALSE(device.IsTransactionInProgress());
+		device.GetOrRefresh<RepCap>();
+		gauge.Pump();
+		EXPECT_EQ(device.GetQueueStats().Dispatched, 2);
+	}
+
+	TEST(Max1726Test, ReadThroughTtlFollowsVolatility)
+	{
+		using DeviceType = Device<SimulatedGauge, SimulatedClock>;
+		using DesignCap = DeviceType::SenseFieldsType::DesignCap;
+		using FullCapRep = DeviceType::SenseFieldsType::FullCapRep;
+		SimulatedGauge gauge;
+		DeviceType device(gauge);
+		device.SetFreshnessTtl(Volatility::Learned, 10s);
+
+		device.GetOrRefresh<DesignCap>();
+		device.GetOrRefresh<FullCapRep>();
+		gauge.Pump();
+		EXPECT_EQ(device.GetQueueStats().Dispatched, 2);
+
+		gauge.Advance(5s);
+		device.GetOrRefresh<DesignCap>();
+		device.GetOrRefresh<FullCapRep>();
+		EXPECT_FALSE(device.IsTransactionInProgress());
+
+		gauge.Advance(1h);
+		device.GetOrRefresh<DesignCap>();
+		device.GetOrRefresh<FullCapRep>();
+		gauge.Pump();
+		EXPECT_EQ(device.GetQueueStats().Dispatched, 3);
+
+		// A local change is never overwritten by a refresh, write-only registers are never read
+		device.SetCurrentAlertThresholds(MicroAmperes(-1000000), MicroAmperes(1000000));
+		device.GetOrRefresh<Fields::CurrentAlertMin>();
+		device.GetOrRefresh<Fields::Command>();
+		EXPECT_FALSE(device.IsTransactionInProgress());
+	}
+
+	TEST(Max1726Test, GetFreshWaitsForStaleRegister)
+	{
+		SimulatedGauge gauge;
+		gauge.SetLoadProfile([](double) { return -1.0; });
+		Device<SimulatedGauge, SimulatedClock> device(gauge);
+		auto wait = gauge.GetWaitFunc();
+		gauge.Advance(1s);
+
+		auto current = device.GetFresh<Fields::Current>(wait);
+		ASSERT_TRUE(current.has_value());
+		EXPECT_NEAR(static_cast<double>(current->GetMicroAmperes()), -1e6, 1e3);
+		uint64_t transactions = gauge.GetTransactionCount();
+		EXPECT_TRUE(device.GetFresh<Fields::Current>(wait).has_value());
+		EXPECT_EQ(gauge.GetTransactionCount(), transactions);
+		EXPECT_TRUE(device.IsFresh(RegOffset::Current));
+	}
+
+	TEST(Max1726Test, GetFreshWaitsForItsOwnRead)
+	{
+		SimulatedGauge gauge;
+		Device<SimulatedGauge, SimulatedClock> device(gauge);
+		auto wait = gauge.GetWaitFunc();
+		gauge.Advance(1s);
+
+		// An unrelated failure ahead in the queue does not fail the refresh
+		Device<SimulatedGauge, SimulatedClock>::Completion foreign;
+		gauge.FailTransfers(0, 1);
+		ASSERT_TRUE(device.Read(RegOffset::RepCap, foreign));
+		EXPECT_TRUE(device.GetFresh<Fields::Current>(wait).has_value());
+		EXPECT_TRUE(foreign.IsDone());
+		EXPECT_FALSE(foreign.IsOk());
+
+		gauge.Advance(1s);
+		gauge.FailTransfers(0, 1);
+		EXPECT_FALSE(device.GetFresh<Fields::Current>(wait).has_value());
+		EXPECT_FALSE(device.IsFresh(RegOffset::Current));
+	}
 	
 }
\ No newline at end of file
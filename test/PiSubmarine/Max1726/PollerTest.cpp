@@ -0,0 +1,211 @@
+#include <gtest/gtest.h>
+#include "PiSubmarine/Max1726/Poller.h"
+#include "I2CDriverMock.h"
+#include "SimulatedGauge.h"
+#include <chrono>
+#include <optional>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+namespace PiSubmarine::Max1726
+{
+	TEST(PollerTest, GroupsAreReadAtTheirOwnRate)
+	{
+		std::array<uint8_t, MemorySize> memory{ 0 };
+		I2CDriverMock driver(memory, 1ms);
+		Device<I2CDriverMock> device(driver);
+		Poller<Device<I2CDriverMock>> poller(device);
+
+		size_t fast = poller.AddTelemetryGroup(10ms);
+		size_t slow = poller.AddGroup(RegOffset::Cycles, RegOffset::Cycles, 100ms);
+
+		std::chrono::steady_clock::time_point start{};
+		for (auto t = 0ms; t <= 1000ms; t += 5ms)
+		{
+			while (poller.Tick(start + t))
+			{
+				device.WaitForTransaction(Sleep);
+			}
+		}
+
+		EXPECT_EQ(poller.GetStats(fast).Issued, 101);
+		EXPECT_EQ(poller.GetStats(slow).Issued, 11);
+		EXPECT_EQ(poller.GetStats(fast).MissedDeadlines, 0);
+		EXPECT_EQ(poller.GetStats(slow).Failed, 0);
+		EXPECT_NEAR(poller.GetStats(fast).GetAchievedRate(), 100.0, 0.5);
+		EXPECT_NEAR(poller.GetStats(slow).GetAchievedRate(), 10.0, 0.1);
+		EXPECT_EQ(device.GetTelemetry().Sequence, 101);
+	}
+
+	TEST(PollerTest, LateTicksCountMissedDeadlines)
+	{
+		std::array<uint8_t, MemorySize> memory{ 0 };
+		I2CDriverMock driver(memory, 1ms);
+		Device<I2CDriverMock> device(driver);
+		Poller<Device<I2CDriverMock>> poller(device);
+
+		size_t group = poller.AddGroup(RegOffset::VCell, RegOffset::Current, 10ms);
+		std::chrono::steady_clock::time_point start{};
+
+		ASSERT_TRUE(poller.Tick(start));
+		device.WaitForTransaction(Sleep);
+		ASSERT_TRUE(poller.Tick(start + 35ms));
+		device.WaitForTransaction(Sleep);
+
+		EXPECT_EQ(poller.GetStats(group).MissedDeadlines, 2);
+		EXPECT_EQ(poller.GetNextDue(), start + 40ms);
+	}
+
+	TEST(PollerTest, ForeignFailureIsNotAttributedToGroup)
+	{
+		std::array<uint8_t, MemorySize> memory{ 0 };
+		I2CDriverMock driver(memory, 1ms);
+		Device<I2CDriverMock> device(driver);
+		Poller<Device<I2CDriverMock>> poller(device);
+
+		size_t group = poller.AddGroup(RegOffset::VCell, RegOffset::Current, 10ms);
+		std::chrono::steady_clock::time_point start{};
+
+		ASSERT_TRUE(poller.Tick(start));
+		device.WaitForTransaction(Sleep);
+
+		driver.SetSimulateError(true);
+		ASSERT_TRUE(device.Read(RegOffset::Cycles));
+		device.WaitForTransaction(Sleep);
+		driver.SetSimulateError(false);
+		ASSERT_TRUE(device.HasError());
+
+		ASSERT_TRUE(poller.Tick(start + 10ms));
+		device.WaitForTransaction(Sleep);
+		poller.Tick(start + 15ms);
+
+		EXPECT_EQ(poller.GetStats(group).Completed, 2);
+		EXPECT_EQ(poller.GetStats(group).Failed, 0);
+	}
+
+	TEST(PollerTest, GroupsCanBeAddedWhileRunning)
+	{
+		std::array<uint8_t, MemorySize> memory{ 0 };
+		I2CDriverMock driver(memory, 0ms);
+		Device<I2CDriverMock> device(driver);
+		Poller<Device<I2CDriverMock>> poller(device);
+
+		poller.AddTelemetryGroup(1ms);
+		poller.Start(100us);
+		for (int i = 0; i < 50; i++)
+		{
+			size_t group = poller.AddGroup(RegOffset::Cycles, RegOffset::Cycles, 2ms);
+			poller.SetPeriod(group, 1ms);
+			EXPECT_LE(poller.GetStats(0).Completed + poller.GetStats(0).Failed, poller.GetStats(0).Issued);
+			Sleep(1ms);
+		}
+		poller.Stop();
+		device.WaitForTransaction(Sleep);
+
+		EXPECT_EQ(poller.GetGroupCount(), 51);
+		EXPECT_GT(poller.GetStats(0).Issued, 0);
+	}
+
+	TEST(PollerTest, CadenceFollowsHibernate)
+	{
+		using namespace std::chrono;
+		using SimulatedDevice = Device<SimulatedGauge, SimulatedClock>;
+
+		SimulatedGauge gauge;
+		auto start = SimulatedClock::now();
+		gauge.SetLoadProfile([](double seconds) { return seconds < 60.0 || seconds >= 600.0 ? -1.0 : 0.0; });
+		SimulatedDevice device(gauge);
+		auto wait = gauge.GetWaitFunc();
+		ASSERT_TRUE(device.InitBlocking(wait, MicroAmpereHours(3000000), MicroAmperes::FromRaw(640), MicroVolts(3300000)));
+
+		Poller<SimulatedDevice, SimulatedClock> poller(device);
+		size_t telemetry = poller.AddTelemetryGroup(ActiveTaskPeriod);
+		poller.SetCadenceTracking(true);
+
+		auto hibernatePeriod = HibernateTaskPeriod * (1 << device.GetHibScalar());
+		uint64_t issuedAt100s = 0;
+		uint64_t issuedAt600s = 0;
+		std::optional<SimulatedClock::time_point> wakeTime;
+		while (SimulatedClock::now() - start < 700s)
+		{
+			poller.Tick(SimulatedClock::now());
+			gauge.Advance(10ms);
+
+			auto elapsed = SimulatedClock::now() - start;
+			if (issuedAt100s == 0 && elapsed >= 100s)
+			{
+				issuedAt100s = poller.GetStats(telemetry).Issued;
+				EXPECT_EQ(poller.GetGaugeMode(), GaugeMode::Hibernate);
+				EXPECT_TRUE(gauge.IsHibernating());
+				EXPECT_EQ(poller.GetEffectivePeriod(telemetry), hibernatePeriod);
+			}
+			if (issuedAt600s == 0 && elapsed >= 600s)
+			{
+				issuedAt600s = poller.GetStats(telemetry).Issued;
+			}
+			if (elapsed >= 600s && !wakeTime && poller.GetGaugeMode() == GaugeMode::Active)
+			{
+				wakeTime = SimulatedClock::now();
+			}
+		}
+
+		// One read per hibernate task period instead of one per active task period
+		EXPECT_NEAR(static_cast<double>(issuedAt600s - issuedAt100s), 500.0 / duration<double>(hibernatePeriod).count(), 2.0);
+		ASSERT_TRUE(wakeTime);
+		EXPECT_LE(*wakeTime - (start + 600s), hibernatePeriod + 20ms);
+		EXPECT_EQ(poller.GetEffectivePeriod(telemetry), ActiveTaskPeriod);
+		EXPECT_EQ(poller.GetStats(telemetry).MissedDeadlines, 0);
+		EXPECT_EQ(poller.GetStats(telemetry).Failed, 0);
+	}
+
+	TEST(PollerTest, CadenceStaysActiveWithHibernationDisabled)
+	{
+		SimulatedGauge gauge;
+		gauge.SetLoadProfile([](double) { return 0.0; });
+		gauge.PokeRegister(RegOffset::HibCfg, 0x070C);
+		Device<SimulatedGauge, SimulatedClock> device(gauge);
+
+		Poller<Device<SimulatedGauge, SimulatedClock>, SimulatedClock> poller(device);
+		size_t telemetry = poller.AddTelemetryGroup(ActiveTaskPeriod);
+		poller.SetCadenceTracking(true);
+		for (int i = 0; i < 1000; i++)
+		{
+			poller.Tick(SimulatedClock::now());
+			gauge.Advance(10ms);
+		}
+
+		EXPECT_EQ(poller.GetGaugeMode(), GaugeMode::Active);
+		EXPECT_EQ(poller.GetEffectivePeriod(telemetry), ActiveTaskPeriod);
+		EXPECT_TRUE(device.IsRegisterValid(RegOffset::HibCfg));
+		EXPECT_TRUE(device.IsRegisterValid(RegOffset::FullCapRep));
+	}
+
+	TEST(PollerTest, CadenceIgnoresCurrentOutsideTelemetry)
+	{
+		SimulatedGauge gauge;
+		gauge.SetLoadProfile([](double) { return 0.0; });
+		Device<SimulatedGauge, SimulatedClock> device(gauge);
+
+		// Current read by a plain group is not looked at, only the snapshot of a telemetry group is
+		Poller<Device<SimulatedGauge, SimulatedClock>, SimulatedClock> poller(device);
+		size_t group = poller.AddGroup(RegOffset::VCell, RegOffset::Current, ActiveTaskPeriod);
+		poller.SetCadenceTracking(true);
+		for (int i = 0; i < 20000; i++)
+		{
+			poller.Tick(SimulatedClock::now());
+			gauge.Advance(10ms);
+		}
+
+		EXPECT_EQ(poller.GetGaugeMode(), GaugeMode::Active);
+		EXPECT_EQ(poller.GetEffectivePeriod(group), ActiveTaskPeriod);
+
+		poller.AddTelemetryGroup(ActiveTaskPeriod);
+		for (int i = 0; i < 20000; i++)
+		{
+			poller.Tick(SimulatedClock::now());
+			gauge.Advance(10ms);
+		}
+		EXPECT_EQ(poller.GetGaugeMode(), GaugeMode::Hibernate);
+	}
+}
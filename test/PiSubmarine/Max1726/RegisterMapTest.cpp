@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include "PiSubmarine/Max1726/Max1726.h"
+#include "SimulatedGauge.h"
+
+namespace PiSubmarine::Max1726
+{
+	static_assert(IsReadableRange(RegOffset::Status, RegOffset::TTE));
+	static_assert(IsReadableRange(RegOffset::RCell, RegOffset::Cycles));
+	static_assert(!IsReadableRange(RegOffset::TTE, RegOffset::Status));
+	static_assert(!IsReadableRange(RegOffset::QH, RegOffset::Status2));
+	static_assert(IsWritableRange(RegOffset::DesignCap, RegOffset::DesignCap));
+	static_assert(IsWritableRange(RegOffset::LearnCfg, RegOffset::COff));
+	static_assert(!IsWritableRange(RegOffset::VCell, RegOffset::VCell));
+	static_assert(!IsWritableRange(RegOffset::RCell, RegOffset::AvgTA));
+	static_assert(HasRegisterAccess(RegOffset::RComp0, RegisterAccess::Learning));
+	static_assert(!HasRegisterAccess(RegOffset::Command, RegisterAccess::Read));
+	static_assert(Fields::IChgTerm::Register == RegOffset::IChgTerm);
+	static_assert(!Fields::VCell::IsWritable);
+	static_assert(GetVerifyMask(RegOffset::DesignCap) == 0xFFFF);
+	static_assert(GetVerifyMask(RegOffset::RComp0) == 0xFFFF);
+	static_assert(GetVerifyMask(RegOffset::ModelCfg) == 0x7FFF);
+	static_assert(GetVerifyMask(RegOffset::Config2) == 0xFFDE);
+	static_assert(GetVerifyMask(RegOffset::Status) == 0);
+	static_assert(GetVerifyMask(RegOffset::VCell) == 0);
+	static_assert(GetVerifyMask(RegOffset::Command) == 0);
+
+	TEST(RegisterMapTest, TableIsSortedAndUnique)
+	{
+		for (size_t i = 1; i < RegisterTable.size(); i++)
+		{
+			EXPECT_LT(RegUtils::ToInt(RegisterTable[i - 1].Offset), RegUtils::ToInt(RegisterTable[i].Offset));
+		}
+	}
+
+	TEST(RegisterMapTest, TerminationCurrentUsesIChgTerm)
+	{
+		SimulatedGauge gauge;
+		Device<SimulatedGauge, SimulatedClock> device(gauge);
+
+		device.SetDesignCapacity(MicroAmpereHours::FromRaw(6000));
+		device.SetTerminationCurrent(MicroAmperes::FromRaw(640));
+		EXPECT_EQ(device.GetTerminationCurrent().ToRaw(), 640);
+		EXPECT_EQ(device.GetRegisterValue(RegOffset::IChgTerm), 640);
+	}
+
+	TEST(RegisterMapTest, ModelRefreshFlagIsBit15)
+	{
+		SimulatedGauge gauge;
+		Device<SimulatedGauge, SimulatedClock> device(gauge);
+
+		device.SetModelRefreshFlag(true);
+		EXPECT_EQ(device.GetRegisterValue(RegOffset::ModelCfg), 0x8000);
+		EXPECT_TRUE(device.IsModelRefreshFlagSet());
+		EXPECT_FALSE(device.IsHighChargeVoltage());
+	}
+
+	TEST(RegisterMapTest, HibExitTimeIsSeparateFromHibScalar)
+	{
+		SimulatedGauge gauge;
+		Device<SimulatedGauge, SimulatedClock> device(gauge);
+
+		device.SetHibScalar(5);
+		device.SetHibExitTime(2);
+		EXPECT_EQ(device.GetHibScalar(), 5);
+		EXPECT_EQ(device.GetHibExitTime(), 2);
+		EXPECT_EQ(device.GetRegisterValue(RegOffset::HibCfg), 0x0015);
+	}
+
+	TEST(RegisterMapTest, CheckedRangeAccess)
+	{
+		SimulatedGauge gauge;
+		Device<SimulatedGauge, SimulatedClock> device(gauge);
+
+		device.Set<Fields::LearnCfg>(0x4486);
+		device.Set<Fields::FilterCfg>(0xCEA4);
+		ASSERT_TRUE((device.Write<RegOffset::LearnCfg, RegOffset::FilterCfg>()));
+		gauge.Pump();
+		EXPECT_EQ(gauge.PeekRegister(RegOffset::LearnCfg), 0x4486);
+		EXPECT_EQ(gauge.PeekRegister(RegOffset::FilterCfg), 0xCEA4);
+
+		ASSERT_TRUE((device.Read<RegOffset::Status, RegOffset::TTE>()));
+		gauge.Pump();
+		EXPECT_TRUE(device.IsRegisterValid(RegOffset::VCell));
+	}
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include "SimulatedGauge.h"
+#include <type_traits>
+
+namespace PiSubmarine::Max1726
+{
+	namespace
+	{
+		using StatsDevice = Device<SimulatedGauge, SimulatedClock, RegisterStats<SimulatedClock>>;
+
+		uint64_t GetHistogramTotal(const RegisterCounters& counters)
+		{
+			uint64_t total = 0;
+			for (uint64_t bucket : counters.LatencyHistogram)
+			{
+				total += bucket;
+			}
+			return total;
+		}
+	}
+
+	TEST(RegisterStatsTest, DisabledPolicyIsEmpty)
+	{
+		EXPECT_TRUE(std::is_empty_v<NoRegisterStats>);
+		EXPECT_LT(sizeof(Device<SimulatedGauge, SimulatedClock>), sizeof(StatsDevice));
+	}
+
+	TEST(RegisterStatsTest, BurstReadCountsEveryRegister)
+	{
+		SimulatedGauge gauge;
+		StatsDevice device(gauge);
+
+		ASSERT_TRUE(device.ReadTelemetry());
+		gauge.Pump();
+		ASSERT_TRUE(device.ReadTelemetry());
+		gauge.Pump();
+
+		for (uint8_t offset = RegUtils::ToInt(StatsDevice::TelemetryFirst); offset <= RegUtils::ToInt(StatsDevice::TelemetryLast); offset++)
+		{
+			auto counters = device.GetRegisterStats().Get(static_cast<RegOffset>(offset));
+			EXPECT_EQ(counters.Reads, 2);
+			EXPECT_EQ(counters.ReadBytes, 2 * RegisterSize);
+			EXPECT_EQ(counters.Writes, 0);
+			EXPECT_EQ(counters.Errors, 0);
+		}
+
+		EXPECT_EQ(GetHistogramTotal(device.GetRegisterStats().Get(StatsDevice::TelemetryFirst)), 2);
+		EXPECT_EQ(GetHistogramTotal(device.GetRegisterStats().Get(RegOffset::VCell)), 0);
+		EXPECT_EQ(device.GetRegisterStats().Get(RegOffset::DesignCap).Reads, 0);
+	}
+
+	TEST(RegisterStatsTest, LatencyIsBucketedByIssueToCallbackTime)
+	{
+		SimulatedGauge gauge;
+		StatsDevice device(gauge);
+
+		ASSERT_TRUE(device.Read(RegOffset::Status));
+		SimulatedClock::Advance(std::chrono::microseconds(100));
+		gauge.Pump();
+
+		auto counters = device.GetRegisterStats().Get(RegOffset::Status);
+		size_t bucket = 0;
+		while (counters.LatencyHistogram[bucket] == 0)
+		{
+			bucket++;
+		}
+		EXPECT_GE(RegisterStats<SimulatedClock>::GetBucketUpperBound(bucket), std::chrono::microseconds(100));
+		EXPECT_LT(RegisterStats<SimulatedClock>::GetBucketUpperBound(bucket), std::chrono::microseconds(1000));
+	}
+
+	TEST(RegisterStatsTest, WritesAndErrorsAreCounted)
+	{
+		SimulatedGauge gauge;
+		StatsDevice device(gauge);
+
+		device.SetDesignCapacity(MicroAmpereHours::FromRaw(6000));
+		device.SetTerminationCurrent(MicroAmperes::FromRaw(640));
+		ASSERT_TRUE(device.WriteDirty());
+		gauge.Pump();
+		EXPECT_EQ(device.GetRegisterStats().Get(RegOffset::DesignCap).Writes, 1);
+		EXPECT_EQ(device.GetRegisterStats().Get(RegOffset::DesignCap).WriteBytes, RegisterSize);
+		EXPECT_EQ(device.GetRegisterStats().Get(RegOffset::IChgTerm).Writes, 1);
+
+		gauge.SetSimulateError(true);
+		device.Read(RegOffset::RepCap, RegOffset::RepSOC);
+		gauge.Pump();
+		EXPECT_TRUE(device.HasError());
+		EXPECT_EQ(device.GetRegisterStats().Get(RegOffset::RepCap).Errors, 1);
+		EXPECT_EQ(device.GetRegisterStats().Get(RegOffset::RepSOC).Errors, 1);
+		EXPECT_EQ(device.GetRegisterStats().Get(RegOffset::RepCap).Reads, 0);
+	}
+}
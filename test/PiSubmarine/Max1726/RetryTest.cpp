@@ -0,0 +1,190 @@
+#include <gtest/gtest.h>
+#include "SimulatedGauge.h"
+#include <chrono>
+#include <functional>
+#include <utility>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace PiSubmarine::Max1726
+{
+	namespace
+	{
+		using StatsDevice = Device<SimulatedGauge, SimulatedClock, RegisterStats<SimulatedClock>>;
+
+		// Three dirty runs: VAlrtTh..SAlrtTh, DesignCap and IChgTerm
+		void MakeDirtyRuns(StatsDevice& device)
+		{
+			device.SetRegisterValue(RegOffset::VAlrtTh, 0xFF00);
+			device.SetRegisterValue(RegOffset::TAlrtTh, 0x7F80);
+			device.SetRegisterValue(RegOffset::SAlrtTh, 0xFF00);
+			device.SetRegisterValue(RegOffset::DesignCap, 0x1770);
+			device.SetRegisterValue(RegOffset::IChgTerm, 0x0280);
+		}
+
+		RetryPolicy MakePolicy(uint8_t maxAttempts)
+		{
+			RetryPolicy policy;
+			policy.MaxAttempts = maxAttempts;
+			policy.InitialBackoff = 1ms;
+			policy.MaxBackoff = 20ms;
+			return policy;
+		}
+	}
+
+	TEST(RetryTest, WriteDirtyRetriesOnlyTheFailedRun)
+	{
+		SimulatedGauge gauge;
+		StatsDevice device(gauge);
+		auto wait = gauge.GetWaitFunc();
+		device.SetScheduler(gauge.GetScheduleFunc());
+		ASSERT_TRUE(device.SetRetryPolicy(MakePolicy(3)));
+		MakeDirtyRuns(device);
+
+		// First run goes through, DesignCap fails twice
+		gauge.FailTransfers(1, 2);
+		uint64_t transfers = gauge.GetTransactionCount();
+		ASSERT_TRUE(device.WriteDirty());
+		ASSERT_TRUE(device.WaitForTransaction(wait));
+
+		EXPECT_EQ(gauge.GetTransactionCount() - transfers, 3);
+		EXPECT_EQ(device.GetWriteDirtyTransactionCount(), 5);
+		EXPECT_FALSE(device.HasDirtyRegisters());
+		EXPECT_EQ(gauge.PeekRegister(RegOffset::VAlrtTh), 0xFF00);
+		EXPECT_EQ(gauge.PeekRegister(RegOffset::DesignCap), 0x1770);
+		EXPECT_EQ(gauge.PeekRegister(RegOffset::IChgTerm), 0x0280);
+
+		EXPECT_EQ(device.GetRegisterStats().Get(RegOffset::VAlrtTh).Retries, 0);
+		EXPECT_EQ(device.GetRegisterStats().Get(RegOffset::DesignCap).Retries, 2);
+		EXPECT_EQ(device.GetRegisterStats().Get(RegOffset::DesignCap).Errors, 2);
+		EXPECT_EQ(device.GetRegisterStats().Get(RegOffset::IChgTerm).Retries, 0);
+
+		auto stats = device.GetRecoveryStats();
+		EXPECT_EQ(stats.Retries, 2);
+		EXPECT_EQ(stats.Exhausted, 0);
+		EXPECT_EQ(stats.BusRecoveries, 0);
+		EXPECT_EQ(stats.Recovered, 1);
+
+		// Backoff of 1 ms, then 2 ms, plus the bus time of the attempts
+		EXPECT_GE(stats.TotalRecoveryTime, 3ms);
+		EXPECT_LT(stats.TotalRecoveryTime, 4ms);
+		EXPECT_EQ(stats.MaxRecoveryTime, stats.TotalRecoveryTime);
+	}
+
+	TEST(RetryTest, ExhaustedWriteDirtyRunsBusRecoveryAndResumes)
+	{
+		SimulatedGauge gauge;
+		StatsDevice device(gauge);
+		auto wait = gauge.GetWaitFunc();
+		RetryPolicy policy = MakePolicy(2);
+		policy.RecoveryThreshold = 2;
+		device.SetScheduler(gauge.GetScheduleFunc());
+		ASSERT_TRUE(device.SetRetryPolicy(policy));
+		size_t recoveries = 0;
+		device.SetBusRecovery([&recoveries]() { recoveries++; });
+		MakeDirtyRuns(device);
+
+		gauge.FailTransfers(1, 2);
+		ASSERT_TRUE(device.WriteDirty());
+		EXPECT_FALSE(device.WaitForTransaction(wait));
+		EXPECT_EQ(recoveries, 1);
+		EXPECT_FALSE(device.GetRegisters()[RegUtils::ToInt(RegOffset::VAlrtTh)].IsDirty);
+		EXPECT_TRUE(device.GetRegisters()[RegUtils::ToInt(RegOffset::DesignCap)].IsDirty);
+		EXPECT_TRUE(device.GetRegisters()[RegUtils::ToInt(RegOffset::IChgTerm)].IsDirty);
+
+		auto stats = device.GetRecoveryStats();
+		EXPECT_EQ(stats.Retries, 1);
+		EXPECT_EQ(stats.Exhausted, 1);
+		EXPECT_EQ(stats.BusRecoveries, 1);
+		EXPECT_EQ(stats.Recovered, 0);
+
+		// The next WriteDirty only sends what is left
+		ASSERT_TRUE(device.WriteDirty());
+		EXPECT_TRUE(device.WaitForTransaction(wait));
+		EXPECT_EQ(device.GetWriteDirtyTransactionCount(), 2);
+		EXPECT_FALSE(device.HasDirtyRegisters());
+		EXPECT_EQ(gauge.PeekRegister(RegOffset::DesignCap), 0x1770);
+		EXPECT_EQ(device.GetRecoveryStats().Recovered, 1);
+	}
+
+	TEST(RetryTest, RefusedReadIsRetried)
+	{
+		SimulatedGauge gauge;
+		StatsDevice device(gauge);
+		auto wait = gauge.GetWaitFunc();
+		device.SetScheduler(gauge.GetScheduleFunc());
+		ASSERT_TRUE(device.SetRetryPolicy(MakePolicy(2)));
+
+		// The offset write is synchronous, so the driver refuses the transaction before anything is in flight
+		gauge.FailTransfers(0, 1);
+		ASSERT_TRUE(device.ReadAndWait(RegOffset::DesignCap, wait));
+		EXPECT_EQ(device.GetRecoveryStats().Retries, 1);
+		EXPECT_EQ(device.GetRegisterStats().Get(RegOffset::DesignCap).Retries, 1);
+		EXPECT_EQ(device.GetRegisterStats().Get(RegOffset::DesignCap).Reads, 1);
+	}
+
+	TEST(RetryTest, BackoffIsScheduledNotSlept)
+	{
+		SimulatedGauge gauge;
+		StatsDevice device(gauge);
+		std::vector<std::pair<std::chrono::microseconds, std::function<void()>>> tasks;
+		device.SetScheduler([&tasks](std::chrono::microseconds delay, std::function<void()> task) { tasks.emplace_back(delay, std::move(task)); });
+		ASSERT_TRUE(device.SetRetryPolicy(MakePolicy(2)));
+
+		// The read itself fails in the completion callback, which must return without waiting out the backoff
+		gauge.FailTransfers(1, 1);
+		auto start = SimulatedClock::now();
+		ASSERT_TRUE(device.Read(RegOffset::DesignCap));
+		gauge.Pump();
+		ASSERT_EQ(tasks.size(), 1);
+		EXPECT_EQ(tasks[0].first, 1ms);
+		EXPECT_LT(SimulatedClock::now() - start, 1ms);
+		EXPECT_TRUE(device.IsTransactionInProgress());
+
+		tasks[0].second();
+		gauge.Pump();
+		EXPECT_FALSE(device.IsTransactionInProgress());
+		EXPECT_FALSE(device.HasError());
+		EXPECT_EQ(device.GetRecoveryStats().Retries, 1);
+		EXPECT_EQ(device.GetRecoveryStats().Recovered, 1);
+	}
+
+	TEST(RetryTest, InitBlockingRidesOutTransientGlitch)
+	{
+		SimulatedGauge failingGauge;
+		StatsDevice failing(failingGauge);
+		failingGauge.FailTransfers(6, 1);
+		EXPECT_FALSE(failing.InitBlocking(failingGauge.GetWaitFunc(), MicroAmpereHours(3000000), MicroAmperes::FromRaw(640), MicroVolts(3300000)));
+
+		SimulatedGauge gauge;
+		StatsDevice device(gauge);
+		device.SetScheduler(gauge.GetScheduleFunc());
+		ASSERT_TRUE(device.SetRetryPolicy(MakePolicy(3)));
+		gauge.FailTransfers(6, 1);
+		EXPECT_TRUE(device.InitBlocking(gauge.GetWaitFunc(), MicroAmpereHours(3000000), MicroAmperes::FromRaw(640), MicroVolts(3300000)));
+		EXPECT_EQ(device.GetRecoveryStats().Retries, 1);
+		EXPECT_EQ(device.GetRecoveryStats().Exhausted, 0);
+	}
+
+	TEST(RetryTest, RetriesNeedScheduler)
+	{
+		SimulatedGauge gauge;
+		StatsDevice device(gauge);
+
+		// Without a scheduler retries would fire back to back, ignoring the backoff
+		EXPECT_FALSE(device.SetRetryPolicy(MakePolicy(3)));
+		EXPECT_EQ(device.GetRetryPolicy().MaxAttempts, 1);
+		EXPECT_TRUE(device.SetRetryPolicy(MakePolicy(1)));
+
+		device.SetScheduler(gauge.GetScheduleFunc());
+		ASSERT_TRUE(device.SetRetryPolicy(MakePolicy(3)));
+		EXPECT_EQ(device.GetRetryPolicy().MaxAttempts, 3);
+
+		device.SetScheduler(nullptr);
+		EXPECT_EQ(device.GetRetryPolicy().MaxAttempts, 1);
+		gauge.FailTransfers(1, 1);
+		EXPECT_FALSE(device.ReadAndWait(RegOffset::DesignCap, gauge.GetWaitFunc()));
+		EXPECT_EQ(device.GetRecoveryStats().Retries, 0);
+	}
+}
@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+#include "PiSubmarine/Max1726/SeqLock.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace PiSubmarine::Max1726
+{
+	namespace
+	{
+		struct Sample
+		{
+			uint64_t A = 0;
+			uint64_t B = 0;
+			uint32_t C = 0;
+		};
+	}
+
+	TEST(SeqLockTest, StoreAndLoad)
+	{
+		SeqLock<Sample> lock;
+		EXPECT_EQ(lock.GetVersion(), 0);
+		lock.Store(Sample{ 1, 2, 3 });
+		Sample sample = lock.Load();
+		EXPECT_EQ(sample.A, 1);
+		EXPECT_EQ(sample.B, 2);
+		EXPECT_EQ(sample.C, 3);
+		EXPECT_EQ(lock.GetVersion(), 1);
+	}
+
+	TEST(SeqLockTest, ReadersNeverSeeTornValues)
+	{
+		SeqLock<Sample> lock;
+		std::atomic<bool> done = false;
+		std::atomic<size_t> torn = 0;
+
+		std::vector<std::jthread> readers;
+		for (int i = 0; i < 3; i++)
+		{
+			readers.emplace_back([&]() {
+				while (!done)
+				{
+					Sample sample = lock.Load();
+					if (sample.B != sample.A * 2 || sample.C != static_cast<uint32_t>(sample.A * 3))
+					{
+						torn++;
+					}
+				}
+				});
+		}
+
+		for (uint64_t i = 0; i < 200000; i++)
+		{
+			lock.Store(Sample{ i, i * 2, static_cast<uint32_t>(i * 3) });
+		}
+		done = true;
+		readers.clear();
+
+		EXPECT_EQ(torn, 0);
+	}
+}
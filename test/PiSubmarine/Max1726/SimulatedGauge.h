@@ -0,0 +1,635 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <vector>
+#include "PiSubmarine/Api/Internal/I2C/Callback.h"
+#include "PiSubmarine/Api/Internal/I2C/DriverConcept.h"
+#include "PiSubmarine/Max1726/Max1726.h"
+#include "PiSubmarine/Max1726/RegisterMap.h"
+
+namespace PiSubmarine::Max1726
+{
+	/// <summary>
+	/// Virtual time source shared by SimulatedGauge and the Device under test. Only moves when advanced explicitly.
+	/// </summary>
+	struct SimulatedClock
+	{
+		using rep = int64_t;
+		using period = std::nano;
+		using duration = std::chrono::duration<rep, period>;
+		using time_point = std::chrono::time_point<SimulatedClock>;
+		constexpr static bool is_steady = true;
+
+		static time_point now()
+		{
+			return time_point(duration(s_Now));
+		}
+
+		static void Advance(duration value)
+		{
+			s_Now += value.count();
+		}
+
+	private:
+		inline static rep s_Now = 0;
+	};
+
+	struct SimulatedBattery
+	{
+		double CapacityAh = 3.0;
+		double InitialSoc = 0.8;
+		double ResistanceOhms = 0.05;
+		double TemperatureCelsius = 25.0;
+
+		/// <summary>
+		/// Shunt the gauge measures current across. Raw Current and capacity registers scale with it.
+		/// </summary>
+		double RSenseOhms = 0.01;
+	};
+
+	/// <summary>
+	/// Simulated MAX1726x behind an I2C driver. Implements RegisterTable access modes and reset values,
+	/// power-on reset, data-not-ready and model refresh timing, hibernate mode per HibCfg, and a battery model updated once per task period.
+	/// At* registers follow a write to AtRate on the next task, like the real gauge.
+	/// Runs in virtual time: asynchronous transactions complete in Pump(), each one advancing SimulatedClock by its bus time.
+	/// Tasks from GetScheduleFunc() also run in Pump(), with the clock moved forward to their due time.
+	/// </summary>
+	class SimulatedGauge
+	{
+	public:
+		using TimePoint = SimulatedClock::time_point;
+
+		/// <summary>
+		/// Battery current in amperes as a function of seconds since construction. Positive current charges the cell.
+		/// </summary>
+		using LoadProfile = std::function<double(double seconds)>;
+
+		constexpr static uint8_t Address = 0x36;
+		constexpr static uint32_t BusFrequency = 400000;
+		constexpr static std::chrono::milliseconds DataNotReadyTime{ 710 };
+		constexpr static std::chrono::milliseconds ModelRefreshTime{ 350 };
+
+		SimulatedGauge(SimulatedBattery battery = {}) : m_Battery(battery)
+		{
+			m_StartTime = SimulatedClock::now();
+			m_Charge = battery.CapacityAh * battery.InitialSoc;
+			PowerOnReset();
+		}
+
+		bool Read(uint8_t deviceAddress, uint8_t* rxData, size_t len)
+		{
+			if (deviceAddress != Address || m_SimulateError || IsGlitch())
+			{
+				return false;
+			}
+			Transfer(len + 1);
+			for (size_t i = 0; i < len / RegisterSize; i++)
+			{
+				uint16_t value = ReadRegister(static_cast<uint8_t>(m_Offset + i));
+				rxData[i * RegisterSize] = static_cast<uint8_t>(value & 0xFF);
+				rxData[i * RegisterSize + 1] = static_cast<uint8_t>(value >> 8);
+			}
+			return true;
+		}
+
+		bool Write(uint8_t deviceAddress, uint8_t* txData, size_t len)
+		{
+			if (deviceAddress != Address || m_SimulateError || len == 0 || IsGlitch())
+			{
+				return false;
+			}
+			Transfer(len + 1);
+			m_Offset = txData[0];
+			for (size_t i = 0; i < (len - 1) / RegisterSize; i++)
+			{
+				uint16_t value = static_cast<uint16_t>(txData[1 + i * RegisterSize] | (txData[2 + i * RegisterSize] << 8));
+				WriteRegister(static_cast<uint8_t>(m_Offset + i), value);
+			}
+			return true;
+		}
+
+		bool ReadAsync(uint8_t deviceAddress, uint8_t* rxData, size_t len, Api::Internal::I2C::Callback callback)
+		{
+			return Enqueue(deviceAddress, rxData, len, std::move(callback), false);
+		}
+
+		bool WriteAsync(uint8_t deviceAddress, uint8_t* txData, size_t len, Api::Internal::I2C::Callback callback)
+		{
+			if (len > m_TxData.size())
+			{
+				return false;
+			}
+			memcpy(m_TxData.data(), txData, len);
+			return Enqueue(deviceAddress, m_TxData.data(), len, std::move(callback), true);
+		}
+
+		/// <summary>
+		/// Completes pending asynchronous transactions and scheduled tasks, including the ones started from completion callbacks.
+		/// </summary>
+		/// <returns>Number of completed transactions.</returns>
+		size_t Pump()
+		{
+			size_t completed = 0;
+			while (m_HasRequest || !m_Tasks.empty())
+			{
+				if (!m_HasRequest)
+				{
+					RunNextTask();
+					continue;
+				}
+
+				m_HasRequest = false;
+				bool ok = m_Request.IsWrite ? Write(m_Request.DeviceAddress, m_Request.Data, m_Request.Len) : Read(m_Request.DeviceAddress, m_Request.Data, m_Request.Len);
+				Api::Internal::I2C::Callback callback = std::move(m_Request.Callback);
+				callback(m_Request.DeviceAddress, ok);
+				completed++;
+			}
+			return completed;
+		}
+
+		/// <summary>
+		/// Completes pending transactions, then moves virtual time forward and updates the battery model.
+		/// </summary>
+		void Advance(SimulatedClock::duration duration)
+		{
+			TimePoint target = SimulatedClock::now() + duration;
+			Pump();
+			TimePoint now = SimulatedClock::now();
+			if (target > now)
+			{
+				SimulatedClock::Advance(target - now);
+			}
+			Update();
+		}
+
+		/// <summary>
+		/// Returns wait function for Device blocking calls. Waiting advances virtual time instead of sleeping.
+		/// </summary>
+		std::function<void(std::chrono::milliseconds)> GetWaitFunc()
+		{
+			return [this](std::chrono::milliseconds duration) { Advance(duration); };
+		}
+
+		/// <summary>
+		/// Scheduler for Device::SetScheduler. Tasks run from Pump() in due order.
+		/// </summary>
+		ScheduleFunc GetScheduleFunc()
+		{
+			return [this](std::chrono::microseconds delay, std::function<void()> task) {
+				m_Tasks.push_back(ScheduledTask{ SimulatedClock::now() + std::chrono::duration_cast<SimulatedClock::duration>(delay), std::move(task) });
+				};
+		}
+
+		void SetLoadProfile(LoadProfile profile)
+		{
+			m_LoadProfile = std::move(profile);
+		}
+
+		void SetSimulateError(bool value)
+		{
+			m_SimulateError = value;
+		}
+
+		/// <summary>
+		/// Simulates a transient bus fault: after skip more successful transfers, the next count transfers fail.
+		/// A register read is two transfers, the offset write and the read.
+		/// </summary>
+		void FailTransfers(uint64_t skip, uint64_t count)
+		{
+			m_GlitchSkip = skip;
+			m_GlitchCount = count;
+		}
+
+		/// <summary>
+		/// Simulates a corrupted write: the next count writes to a register are acknowledged but not latched.
+		/// </summary>
+		void DropWrites(RegOffset reg, uint64_t count)
+		{
+			m_DroppedRegister = reg;
+			m_DropCount = count;
+		}
+
+		void SetTemperature(double celsius)
+		{
+			m_Battery.TemperatureCelsius = celsius;
+		}
+
+		/// <summary>
+		/// Returns state of the ALRT pin: Config.Aen is set and any alert flag is raised in Status.
+		/// </summary>
+		bool IsAlertAsserted() const
+		{
+			constexpr uint16_t alertFlags = 0x77C4;
+			return (m_Registers[RegUtils::ToInt(RegOffset::Config)] & 0x0004) && (m_Registers[RegUtils::ToInt(RegOffset::Status)] & alertFlags);
+		}
+
+		/// <summary>
+		/// Returns state of charge of the simulated cell, 0 to 1.
+		/// </summary>
+		double GetTrueSoc() const
+		{
+			return m_Charge / m_Battery.CapacityAh;
+		}
+
+		Command GetLastCommand() const
+		{
+			return m_LastCommand;
+		}
+
+		uint16_t PeekRegister(RegOffset reg) const
+		{
+			return m_Registers[RegUtils::ToInt(reg)];
+		}
+
+		void PokeRegister(RegOffset reg, uint16_t value)
+		{
+			m_Registers[RegUtils::ToInt(reg)] = value;
+		}
+
+		uint64_t GetTransactionCount() const
+		{
+			return m_TransactionCount;
+		}
+
+		bool IsHibernating() const
+		{
+			return m_IsHibernating;
+		}
+
+		uint64_t GetByteCount() const
+		{
+			return m_ByteCount;
+		}
+
+		/// <summary>
+		/// Restores registers to their power-on defaults and sets Status.POR and FStat.DNR, like a power cycle or a reset command.
+		/// </summary>
+		void PowerOnReset()
+		{
+			m_Registers.fill(0);
+			for (const auto& descriptor : RegisterTable)
+			{
+				m_Registers[RegUtils::ToInt(descriptor.Offset)] = descriptor.ResetValue;
+			}
+			m_DataReadyTime = SimulatedClock::now() + DataNotReadyTime;
+			m_IsRefreshing = false;
+			m_IsHibernating = false;
+			m_HibernateTimer = 0;
+			m_CoulombCount = 0;
+			m_NextTask = SimulatedClock::now();
+			Update();
+		}
+
+	private:
+		struct Request
+		{
+			uint8_t DeviceAddress = 0;
+			uint8_t* Data = nullptr;
+			size_t Len = 0;
+			Api::Internal::I2C::Callback Callback;
+			bool IsWrite = false;
+		};
+
+		struct ScheduledTask
+		{
+			TimePoint Due;
+			std::function<void()> Task;
+		};
+
+		SimulatedBattery m_Battery;
+		LoadProfile m_LoadProfile = [](double) { return -0.5; };
+		std::array<uint16_t, RegisterCount> m_Registers{};
+		std::array<uint8_t, MemorySize + 1> m_TxData{};
+		Request m_Request;
+		bool m_HasRequest = false;
+		std::vector<ScheduledTask> m_Tasks;
+		bool m_SimulateError = false;
+		uint64_t m_GlitchSkip = 0;
+		uint64_t m_GlitchCount = 0;
+		RegOffset m_DroppedRegister{};
+		uint64_t m_DropCount = 0;
+		uint8_t m_Offset = 0;
+		Command m_LastCommand = Command::Clear;
+		uint64_t m_TransactionCount = 0;
+		uint64_t m_ByteCount = 0;
+		TimePoint m_StartTime{};
+		TimePoint m_NextTask{};
+		TimePoint m_DataReadyTime{};
+		TimePoint m_RefreshDoneTime{};
+		bool m_IsRefreshing = false;
+		double m_Charge = 0;
+		double m_AverageCurrent = 0;
+
+		/// <summary>
+		/// Charge behind QH in Ah since power-on reset. Wraps in the register like the real coulomb counter.
+		/// </summary>
+		double m_CoulombCount = 0;
+		uint8_t m_LastSocPercent = 0;
+		bool m_IsHibernating = false;
+
+		/// <summary>
+		/// Seconds the current has stayed on the other side of the hibernate threshold.
+		/// </summary>
+		double m_HibernateTimer = 0;
+
+		void RunNextTask()
+		{
+			auto next = std::min_element(m_Tasks.begin(), m_Tasks.end(), [](const ScheduledTask& a, const ScheduledTask& b) { return a.Due < b.Due; });
+			ScheduledTask task = std::move(*next);
+			m_Tasks.erase(next);
+			TimePoint now = SimulatedClock::now();
+			if (task.Due > now)
+			{
+				SimulatedClock::Advance(task.Due - now);
+				Update();
+			}
+			task.Task();
+		}
+
+		bool Enqueue(uint8_t deviceAddress, uint8_t* data, size_t len, Api::Internal::I2C::Callback callback, bool isWrite)
+		{
+			if (m_HasRequest)
+			{
+				return false;
+			}
+			m_Request.DeviceAddress = deviceAddress;
+			m_Request.Data = data;
+			m_Request.Len = len;
+			m_Request.Callback = std::move(callback);
+			m_Request.IsWrite = isWrite;
+			m_HasRequest = true;
+			return true;
+		}
+
+		/// <summary>
+		/// Consumes one transfer of the fault set up by FailTransfers.
+		/// </summary>
+		bool IsGlitch()
+		{
+			if (m_GlitchCount == 0)
+			{
+				return false;
+			}
+			if (m_GlitchSkip > 0)
+			{
+				m_GlitchSkip--;
+				return false;
+			}
+			m_GlitchCount--;
+			return true;
+		}
+
+		/// <summary>
+		/// Accounts for bus time: 9 clocks per byte including the address byte.
+		/// </summary>
+		void Transfer(size_t bytes)
+		{
+			m_TransactionCount++;
+			m_ByteCount += bytes;
+			SimulatedClock::Advance(std::chrono::duration_cast<SimulatedClock::duration>(std::chrono::duration<double>(bytes * 9.0 / BusFrequency)));
+			Update();
+		}
+
+		uint16_t ReadRegister(uint8_t offset) const
+		{
+			auto reg = static_cast<RegOffset>(offset);
+			if (IsRegisterDefined(reg) && !HasRegisterAccess(reg, RegisterAccess::Read))
+			{
+				return 0;
+			}
+			return m_Registers[offset];
+		}
+
+		void WriteRegister(uint8_t offset, uint16_t value)
+		{
+			if (!HasRegisterAccess(static_cast<RegOffset>(offset), RegisterAccess::Write))
+			{
+				return;
+			}
+			if (m_DropCount > 0 && static_cast<RegOffset>(offset) == m_DroppedRegister)
+			{
+				m_DropCount--;
+				return;
+			}
+
+			switch (static_cast<RegOffset>(offset))
+			{
+			case RegOffset::Command:
+				m_LastCommand = static_cast<Command>(value);
+				if (m_LastCommand == Command::Reset)
+				{
+					PowerOnReset();
+				}
+				return;
+			case RegOffset::Config2:
+				if (value & 0x0001)
+				{
+					PowerOnReset();
+					return;
+				}
+				break;
+			case RegOffset::ModelCfg:
+				if (value & 0x8000)
+				{
+					m_IsRefreshing = true;
+					m_RefreshDoneTime = SimulatedClock::now() + ModelRefreshTime;
+				}
+				break;
+			default:
+				break;
+			}
+			m_Registers[offset] = value;
+		}
+
+		/// <summary>
+		/// Runs battery model and register update for every task period elapsed since the last update.
+		/// </summary>
+		void Update()
+		{
+			TimePoint now = SimulatedClock::now();
+			if (now >= m_DataReadyTime)
+			{
+				m_Registers[RegUtils::ToInt(RegOffset::FStat)] &= static_cast<uint16_t>(~RegUtils::ToInt(FStat::DataNotReady));
+			}
+
+			if (m_IsRefreshing && now >= m_RefreshDoneTime)
+			{
+				m_IsRefreshing = false;
+				m_Registers[RegUtils::ToInt(RegOffset::ModelCfg)] &= 0x7FFF;
+				m_Registers[RegUtils::ToInt(RegOffset::FullCapRep)] = m_Registers[RegUtils::ToInt(RegOffset::DesignCap)];
+				m_Registers[RegUtils::ToInt(RegOffset::FullCapNom)] = m_Registers[RegUtils::ToInt(RegOffset::DesignCap)];
+			}
+
+			while (now >= m_NextTask)
+			{
+				auto period = GetTaskPeriod();
+				Step(std::chrono::duration<double>(period).count());
+				m_NextTask += std::chrono::duration_cast<SimulatedClock::duration>(period);
+			}
+		}
+
+		void Step(double dt)
+		{
+			double seconds = std::chrono::duration<double>(m_NextTask - m_StartTime).count();
+			double current = m_LoadProfile(seconds);
+			m_Charge = std::clamp(m_Charge + current * dt / 3600.0, 0.0, m_Battery.CapacityAh);
+			m_AverageCurrent += (current - m_AverageCurrent) * dt / (dt + 5.625);
+			m_CoulombCount += current * dt / 3600.0;
+
+			double soc = GetTrueSoc();
+			double voltage = GetOpenCircuitVoltage(soc) + current * m_Battery.ResistanceOhms;
+			double fullCapacity = m_Registers[RegUtils::ToInt(RegOffset::FullCapRep)] * 5e-6 / m_Battery.RSenseOhms;
+			double remaining = fullCapacity * soc;
+
+			Set(RegOffset::Current, ToRawCurrent(current));
+			Set(RegOffset::AvgCurrent, ToRawCurrent(m_AverageCurrent));
+			Set(RegOffset::VCell, Saturate(voltage / 78.125e-6, 0, 0xFFFF));
+			Set(RegOffset::Temp, Saturate(m_Battery.TemperatureCelsius * 256.0, INT16_MIN, INT16_MAX));
+			Set(RegOffset::RepSOC, Saturate(soc * 100.0 * 256.0, 0, 0xFFFF));
+			Set(RegOffset::RepCap, Saturate(remaining / (5e-6 / m_Battery.RSenseOhms), 0, 0xFFFF));
+			Set(RegOffset::TTE, m_AverageCurrent < 0 ? Saturate(remaining / -m_AverageCurrent * 3600.0 / 5.625, 0, 0xFFFF) : 0xFFFF);
+			Set(RegOffset::QH, std::lround(m_CoulombCount / (5e-6 / m_Battery.RSenseOhms)));
+			Set(RegOffset::Power, Saturate(voltage * current / (8e-6 / m_Battery.RSenseOhms), INT16_MIN, INT16_MAX));
+			Set(RegOffset::AvgPower, Saturate(voltage * m_AverageCurrent / (8e-6 / m_Battery.RSenseOhms), INT16_MIN, INT16_MAX));
+			UpdateAtRate();
+			RaiseAlerts();
+			UpdateHibernate(current, fullCapacity, dt);
+		}
+
+		std::chrono::microseconds GetTaskPeriod() const
+		{
+			return m_IsHibernating ? HibernateTaskPeriod * (1 << (m_Registers[RegUtils::ToInt(RegOffset::HibCfg)] & 0x07)) : ActiveTaskPeriod;
+		}
+
+		/// <summary>
+		/// Enters hibernate after |Current| stays below HibThreshold for HibEnterTime and leaves it after it stays above for HibExitTime.
+		/// </summary>
+		void UpdateHibernate(double current, double fullCapacity, double dt)
+		{
+			uint16_t hibCfg = m_Registers[RegUtils::ToInt(RegOffset::HibCfg)];
+			if (!(hibCfg & 0x8000))
+			{
+				m_IsHibernating = false;
+				m_HibernateTimer = 0;
+				return;
+			}
+
+			double threshold = fullCapacity / 0.8 / (1 << ((hibCfg >> 8) & 0x0F));
+			bool isCrossing = m_IsHibernating ? std::abs(current) > threshold : std::abs(current) < threshold;
+			if (!isCrossing)
+			{
+				m_HibernateTimer = 0;
+				return;
+			}
+
+			double enterTime = ((1 << ((hibCfg >> 12) & 0x07)) - 1) * 5.625;
+			double exitTime = (((hibCfg >> 3) & 0x03) + 1) * 0.702 * (1 << (hibCfg & 0x07));
+			m_HibernateTimer += dt;
+			if (m_HibernateTimer >= (m_IsHibernating ? exitTime : enterTime))
+			{
+				m_IsHibernating = !m_IsHibernating;
+				m_HibernateTimer = 0;
+			}
+		}
+
+		/// <summary>
+		/// Evaluates the At* registers for the load in AtRate. Residual is the charge left when the loaded cell voltage reaches VEmpty.
+		/// </summary>
+		void UpdateAtRate()
+		{
+			double rate = static_cast<int16_t>(m_Registers[RegUtils::ToInt(RegOffset::AtRate)]) * 1.5625e-6 / m_Battery.RSenseOhms;
+			double emptyVoltage = (m_Registers[RegUtils::ToInt(RegOffset::VEmpty)] >> 7) * 0.01;
+			double capacityLsb = 5e-6 / m_Battery.RSenseOhms;
+			double fullCapacity = m_Registers[RegUtils::ToInt(RegOffset::FullCapRep)] * capacityLsb;
+
+			double residualSoc = 0;
+			while (residualSoc < 1.0 && GetOpenCircuitVoltage(residualSoc) + rate * m_Battery.ResistanceOhms < emptyVoltage)
+			{
+				residualSoc += 0.001;
+			}
+			double residual = fullCapacity * residualSoc;
+			double available = std::max(fullCapacity * GetTrueSoc() - residual, 0.0);
+
+			Set(RegOffset::AtQResidual, Saturate(residual / capacityLsb, 0, 0xFFFF));
+			Set(RegOffset::AtAvCap, Saturate(available / capacityLsb, 0, 0xFFFF));
+			Set(RegOffset::AtAvSOC, fullCapacity > 0 ? Saturate(available / fullCapacity * 100.0 * 256.0, 0, 0xFFFF) : 0);
+			Set(RegOffset::AtTTE, rate < 0 ? Saturate(available / -rate * 3600.0 / 5.625, 0, 0xFFFF) : 0xFFFF);
+		}
+
+		/// <summary>
+		/// Compares measurements against the threshold registers. Every threshold LSB equals 256 LSB of its measurement, so only the high byte is compared.
+		/// Flags stay set until the host clears them.
+		/// </summary>
+		void RaiseAlerts()
+		{
+			auto check = [this](RegOffset reg, RegOffset threshold, bool isSigned, Status minFlag, Status maxFlag) {
+				uint16_t raw = m_Registers[RegUtils::ToInt(reg)];
+				uint16_t limits = m_Registers[RegUtils::ToInt(threshold)];
+				int value = isSigned ? static_cast<int16_t>(raw) >> 8 : raw >> 8;
+				int min = isSigned ? static_cast<int8_t>(limits & 0xFF) : limits & 0xFF;
+				int max = isSigned ? static_cast<int8_t>(limits >> 8) : limits >> 8;
+				if (value < min)
+				{
+					RaiseStatus(minFlag);
+				}
+				if (value > max)
+				{
+					RaiseStatus(maxFlag);
+				}
+				};
+			check(RegOffset::VCell, RegOffset::VAlrtTh, false, Status::MinimumVoltageAlert, Status::MaximumVoltageAlert);
+			check(RegOffset::Temp, RegOffset::TAlrtTh, true, Status::MinimumTemperatureAlert, Status::MaximumTemperatureAlert);
+			check(RegOffset::RepSOC, RegOffset::SAlrtTh, false, Status::MinimumStateOfCharge, Status::MaximumStateOfChargeAlert);
+			check(RegOffset::Current, RegOffset::IAlrtTh, true, Status::MinimumCurrentAlert, Status::MaximumCurrentAlert);
+
+			uint8_t socPercent = static_cast<uint8_t>(m_Registers[RegUtils::ToInt(RegOffset::RepSOC)] >> 8);
+			if (socPercent != m_LastSocPercent && (m_Registers[RegUtils::ToInt(RegOffset::Config2)] & 0x0080))
+			{
+				RaiseStatus(Status::StateOfChargeChanged);
+			}
+			m_LastSocPercent = socPercent;
+		}
+
+		void RaiseStatus(Status flag)
+		{
+			m_Registers[RegUtils::ToInt(RegOffset::Status)] |= RegUtils::ToInt(flag);
+		}
+
+		void Set(RegOffset reg, int64_t value)
+		{
+			m_Registers[RegUtils::ToInt(reg)] = static_cast<uint16_t>(value);
+		}
+
+		static int64_t Saturate(double value, int64_t min, int64_t max)
+		{
+			return std::clamp(static_cast<int64_t>(std::lround(value)), min, max);
+		}
+
+		int64_t ToRawCurrent(double amperes) const
+		{
+			return Saturate(amperes * m_Battery.RSenseOhms / 1.5625e-6, INT16_MIN, INT16_MAX);
+		}
+
+		static double GetOpenCircuitVoltage(double soc)
+		{
+			constexpr std::array<std::pair<double, double>, 6> table{ {
+				{ 0.0, 3.00 }, { 0.1, 3.45 }, { 0.3, 3.62 }, { 0.5, 3.72 }, { 0.9, 4.02 }, { 1.0, 4.20 }
+			} };
+			for (size_t i = 1; i < table.size(); i++)
+			{
+				if (soc <= table[i].first)
+				{
+					double k = (soc - table[i - 1].first) / (table[i].first - table[i - 1].first);
+					return table[i - 1].second + k * (table[i].second - table[i - 1].second);
+				}
+			}
+			return table.back().second;
+		}
+	};
+}
@@ -0,0 +1,262 @@
+#include <gtest/gtest.h>
+#include "SimulatedGauge.h"
+#include <array>
+#include <chrono>
+#include <functional>
+#include <span>
+#include <utility>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace PiSubmarine::Max1726
+{
+	TEST(SimulatedGaugeTest, InitBlockingWaitsForDataReadyAndModelRefresh)
+	{
+		SimulatedGauge gauge;
+		Device<SimulatedGauge, SimulatedClock> device(gauge);
+
+		auto start = SimulatedClock::now();
+		ASSERT_TRUE(device.InitBlocking(gauge.GetWaitFunc(), MicroAmpereHours::FromRaw(6000), MicroAmperes::FromRaw(640), MicroVolts(3300000)));
+
+		EXPECT_GE(SimulatedClock::now() - start, SimulatedGauge::DataNotReadyTime + SimulatedGauge::ModelRefreshTime);
+		EXPECT_EQ(gauge.PeekRegister(RegOffset::DesignCap), 6000);
+		EXPECT_EQ(gauge.PeekRegister(RegOffset::FullCapRep), 6000);
+		EXPECT_EQ(gauge.PeekRegister(RegOffset::ModelCfg) & 0x8000, 0);
+		EXPECT_EQ(gauge.PeekRegister(RegOffset::HibCfg), 0x870C);
+		EXPECT_EQ(gauge.PeekRegister(RegOffset::Status) & RegUtils::ToInt(Status::PowerOnReset), 0);
+		EXPECT_EQ(gauge.GetLastCommand(), Command::Clear);
+	}
+
+	TEST(SimulatedGaugeTest, ReadOnlyAndWriteOnlyRegisters)
+	{
+		SimulatedGauge gauge;
+		Device<SimulatedGauge, SimulatedClock> device(gauge);
+		auto wait = gauge.GetWaitFunc();
+		uint16_t vcell = gauge.PeekRegister(RegOffset::VCell);
+
+		device.SetRegisterValue(RegOffset::VCell, static_cast<uint16_t>(vcell + 1));
+		ASSERT_TRUE(device.WriteAndWait(RegOffset::VCell, wait));
+		EXPECT_EQ(gauge.PeekRegister(RegOffset::VCell), vcell);
+
+		device.SetCommand(Command::SoftWakeup);
+		ASSERT_TRUE(device.WriteAndWait(RegOffset::Command, wait));
+		EXPECT_EQ(gauge.GetLastCommand(), Command::SoftWakeup);
+		ASSERT_TRUE(device.ReadAndWait(RegOffset::Command, wait));
+		EXPECT_EQ(device.GetRegisterValue(RegOffset::Command), 0);
+	}
+
+	TEST(SimulatedGaugeTest, ResetCommandCausesPowerOnReset)
+	{
+		SimulatedGauge gauge;
+		Device<SimulatedGauge, SimulatedClock> device(gauge);
+		auto wait = gauge.GetWaitFunc();
+		ASSERT_TRUE(device.InitBlocking(wait, MicroAmpereHours::FromRaw(6000), MicroAmperes::FromRaw(640), MicroVolts(3300000)));
+
+		device.SetCommand(Command::Reset);
+		ASSERT_TRUE(device.WriteAndWait(RegOffset::Command, wait));
+		EXPECT_EQ(gauge.PeekRegister(RegOffset::DesignCap), 0x0BB8);
+		EXPECT_NE(gauge.PeekRegister(RegOffset::Status) & RegUtils::ToInt(Status::PowerOnReset), 0);
+		EXPECT_NE(gauge.PeekRegister(RegOffset::FStat) & RegUtils::ToInt(FStat::DataNotReady), 0);
+	}
+
+	TEST(SimulatedGaugeTest, TelemetryEvolvesUnderLoad)
+	{
+		SimulatedBattery battery;
+		battery.CapacityAh = 1.5;
+		battery.InitialSoc = 0.8;
+		SimulatedGauge gauge(battery);
+		gauge.SetLoadProfile([](double) { return -0.75; });
+		Device<SimulatedGauge, SimulatedClock> device(gauge);
+		auto wait = gauge.GetWaitFunc();
+		ASSERT_TRUE(device.InitBlocking(wait, MicroAmpereHours(1500000), MicroAmperes::FromRaw(640), MicroVolts(3300000)));
+
+		ASSERT_TRUE(device.ReadTelemetry());
+		ASSERT_TRUE(device.WaitForTransaction(wait));
+		auto before = device.GetTelemetry();
+
+		gauge.Advance(1h);
+		ASSERT_TRUE(device.ReadTelemetry());
+		ASSERT_TRUE(device.WaitForTransaction(wait));
+		auto after = device.GetTelemetry();
+
+		EXPECT_NEAR(gauge.GetTrueSoc(), 0.3, 0.01);
+		EXPECT_NEAR(after.RemainingSoc / 256.0, 30.0, 1.0);
+		EXPECT_LT(after.RemainingCapacity.GetMicroAmpereHours(), before.RemainingCapacity.GetMicroAmpereHours());
+		EXPECT_LT(after.VCell.GetMicroVolts(), before.VCell.GetMicroVolts());
+		EXPECT_NEAR(static_cast<double>(after.Current.GetMicroAmperes()), -0.75e6, 1e3);
+		EXPECT_NEAR(after.TimeToEmpty * 5.625, 0.6 * 3600.0, 60.0);
+	}
+
+	TEST(SimulatedGaugeTest, SenseResistorScalesCurrentAndCapacity)
+	{
+		SimulatedBattery battery;
+		battery.CapacityAh = 30.0;
+		battery.RSenseOhms = 0.005;
+		SimulatedGauge gauge(battery);
+		gauge.SetLoadProfile([](double) { return -8.0; });
+		Device<SimulatedGauge, SimulatedClock, NoRegisterStats, 5000> device(gauge);
+		auto wait = gauge.GetWaitFunc();
+		ASSERT_TRUE(device.InitBlocking(wait, MicroAmpereHours(30000000), MicroAmperes(100000), MicroVolts(3300000)));
+		EXPECT_EQ(gauge.PeekRegister(RegOffset::RSense), 500);
+		EXPECT_EQ(gauge.PeekRegister(RegOffset::DesignCap), 30000);
+
+		gauge.Advance(10s);
+		ASSERT_TRUE(device.ReadTelemetry());
+		ASSERT_TRUE(device.WaitForTransaction(wait));
+		auto telemetry = device.GetTelemetry();
+
+		// Beyond the 5.12 A range of a 0.010 Ohm shunt
+		EXPECT_NEAR(static_cast<double>(telemetry.Current.GetMicroAmperes()), -8e6, 1e3);
+		EXPECT_NEAR(static_cast<double>(telemetry.RemainingCapacity.GetMicroAmpereHours()), 30e6 * 0.8, 0.1e6);
+	}
+
+	TEST(SimulatedGaugeTest, InitFailsOnSenseResistorMismatch)
+	{
+		SimulatedGauge gauge;
+		auto wait = gauge.GetWaitFunc();
+		Device<SimulatedGauge, SimulatedClock, NoRegisterStats, 5000> fiveMilliOhm(gauge);
+		ASSERT_TRUE(fiveMilliOhm.InitBlocking(wait, MicroAmpereHours(3000000), MicroAmperes(100000), MicroVolts(3300000)));
+		ASSERT_TRUE(fiveMilliOhm.InitBlocking(wait, MicroAmpereHours(3000000), MicroAmperes(100000), MicroVolts(3300000)));
+
+		Device<SimulatedGauge, SimulatedClock> tenMilliOhm(gauge);
+		EXPECT_FALSE(tenMilliOhm.InitBlocking(wait, MicroAmpereHours(3000000), MicroAmperes(100000), MicroVolts(3300000)));
+		EXPECT_FALSE(tenMilliOhm.IsSenseResistorMatching());
+	}
+
+	TEST(SimulatedGaugeTest, AtRateBatchPredictsCandidateLoads)
+	{
+		SimulatedGauge gauge;
+		Device<SimulatedGauge, SimulatedClock> device(gauge);
+		auto wait = gauge.GetWaitFunc();
+		ASSERT_TRUE(device.InitBlocking(wait, MicroAmpereHours(3000000), MicroAmperes::FromRaw(640), MicroVolts(3300000)));
+		device.SetScheduler(gauge.GetScheduleFunc());
+		gauge.Advance(1s);
+
+		auto start = SimulatedClock::now();
+		std::array<MicroAmperes, 4> rates{ MicroAmperes(-500000), MicroAmperes(-2000000), MicroAmperes(-5000000), MicroAmperes(1000000) };
+		std::array<AtRatePrediction<>, 4> predictions{};
+		ASSERT_TRUE(device.EvaluateAtRate(std::span<const MicroAmperes>(rates), predictions));
+		uint64_t transactions = gauge.GetTransactionCount();
+		ASSERT_TRUE(device.WaitForTransaction(wait));
+
+		// One AtRate write and one At* burst read per candidate, each read after the gauge updated the results
+		EXPECT_EQ(gauge.GetTransactionCount() - transactions, 3 * rates.size());
+		EXPECT_GE(SimulatedClock::now() - start, ActiveTaskPeriod * rates.size());
+		EXPECT_FALSE(device.HasDirtyRegisters());
+		for (const auto& prediction : predictions)
+		{
+			EXPECT_TRUE(prediction.IsValid);
+		}
+
+		EXPECT_NEAR(predictions[0].TimeToEmpty * 5.625, predictions[0].AvailableCapacity.GetMicroAmpereHours() / 0.5e6 * 3600.0, 10.0);
+		EXPECT_GT(predictions[0].TimeToEmpty, predictions[1].TimeToEmpty);
+		EXPECT_GT(predictions[1].TimeToEmpty, predictions[2].TimeToEmpty);
+		EXPECT_LT(predictions[0].ResidualCapacity.GetMicroAmpereHours(), predictions[2].ResidualCapacity.GetMicroAmpereHours());
+		EXPECT_GT(predictions[0].AvailableSoc, predictions[2].AvailableSoc);
+		EXPECT_EQ(predictions[3].TimeToEmpty, 0xFFFF);
+	}
+
+	TEST(SimulatedGaugeTest, AtRateBatchLetsTelemetryThrough)
+	{
+		SimulatedGauge gauge;
+		Device<SimulatedGauge, SimulatedClock> device(gauge);
+		device.SetScheduler(gauge.GetScheduleFunc());
+
+		std::array<AtRatePrediction<>, 8> predictions{};
+		for (size_t i = 0; i < predictions.size(); i++)
+		{
+			predictions[i].Rate = MicroAmperes(-500000 * static_cast<int64_t>(i + 1));
+		}
+
+		auto start = SimulatedClock::now();
+		ASSERT_TRUE(device.EvaluateAtRate(predictions));
+		ASSERT_TRUE(device.ReadTelemetry());
+		gauge.Pump();
+		ASSERT_FALSE(device.IsTransactionInProgress());
+
+		// Telemetry waits for the candidate in flight only, not for the whole batch
+		auto batchTime = device.GetRegisterReadTime(Device<SimulatedGauge, SimulatedClock>::AtResultFirst) - start;
+		EXPECT_LT(device.GetTelemetry().Timestamp - start, batchTime / 2);
+		EXPECT_TRUE(predictions.back().IsValid);
+
+		// Candidates put back in the queue are steps of the batch, not new requests
+		EXPECT_EQ(device.GetQueueStats().Dispatched, 2);
+	}
+
+	TEST(SimulatedGaugeTest, AtRateSettleTimeReleasesBus)
+	{
+		SimulatedGauge gauge;
+		Device<SimulatedGauge, SimulatedClock> device(gauge);
+		auto wait = gauge.GetWaitFunc();
+		ASSERT_TRUE(device.InitBlocking(wait, MicroAmpereHours(3000000), MicroAmperes::FromRaw(640), MicroVolts(3300000)));
+		std::vector<std::pair<std::chrono::microseconds, std::function<void()>>> tasks;
+		device.SetScheduler([&tasks](std::chrono::microseconds delay, std::function<void()> task) { tasks.emplace_back(delay, std::move(task)); });
+		gauge.Advance(1s);
+
+		std::array<MicroAmperes, 2> rates{ MicroAmperes(-500000), MicroAmperes(-5000000) };
+		std::array<AtRatePrediction<>, 2> predictions{};
+		std::array<AtRatePrediction<>, 2> other{};
+		ASSERT_TRUE(device.EvaluateAtRate(std::span<const MicroAmperes>(rates), predictions));
+		EXPECT_FALSE(device.EvaluateAtRate(std::span<const MicroAmperes>(rates), other));
+
+		// While the first candidate settles the bus is free: telemetry goes through before its results are read
+		gauge.Pump();
+		ASSERT_EQ(tasks.size(), 1);
+		EXPECT_EQ(tasks[0].first, ActiveTaskPeriod);
+		ASSERT_TRUE(device.ReadTelemetry());
+		gauge.Pump();
+		EXPECT_EQ(device.GetTelemetry().Sequence, 1);
+		EXPECT_TRUE(device.IsTransactionInProgress());
+		EXPECT_FALSE(predictions[0].IsValid);
+
+		for (size_t i = 0; i < tasks.size(); i++)
+		{
+			gauge.Advance(tasks[i].first);
+			tasks[i].second();
+			gauge.Pump();
+		}
+		EXPECT_EQ(tasks.size(), 2);
+		EXPECT_FALSE(device.IsTransactionInProgress());
+		EXPECT_TRUE(predictions[1].IsValid);
+		EXPECT_GT(predictions[0].TimeToEmpty, predictions[1].TimeToEmpty);
+		EXPECT_TRUE(device.EvaluateAtRate(std::span<const MicroAmperes>(rates), other));
+	}
+
+	TEST(SimulatedGaugeTest, AtRateBatchRejectsBadTables)
+	{
+		SimulatedGauge gauge;
+		Device<SimulatedGauge, SimulatedClock> device(gauge);
+
+		std::array<MicroAmperes, 2> rates{ MicroAmperes(0), MicroAmperes(0) };
+		std::array<AtRatePrediction<>, 3> predictions{};
+
+		// Results are only valid after the settle time, which needs a scheduler
+		EXPECT_FALSE(device.EvaluateAtRate(predictions));
+		device.SetScheduler(gauge.GetScheduleFunc());
+
+		EXPECT_FALSE(device.EvaluateAtRate(std::span<const MicroAmperes>(rates), predictions));
+		EXPECT_FALSE(device.EvaluateAtRate(std::span<AtRatePrediction<>>()));
+
+		gauge.SetSimulateError(true);
+		EXPECT_FALSE(device.EvaluateAtRateAndWait(predictions, gauge.GetWaitFunc()));
+		EXPECT_FALSE(predictions[0].IsValid);
+	}
+
+	TEST(SimulatedGaugeTest, ManyTransactionsInVirtualTime)
+	{
+		SimulatedGauge gauge;
+		Device<SimulatedGauge, SimulatedClock> device(gauge);
+
+		auto start = SimulatedClock::now();
+		for (size_t i = 0; i < 100000; i++)
+		{
+			ASSERT_TRUE(device.ReadTelemetry());
+			gauge.Pump();
+		}
+
+		EXPECT_EQ(device.GetTelemetry().Sequence, 100000);
+		EXPECT_FALSE(device.IsTransactionInProgress());
+		EXPECT_GT(SimulatedClock::now() - start, 1s);
+	}
+}
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+#include "PiSubmarine/Max1726/MappedFile.h"
+#include "PiSubmarine/Max1726/TelemetryRecorder.h"
+#include <filesystem>
+#include <vector>
+
+namespace PiSubmarine::Max1726
+{
+	static TelemetryRecord MakeRecord(int64_t i)
+	{
+		TelemetryRecord record;
+		record.Timestamp = 1000000 + i * 175000;
+		record.RepSoc = static_cast<uint16_t>(20000 - i * 3);
+		record.VCell = static_cast<uint16_t>(50000 - i % 7);
+		record.Current = static_cast<uint16_t>(-3000 + (i % 5) * 40);
+		record.AvgCurrent = static_cast<uint16_t>(-3000 + i % 3);
+		record.Temp = static_cast<uint16_t>(25 * 256 + i % 2);
+		record.RepCap = static_cast<uint16_t>(6000 - i);
+		record.TimeToEmpty = static_cast<uint16_t>(0xFFFF - i);
+		record.Status = i % 100 == 0 ? 0x0100 : 0;
+		return record;
+	}
+
+	static void ExpectEqual(const TelemetryRecord& a, const TelemetryRecord& b)
+	{
+		EXPECT_EQ(a.Timestamp, b.Timestamp);
+		EXPECT_EQ(a.GetValues(), b.GetValues());
+	}
+
+	TEST(TelemetryRecorderTest, RoundTripAndCompression)
+	{
+		std::vector<uint8_t> storage(GetRecorderStorageSize(64));
+		TelemetryRecorder recorder(storage);
+		ASSERT_TRUE(recorder.Open());
+
+		constexpr int count = 500;
+		for (int i = 0; i < count; i++)
+		{
+			ASSERT_TRUE(recorder.Append(MakeRecord(i)));
+		}
+		recorder.Flush();
+
+		std::vector<TelemetryRecord> records;
+		ASSERT_TRUE(DecodeTelemetry(storage, records));
+		ASSERT_EQ(records.size(), count);
+		for (int i = 0; i < count; i++)
+		{
+			ExpectEqual(records[i], MakeRecord(i));
+		}
+
+		size_t usedBlocks = 0;
+		for (size_t i = 0; i < recorder.GetBlockCount(); i++)
+		{
+			usedBlocks += storage[RecorderHeaderSize + i * RecorderBlockSize] != 0;
+		}
+		EXPECT_LT(usedBlocks * RecorderBlockSize, count * TelemetryRecord::ValueCount * 2);
+	}
+
+	TEST(TelemetryRecorderTest, RingKeepsNewestSamples)
+	{
+		std::vector<uint8_t> storage(GetRecorderStorageSize(4));
+		TelemetryRecorder recorder(storage);
+		ASSERT_TRUE(recorder.Open());
+
+		constexpr int count = 1000;
+		for (int i = 0; i < count; i++)
+		{
+			recorder.Append(MakeRecord(i));
+		}
+		recorder.Flush();
+
+		std::vector<TelemetryRecord> records;
+		ASSERT_TRUE(DecodeTelemetry(storage, records));
+		ASSERT_FALSE(records.empty());
+		ASSERT_LT(records.size(), count);
+		int64_t first = count - static_cast<int64_t>(records.size());
+		for (size_t i = 0; i < records.size(); i++)
+		{
+			ExpectEqual(records[i], MakeRecord(first + static_cast<int64_t>(i)));
+		}
+	}
+
+	TEST(TelemetryRecorderTest, SnapshotConversion)
+	{
+		TelemetrySnapshot<> snapshot;
+		snapshot.Timestamp = std::chrono::steady_clock::time_point(std::chrono::microseconds(123456789));
+		snapshot.Status = Status::MinimumVoltageAlert;
+		snapshot.RemainingCapacity = MicroAmpereHours::FromRaw(1234);
+		snapshot.RemainingSoc = 0x5080;
+		snapshot.Temperature = MilliCelsius::FromRaw(-2560);
+		snapshot.VCell = MicroVolts::FromRaw(47000);
+		snapshot.Current = MicroAmperes::FromRaw(-1600);
+		snapshot.AverageCurrent = MicroAmperes::FromRaw(-1500);
+		snapshot.TimeToEmpty = 777;
+
+		std::vector<uint8_t> storage(GetRecorderStorageSize(1));
+		TelemetryRecorder recorder(storage);
+		ASSERT_TRUE(recorder.Open());
+		ASSERT_TRUE(recorder.Append(snapshot));
+		recorder.Flush();
+
+		std::vector<TelemetryRecord> records;
+		ASSERT_TRUE(DecodeTelemetry(storage, records));
+		ASSERT_EQ(records.size(), 1);
+		auto decoded = records[0].ToSnapshot();
+		EXPECT_EQ(decoded.Timestamp, snapshot.Timestamp);
+		EXPECT_EQ(decoded.Status, snapshot.Status);
+		EXPECT_EQ(decoded.RemainingCapacity.GetMicroAmpereHours(), snapshot.RemainingCapacity.GetMicroAmpereHours());
+		EXPECT_EQ(decoded.RemainingSoc, snapshot.RemainingSoc);
+		EXPECT_EQ(decoded.Temperature.GetMilliCelsius(), snapshot.Temperature.GetMilliCelsius());
+		EXPECT_EQ(decoded.VCell.GetMicroVolts(), snapshot.VCell.GetMicroVolts());
+		EXPECT_EQ(decoded.Current.GetMicroAmperes(), snapshot.Current.GetMicroAmperes());
+		EXPECT_EQ(decoded.AverageCurrent.GetMicroAmperes(), snapshot.AverageCurrent.GetMicroAmperes());
+		EXPECT_EQ(decoded.TimeToEmpty, snapshot.TimeToEmpty);
+	}
+
+	TEST(TelemetryRecorderTest, MappedFileResumesRecording)
+	{
+		auto path = std::filesystem::temp_directory_path() / "PiSubmarine.Max1726.TelemetryRecorderTest.bin";
+		std::filesystem::remove(path);
+		size_t size = GetRecorderStorageSize(16);
+
+		{
+			MappedFile file;
+			ASSERT_TRUE(file.Open(path.string().c_str(), size));
+			TelemetryRecorder recorder(file.GetData());
+			ASSERT_TRUE(recorder.Open());
+			for (int i = 0; i < 100; i++)
+			{
+				recorder.Append(MakeRecord(i));
+			}
+			recorder.Flush();
+			EXPECT_TRUE(file.Sync());
+		}
+
+		{
+			MappedFile file;
+			ASSERT_TRUE(file.Open(path.string().c_str(), size));
+			TelemetryRecorder recorder(file.GetData());
+			ASSERT_TRUE(recorder.Open());
+			for (int i = 100; i < 150; i++)
+			{
+				recorder.Append(MakeRecord(i));
+			}
+			recorder.Flush();
+
+			std::vector<TelemetryRecord> records;
+			ASSERT_TRUE(DecodeTelemetry(file.GetData(), records));
+			ASSERT_EQ(records.size(), 150);
+			for (int i = 0; i < 150; i++)
+			{
+				ExpectEqual(records[i], MakeRecord(i));
+			}
+		}
+
+		EXPECT_EQ(std::filesystem::file_size(path), size);
+		std::filesystem::remove(path);
+	}
+}
@@ -5,9 +5,47 @@
 #include "PiSubmarine/Max1726/MicroVolts.h"
 #include "PiSubmarine/Max1726/MilliCelcius.h"
 #include "PiSubmarine/RegUtils.h"
+#include <cstring>
+#include <span>
+#include <vector>
 
 namespace PiSubmarine::Max1726
 {
+    // Checks span FromRaw against scalar FromRaw for every raw value, then span ToRaw against scalar ToRaw for the results
+    // and for pseudo-random values up to 2^40 units, including ones that saturate or wrap.
+    template<typename Unit, typename Raw, typename Make>
+    void ExpectBatchMatchesScalar(Make make)
+    {
+        std::vector<Raw> raw;
+        for (int32_t i = std::numeric_limits<Raw>::min(); i <= std::numeric_limits<Raw>::max(); i++)
+        {
+            raw.push_back(static_cast<Raw>(i));
+        }
+
+        std::vector<Unit> values(raw.size());
+        Unit::FromRaw(std::span<const Raw>(raw), std::span<Unit>(values));
+        for (size_t i = 0; i < raw.size(); i++)
+        {
+            Unit scalar = Unit::FromRaw(raw[i]);
+            ASSERT_EQ(std::memcmp(&values[i], &scalar, sizeof(Unit)), 0) << "raw " << raw[i];
+        }
+
+        uint64_t state = 12345;
+        for (size_t i = 0; i < 10001; i++)
+        {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            int64_t magnitude = static_cast<int64_t>(state >> 24) >> (i % 24);
+            values.push_back(make(magnitude) + Unit::FromRaw(raw[i % raw.size()]));
+        }
+
+        std::vector<Raw> back(values.size());
+        Unit::ToRaw(std::span<const Unit>(values), std::span<Raw>(back));
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            ASSERT_EQ(back[i], values[i].ToRaw()) << "index " << i;
+        }
+    }
+
     // ---------------------
     // MicroAmperes Tests
     // ---------------------
@@ -29,6 +67,43 @@ namespace PiSubmarine::Max1726
         }
     }
 
+    TEST(MicroAmperesTest, BatchMatchesScalar)
+    {
+        ExpectBatchMatchesScalar<MicroAmperes, int16_t>([](int64_t x) { return MicroAmperes(x % 2 ? -x : x); });
+    }
+
+    TEST(MicroAmperesTest, SenseResistorScaling)
+    {
+        using FiveMilliOhm = BasicMicroAmperes<5000>;
+        static_assert(FiveMilliOhm::IsExactScale && FiveMilliOhm::RawScale == 5000);
+        EXPECT_EQ(FiveMilliOhm::FromRaw(-3200).GetMicroAmperes(), -1000000);
+        for (int32_t raw = std::numeric_limits<int16_t>::min(); raw <= std::numeric_limits<int16_t>::max(); raw++)
+        {
+            ASSERT_EQ(FiveMilliOhm::FromRaw(static_cast<int16_t>(raw)).ToRaw(), raw);
+        }
+
+        // 3 mOhm does not divide 1.5625 uV and takes the division path
+        using ThreeMilliOhm = BasicMicroAmperes<3000>;
+        static_assert(!ThreeMilliOhm::IsExactScale);
+        EXPECT_EQ(ThreeMilliOhm::FromRaw(1920).GetMicroAmperes(), 1000000);
+        EXPECT_EQ(ThreeMilliOhm(1000000).ToRaw(), 1920);
+        for (int32_t raw = std::numeric_limits<int16_t>::min(); raw <= std::numeric_limits<int16_t>::max(); raw++)
+        {
+            ASSERT_EQ(ThreeMilliOhm::FromRaw(static_cast<int16_t>(raw)).ToRaw(), raw);
+        }
+
+        // 0.5 mOhm scales too far for the 32-bit batch kernel and takes the scalar loop
+        using HalfMilliOhm = BasicMicroAmperes<500>;
+        static_assert(HalfMilliOhm::IsExactScale && HalfMilliOhm::RawScale * 65535 > INT32_MAX);
+
+        FiveMilliOhm converted = MicroAmperes(1234);
+        EXPECT_EQ(converted.GetMicroAmperes(), 1234);
+
+        ExpectBatchMatchesScalar<FiveMilliOhm, int16_t>([](int64_t x) { return FiveMilliOhm(x % 2 ? -x : x); });
+        ExpectBatchMatchesScalar<ThreeMilliOhm, int16_t>([](int64_t x) { return ThreeMilliOhm(x % 2 ? -x : x); });
+        ExpectBatchMatchesScalar<HalfMilliOhm, int16_t>([](int64_t x) { return HalfMilliOhm(x % 2 ? -x : x); });
+    }
+
     TEST(MicroAmperesTest, LiteralsAndArithmetic)
     {
         auto a = 1000_uA;
@@ -61,6 +136,11 @@ namespace PiSubmarine::Max1726
         }
     }
 
+    TEST(MicroVoltsTest, BatchMatchesScalar)
+    {
+        ExpectBatchMatchesScalar<MicroVolts, uint16_t>([](int64_t x) { return MicroVolts(static_cast<uint64_t>(x)); });
+    }
+
     TEST(MicroVoltsTest, LiteralsAndArithmetic)
     {
         auto a = 330000_uV;
@@ -96,6 +176,34 @@ namespace PiSubmarine::Max1726
         }
     }
 
+    TEST(MicroAmpereHoursTest, BatchMatchesScalar)
+    {
+        ExpectBatchMatchesScalar<MicroAmpereHours, uint16_t>([](int64_t x) { return MicroAmpereHours(static_cast<uint64_t>(x)); });
+    }
+
+    TEST(MicroAmpereHoursTest, SenseResistorScaling)
+    {
+        using FiveMilliOhm = BasicMicroAmpereHours<5000>;
+        static_assert(FiveMilliOhm::IsExactScale && FiveMilliOhm::RawScale == 1000);
+        EXPECT_EQ(FiveMilliOhm::FromRaw(3000).GetMicroAmpereHours(), 3000000);
+        for (uint32_t raw = 0; raw <= std::numeric_limits<uint16_t>::max(); raw++)
+        {
+            ASSERT_EQ(FiveMilliOhm::FromRaw(static_cast<uint16_t>(raw)).ToRaw(), raw);
+        }
+
+        using ThreeMilliOhm = BasicMicroAmpereHours<3000>;
+        static_assert(!ThreeMilliOhm::IsExactScale);
+        EXPECT_EQ(ThreeMilliOhm::FromRaw(600).GetMicroAmpereHours(), 1000000);
+        EXPECT_EQ(ThreeMilliOhm(1000000).ToRaw(), 600);
+        for (uint32_t raw = 0; raw <= std::numeric_limits<uint16_t>::max(); raw++)
+        {
+            ASSERT_EQ(ThreeMilliOhm::FromRaw(static_cast<uint16_t>(raw)).ToRaw(), raw);
+        }
+
+        ExpectBatchMatchesScalar<FiveMilliOhm, uint16_t>([](int64_t x) { return FiveMilliOhm(static_cast<uint64_t>(x)); });
+        ExpectBatchMatchesScalar<ThreeMilliOhm, uint16_t>([](int64_t x) { return ThreeMilliOhm(static_cast<uint64_t>(x)); });
+    }
+
     TEST(MicroAmpereHoursTest, LiteralsAndArithmetic)
     {
         auto a = 1000_uAh;
@@ -127,6 +235,11 @@ namespace PiSubmarine::Max1726
         }
     }
 
+    TEST(MilliCelsiusTest, BatchMatchesScalar)
+    {
+        ExpectBatchMatchesScalar<MilliCelsius, int16_t>([](int64_t x) { return MilliCelsius(x % 2 ? -x : x); });
+    }
+
     TEST(MilliCelsiusTest, LiteralsAndArithmetic)
     {
         auto t1 = 25000_mC; // 25.0 C
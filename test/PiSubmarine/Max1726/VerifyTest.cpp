@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include "SimulatedGauge.h"
+#include <cstdint>
+
+namespace PiSubmarine::Max1726
+{
+	namespace
+	{
+		using StatsDevice = Device<SimulatedGauge, SimulatedClock, RegisterStats<SimulatedClock>>;
+
+		// Written as four runs: Config..IChgTerm, LearnCfg..FilterCfg, MiscCfg and ModelCfg
+		void MakeVerifyConfig(StatsDevice& device)
+		{
+			device.SetRegisterValue(RegOffset::Config, 0x2210);
+			device.SetRegisterValue(RegOffset::IChgTerm, 0x0280);
+			device.SetRegisterValue(RegOffset::LearnCfg, 0x4486);
+			device.SetRegisterValue(RegOffset::FilterCfg, 0xCEA4);
+			device.SetRegisterValue(RegOffset::MiscCfg, 0x3870);
+			device.SetRegisterValue(RegOffset::ModelCfg, 0x8400);
+		}
+	}
+
+	TEST(VerifyTest, WriteDirtyAndVerifyReadsBackInFewBursts)
+	{
+		SimulatedGauge gauge;
+		StatsDevice device(gauge);
+		MakeVerifyConfig(device);
+
+		uint64_t transfers = gauge.GetTransactionCount();
+		ASSERT_TRUE(device.WriteDirtyAndVerify());
+		ASSERT_TRUE(device.WaitForTransaction(gauge.GetWaitFunc()));
+
+		// Read-back reads through RelaxCfg but not the long gap after IChgTerm: 4 writes and 3 reads of 2 transfers
+		EXPECT_EQ(gauge.GetTransactionCount() - transfers, 10);
+		EXPECT_EQ(device.GetWriteDirtyTransactionCount(), 4);
+		EXPECT_EQ(device.GetVerifyMismatchCount(), 0);
+		EXPECT_FALSE(device.HasDirtyRegisters());
+		EXPECT_EQ(device.GetRegisterStats().Get(RegOffset::RelaxCfg).Reads, 1);
+		EXPECT_EQ(device.GetRegisterStats().Get(RegOffset::TTF).Reads, 0);
+
+		// Nothing left to write: finishes without bus traffic
+		transfers = gauge.GetTransactionCount();
+		EXPECT_TRUE(device.WriteDirtyAndVerify());
+		EXPECT_FALSE(device.IsTransactionInProgress());
+		EXPECT_EQ(gauge.GetTransactionCount(), transfers);
+	}
+
+	TEST(VerifyTest, WriteDirtyAndVerifyRewritesOnlyMismatches)
+	{
+		SimulatedGauge gauge;
+		StatsDevice device(gauge);
+		MakeVerifyConfig(device);
+
+		gauge.DropWrites(RegOffset::FilterCfg, 1);
+		uint64_t transfers = gauge.GetTransactionCount();
+		ASSERT_TRUE(device.WriteDirtyAndVerify());
+		ASSERT_TRUE(device.WaitForTransaction(gauge.GetWaitFunc()));
+
+		EXPECT_EQ(gauge.GetTransactionCount() - transfers, 13);
+		EXPECT_EQ(device.GetVerifyMismatchCount(), 1);
+		EXPECT_EQ(gauge.PeekRegister(RegOffset::FilterCfg), 0xCEA4);
+		EXPECT_EQ(device.GetRegisterStats().Get(RegOffset::FilterCfg).Writes, 2);
+		EXPECT_EQ(device.GetRegisterStats().Get(RegOffset::LearnCfg).Writes, 1);
+		EXPECT_FALSE(device.HasDirtyRegisters());
+	}
+
+	TEST(VerifyTest, WriteDirtyAndVerifyFailsOnStuckRegister)
+	{
+		SimulatedGauge gauge;
+		StatsDevice device(gauge);
+		MakeVerifyConfig(device);
+
+		gauge.DropWrites(RegOffset::FilterCfg, 100);
+		ASSERT_TRUE(device.WriteDirtyAndVerify());
+		EXPECT_FALSE(device.WaitForTransaction(gauge.GetWaitFunc()));
+
+		EXPECT_EQ(device.GetVerifyMismatchCount(), 1 + StatsDevice::MaxVerifyRewrites);
+		EXPECT_EQ(device.GetRegisterStats().Get(RegOffset::FilterCfg).Writes, 1 + StatsDevice::MaxVerifyRewrites);
+		EXPECT_TRUE(device.GetRegisters()[RegUtils::ToInt(RegOffset::FilterCfg)].IsDirty);
+		EXPECT_FALSE(device.GetRegisters()[RegUtils::ToInt(RegOffset::LearnCfg)].IsDirty);
+	}
+}